@@ -0,0 +1,173 @@
+#include "admin_server.h"
+#include "common.h"           // 用于日志宏
+#include "socket_utils.h"     // 用于监听套接字创建
+#include <sys/socket.h>       // 用于accept/send/recv
+#include <sys/eventfd.h>      // 用于停止通知
+#include <sys/time.h>         // 用于SO_RCVTIMEO/SO_SNDTIMEO超时
+#include <poll.h>             // 用于同时等待监听套接字和停止通知
+#include <unistd.h>           // 用于close/write
+#include <errno.h>            // 用于错误码
+#include <cstring>            // 用于strncmp/strstr
+
+namespace {
+
+const size_t MAX_REQUEST = 4096;   // 请求头的最大长度（超出部分不读取）
+const int REQUEST_TIMEOUT_SEC = 1; // 读取请求的超时（防止慢客户端占住管理线程）
+const int RESPONSE_TIMEOUT_SEC = 1; // 单次写出应答无进展的超时（防止不读应答的客户端占住管理线程）
+
+// 阻塞写出全部数据
+// 返回：true成功，false失败（含超过RESPONSE_TIMEOUT_SEC仍写不出）
+bool send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// 构造函数
+AdminServer::AdminServer(std::function<std::string()> render)
+    : listen_fd(-1), stop_fd(-1) {
+    add_route("/metrics", "text/plain; version=0.0.4", std::move(render));
+}
+
+// 注册一个GET路径
+void AdminServer::add_route(const std::string& path, const char* content_type, std::function<std::string()> render) {
+    Route route;
+    route.path = path;
+    route.content_type = content_type;
+    route.render = std::move(render);
+    routes.push_back(std::move(route));
+}
+
+// 析构函数：停止管理线程并关闭套接字
+AdminServer::~AdminServer() {
+    stop();
+    if (listen_fd != -1) close(listen_fd);
+    if (stop_fd != -1) close(stop_fd);
+}
+
+// 监听管理端口并启动管理线程
+bool AdminServer::start(int port) {
+    listen_fd = create_listen_socket(port, false);
+    if (listen_fd == -1) {
+        return false;
+    }
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd == -1) {
+        LOG_ERROR("Admin eventfd create failed (errno: %d)", errno);
+        return false;
+    }
+    thread = std::thread(&AdminServer::run, this);
+    std::string paths;
+    for (const Route& route : routes) {
+        paths += paths.empty() ? "GET " : ", ";
+        paths += route.path;
+    }
+    LOG_INFO("Admin endpoint listening on port %d (%s)", port, paths.c_str());
+    return true;
+}
+
+// 停止管理线程
+void AdminServer::stop() {
+    if (!thread.joinable()) return;
+    uint64_t one = 1;
+    ssize_t ret = write(stop_fd, &one, sizeof(one));
+    (void)ret;
+    thread.join();
+}
+
+// 管理线程主循环
+void AdminServer::run() {
+    struct pollfd fds[2];
+    fds[0].fd = listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = stop_fd;
+    fds[1].events = POLLIN;
+
+    while (true) {
+        int n = poll(fds, 2, -1);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Admin poll failed (errno: %d)", errno);
+            return;
+        }
+        if (fds[1].revents & POLLIN) return;  // 停止通知
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        // 监听套接字为非阻塞：逐个接受并同步处理（请求量很小，无需并发）
+        while (true) {
+            int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd == -1) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    LOG_ERROR_RL("Admin accept failed (errno: %d)", errno);
+                }
+                break;
+            }
+            serve(client_fd);
+            close(client_fd);
+        }
+    }
+}
+
+// 处理一个HTTP请求：注册过的GET路径返回渲染结果，其余路径返回404
+void AdminServer::serve(int client_fd) {
+    struct timeval tv;
+    tv.tv_sec = REQUEST_TIMEOUT_SEC;
+    tv.tv_usec = 0;
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    tv.tv_sec = RESPONSE_TIMEOUT_SEC;
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // 读取请求头（到空行为止）
+    char request[MAX_REQUEST + 1];
+    size_t len = 0;
+    while (len < MAX_REQUEST) {
+        ssize_t n = recv(client_fd, request + len, MAX_REQUEST - len, 0);
+        if (n <= 0) {
+            if (n == -1 && errno == EINTR) continue;
+            break;
+        }
+        len += static_cast<size_t>(n);
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") != nullptr || strstr(request, "\n\n") != nullptr) break;
+    }
+    request[len] = '\0';
+
+    std::string body;
+    const char* status = "404 Not Found";
+    const char* content_type = "text/plain";
+    bool found = false;
+    for (const Route& route : routes) {
+        size_t n = route.path.size();
+        if (strncmp(request, "GET ", 4) == 0 && strncmp(request + 4, route.path.c_str(), n) == 0 &&
+            (request[4 + n] == ' ' || request[4 + n] == '?')) {
+            status = "200 OK";
+            content_type = route.content_type;
+            body = route.render();
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        body = "try";
+        for (const Route& route : routes) body += " GET " + route.path;
+        body += "\n";
+    }
+
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 %s\r\nContent-Type: %s\r\n"
+                              "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                              status, content_type, body.size());
+    if (send_all(client_fd, header, static_cast<size_t>(header_len))) {
+        send_all(client_fd, body.data(), body.size());
+    }
+}
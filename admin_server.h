@@ -0,0 +1,63 @@
+#ifndef ADMIN_SERVER_H
+#define ADMIN_SERVER_H
+
+#include <functional>             // 用于指标渲染回调
+#include <string>                 // 用于响应文本
+#include <thread>                 // 用于管理线程
+#include <vector>                 // 用于路径表
+
+// 管理端口：独立线程上的极简HTTP服务，GET /metrics返回Prometheus文本格式的指标，
+// 其余路径（如GET /trace）由add_route注册
+// 说明：与数据面完全隔离（独立监听套接字和线程），每个请求渲染一次后关闭连接；
+//       只读取各工作线程的relaxed计数器和追踪快照，不影响工作线程的热路径
+class AdminServer
+{
+private:
+    int listen_fd;                              // 管理端口监听套接字
+    int stop_fd;                                // eventfd：通知管理线程退出
+    // 一个GET路径
+    struct Route
+    {
+        std::string path;                       // 路径（如/metrics，不含查询参数）
+        const char* content_type;               // 响应的Content-Type
+        std::function<std::string()> render;    // 响应渲染回调（在管理线程中调用）
+    };
+
+    std::vector<Route> routes;                  // 路径表（start之后不再变化）
+    std::thread thread;                         // 管理线程
+
+    // 管理线程主循环：等待并逐个处理请求
+    void run();
+
+    // 处理一个HTTP请求并关闭连接
+    // 参数：client_fd - 客户端套接字
+    void serve(int client_fd);
+
+public:
+    // 构造函数：注册GET /metrics
+    // 参数：render - 指标渲染回调
+    explicit AdminServer(std::function<std::string()> render);
+
+    // 注册一个GET路径（在start之前调用）
+    // 参数：
+    //   path - 路径
+    //   content_type - 响应的Content-Type
+    //   render - 响应渲染回调
+    void add_route(const std::string& path, const char* content_type, std::function<std::string()> render);
+
+    // 析构函数：停止管理线程并关闭套接字
+    ~AdminServer();
+
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+
+    // 监听管理端口并启动管理线程
+    // 参数：port - 管理端口
+    // 返回：true成功，false失败（错误已记录日志）
+    bool start(int port);
+
+    // 停止管理线程
+    void stop();
+};
+
+#endif // ADMIN_SERVER_H
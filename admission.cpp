@@ -0,0 +1,105 @@
+#include "admission.h"
+#include <sys/resource.h>     // 用于getrlimit（登记表大小）
+#include <sys/socket.h>       // 用于getpeername/setsockopt
+#include <unistd.h>           // 用于close
+#include <algorithm>          // 用于std::min
+#include <cstdio>             // 用于snprintf
+
+// 构造函数：按进程可打开的fd上限分配登记表（最多MAX_TRACKED_FDS项）
+// 参数：config - 服务端配置
+AdmissionControl::AdmissionControl(const ServerConfig& config)
+    : max_connections(config.max_connections), max_per_ip(config.max_connections_per_ip),
+      active(0), fd_limit(0), shed_total(0), shed_per_ip(0) {
+    if (!enabled()) return;
+    struct rlimit limit;
+    fd_limit = getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+        ? std::min(static_cast<size_t>(limit.rlim_cur), MAX_TRACKED_FDS) : MAX_TRACKED_FDS;
+    by_fd.reset(new std::atomic<uint64_t>[fd_limit]());
+}
+
+// 判断是否接纳刚接受的连接
+// 说明：先占用总连接数名额，再检查来源IP的名额，任一超出即回退并拒绝
+// 参数：
+//   fd - 客户端文件描述符
+//   peer - 客户端地址，nullptr表示未知
+// 返回：true接纳，false拒绝
+bool AdmissionControl::admit(int fd, const struct sockaddr_in* peer) {
+    if (!enabled()) return true;
+    if (fd < 0 || static_cast<size_t>(fd) >= fd_limit) {  // 超出登记表（fd上限超过MAX_TRACKED_FDS或运行中被调高）：无法跟踪，拒绝
+        shed_total.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (active.fetch_add(1, std::memory_order_relaxed) >= max_connections && max_connections > 0) {
+        active.fetch_sub(1, std::memory_order_relaxed);
+        shed_total.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 来源IP：accept未给出地址时（io_uring多路accept）查询对端地址
+    struct sockaddr_in addr;
+    if (max_per_ip > 0 && peer == nullptr) {
+        socklen_t len = sizeof(addr);
+        if (getpeername(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) == 0) peer = &addr;
+    }
+    uint64_t entry = ADMITTED;
+    if (max_per_ip > 0 && peer != nullptr && peer->sin_family == AF_INET) {
+        uint32_t ip = peer->sin_addr.s_addr;
+        IpShard& s = shard(ip);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        int& count = s.counts[ip];
+        if (count >= max_per_ip) {
+            active.fetch_sub(1, std::memory_order_relaxed);
+            shed_per_ip.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        ++count;
+        entry |= COUNTED_IP | ip;
+    }
+    by_fd[fd].store(entry, std::memory_order_release);
+    return true;
+}
+
+// 释放连接的登记
+// 参数：fd - 客户端文件描述符
+void AdmissionControl::release(int fd) {
+    if (!enabled() || fd < 0 || static_cast<size_t>(fd) >= fd_limit) return;
+    uint64_t entry = by_fd[fd].exchange(0, std::memory_order_acq_rel);
+    if ((entry & ADMITTED) == 0) return;
+    active.fetch_sub(1, std::memory_order_relaxed);
+    if ((entry & COUNTED_IP) == 0) return;
+
+    uint32_t ip = static_cast<uint32_t>(entry);
+    IpShard& s = shard(ip);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.counts.find(ip);
+    if (it != s.counts.end() && --it->second <= 0) s.counts.erase(it);
+}
+
+// 拒绝连接：SO_LINGER(0)使close发送RST，连接不进入TIME_WAIT
+// 参数：fd - 客户端文件描述符
+void AdmissionControl::reject(int fd) {
+    struct linger lg;
+    lg.l_onoff = 1;
+    lg.l_linger = 0;
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));  // Unix域连接不支持，失败时照常关闭
+    close(fd);
+}
+
+// 追加准入指标
+// 参数：out - 输出文本
+void AdmissionControl::render_prometheus(std::string& out) const {
+    char text[512];
+    int n = snprintf(text, sizeof(text),
+                     "# HELP echo_admitted_connections Connections currently holding an admission slot.\n"
+                     "# TYPE echo_admitted_connections gauge\n"
+                     "echo_admitted_connections %d\n"
+                     "# HELP echo_shed_connections_total Connections rejected at accept by admission limits.\n"
+                     "# TYPE echo_shed_connections_total counter\n"
+                     "echo_shed_connections_total{reason=\"total\"} %llu\n"
+                     "echo_shed_connections_total{reason=\"per_ip\"} %llu\n",
+                     active_connections(),
+                     static_cast<unsigned long long>(shed_total.load(std::memory_order_relaxed)),
+                     static_cast<unsigned long long>(shed_per_ip.load(std::memory_order_relaxed)));
+    if (n > 0) out.append(text, static_cast<size_t>(n) < sizeof(text) ? n : sizeof(text) - 1);
+}
@@ -0,0 +1,80 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "common.h"               // 包含服务端配置
+#include <atomic>                 // 用于跨线程的连接计数
+#include <memory>                 // 用于按fd索引的登记表
+#include <mutex>                  // 用于保护按IP的计数
+#include <string>                 // 用于指标文本
+#include <unordered_map>          // 用于按IP的连接计数
+#include <netinet/in.h>           // 用于客户端地址（sockaddr_in）
+
+// 连接准入控制：接受连接时检查总连接数和单个来源IP的连接数上限，超出时立即拒绝
+// 说明：被拒绝的连接设置SO_LINGER(0)后关闭，客户端立即收到RST而不是等到超时，
+//       也不占用缓冲区和连接槽位；在过载时优先保证已接纳连接的服务质量。
+//       接受连接的线程（接收线程、多reactor模式的工作线程）调用admit，关闭连接的工作线程
+//       在close之前调用release；两者按fd登记，fd关闭后才会被复用，同一fd的登记不会交错。
+//       Unix域和共享内存连接没有来源IP，只计入总连接数
+// 注：跨线程共享（所有成员函数线程安全），未设置任何上限时admit/release只做一次判断
+class AdmissionControl
+{
+private:
+    static const size_t IP_SHARDS = 64;           // 按IP计数的分片数（降低多线程接受时的锁争用）
+    static const uint64_t ADMITTED = 1ull << 32;  // 登记表中的"已接纳"标志（低32位为来源IP）
+    static const uint64_t COUNTED_IP = 1ull << 33;  // 登记表中的"计入了按IP计数"标志
+    static constexpr size_t MAX_TRACKED_FDS = 1u << 20;  // 登记表大小上限（每项8字节，最多8MB）
+
+    // 按IP计数的一个分片
+    struct alignas(64) IpShard
+    {
+        std::mutex mutex;
+        std::unordered_map<uint32_t, int> counts;  // 来源IP（网络字节序）→ 连接数
+    };
+
+    int max_connections;                          // 总连接数上限，0表示不限制
+    int max_per_ip;                               // 单个来源IP的连接数上限，0表示不限制
+    std::atomic<int> active;                      // 已接纳、尚未释放的连接数
+    size_t fd_limit;                              // 登记表大小（进程可打开的fd上限，不超过MAX_TRACKED_FDS）
+    std::unique_ptr<std::atomic<uint64_t>[]> by_fd;  // 按fd登记的接纳状态和来源IP
+    IpShard shards[IP_SHARDS];
+    std::atomic<uint64_t> shed_total;             // 因总连接数上限拒绝的连接数
+    std::atomic<uint64_t> shed_per_ip;            // 因单IP上限拒绝的连接数
+
+    // 来源IP所在的分片
+    IpShard& shard(uint32_t ip) { return shards[(ip * 2654435761u) >> 26]; }
+
+public:
+    // 构造函数
+    // 参数：config - 服务端配置（max_connections、max_connections_per_ip）
+    explicit AdmissionControl(const ServerConfig& config);
+
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    // 是否设置了任何上限
+    bool enabled() const { return max_connections > 0 || max_per_ip > 0; }
+
+    // 判断是否接纳刚接受的连接，接纳时登记
+    // 参数：
+    //   fd - 客户端文件描述符
+    //   peer - 客户端地址（accept返回的地址；nullptr表示未知，设置了单IP上限时经getpeername查询）
+    // 返回：true接纳，false拒绝（调用方应调用reject关闭该fd）
+    bool admit(int fd, const struct sockaddr_in* peer);
+
+    // 释放连接的登记（在close(fd)之前调用；未登记的fd为无操作）
+    // 参数：fd - 客户端文件描述符
+    void release(int fd);
+
+    // 拒绝连接：设置SO_LINGER(0)后关闭，客户端立即收到RST
+    // 参数：fd - 客户端文件描述符
+    static void reject(int fd);
+
+    // 已接纳的连接数
+    int active_connections() const { return active.load(std::memory_order_relaxed); }
+
+    // 追加Prometheus文本格式的准入指标（在管理线程中调用）
+    // 参数：out - 输出文本
+    void render_prometheus(std::string& out) const;
+};
+
+#endif // ADMISSION_H
@@ -0,0 +1,83 @@
+#include "buffer_pool.h"
+#include <cstdlib>            // 用于aligned_alloc/free
+
+namespace {
+const size_t CACHE_LINE_SIZE = 64;  // 缓存行大小：slab和缓冲区都按此对齐
+}
+
+// 构造函数：缓冲区大小向上取整到缓存行，避免相邻缓冲区共享缓存行
+// 参数：
+//   buffer_size - 单个缓冲区大小
+//   buffers_per_slab - 每个slab包含的缓冲区数
+BufferPool::BufferPool(size_t buffer_size, size_t buffers_per_slab)
+    : buffer_size((buffer_size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE),
+      buffers_per_slab(buffers_per_slab == 0 ? 1 : buffers_per_slab),
+      free_list(nullptr), hits(0), misses(0), capacity(0), in_use(0) {}
+
+// 析构函数：释放所有slab
+BufferPool::~BufferPool() {
+    for (char* slab : slabs) {
+        free(slab);
+    }
+}
+
+// 分配一个新slab并切分为缓冲区加入空闲链表
+// 返回：true成功，false内存不足
+bool BufferPool::grow() {
+    char* slab = static_cast<char*>(aligned_alloc(CACHE_LINE_SIZE, buffer_size * buffers_per_slab));
+    if (slab == nullptr) return false;
+    slabs.push_back(slab);
+
+    // 倒序入链，使取出顺序与内存地址顺序一致
+    for (size_t i = buffers_per_slab; i > 0; --i) {
+        FreeNode* node = reinterpret_cast<FreeNode*>(slab + (i - 1) * buffer_size);
+        node->next = free_list;
+        free_list = node;
+    }
+    capacity.fetch_add(buffers_per_slab, std::memory_order_relaxed);
+    return true;
+}
+
+// 预分配缓冲区
+// 参数：count - 预分配的缓冲区数
+void BufferPool::reserve(size_t count) {
+    while (capacity.load(std::memory_order_relaxed) - in_use.load(std::memory_order_relaxed) < count) {
+        if (!grow()) break;
+    }
+}
+
+// 取出一个缓冲区
+// 返回：缓冲区指针，内存不足时返回nullptr
+char* BufferPool::acquire() {
+    if (free_list != nullptr) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        if (!grow()) return nullptr;
+    }
+    FreeNode* node = free_list;
+    free_list = node->next;
+    in_use.fetch_add(1, std::memory_order_relaxed);
+    return reinterpret_cast<char*>(node);
+}
+
+// 归还缓冲区到空闲链表（后进先出，刚归还的缓冲区大概率仍在缓存中）
+// 参数：buffer - 由acquire取出的缓冲区
+void BufferPool::release(char* buffer) {
+    if (buffer == nullptr) return;
+    FreeNode* node = reinterpret_cast<FreeNode*>(buffer);
+    node->next = free_list;
+    free_list = node;
+    in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// 获取统计信息快照
+BufferPoolStats BufferPool::stats() const {
+    BufferPoolStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.capacity = capacity.load(std::memory_order_relaxed);
+    s.slabs = s.capacity / buffers_per_slab;
+    s.in_use = in_use.load(std::memory_order_relaxed);
+    return s;
+}
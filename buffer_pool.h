@@ -0,0 +1,74 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <vector>                 // 用于记录已分配的slab
+#include <atomic>                 // 用于统计计数器（允许其他线程读取）
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint64_t
+
+// 缓冲池统计信息快照
+struct BufferPoolStats
+{
+    uint64_t hits;        // 从空闲链表直接取到缓冲区的次数
+    uint64_t misses;      // 空闲链表为空、需要分配新slab的次数
+    uint64_t slabs;       // 已分配的slab数
+    uint64_t capacity;    // 缓冲区总数（slabs * 每个slab的缓冲区数）
+    uint64_t in_use;      // 正在被连接使用的缓冲区数
+};
+
+// 固定大小缓冲池：按slab批量分配缓冲区，连接关闭后归还到空闲链表供后续连接复用
+// 说明：每个工作线程拥有独立的缓冲池，只被该线程分配和归还，空闲链表无需加锁；
+//       统计计数器使用relaxed原子变量，便于其他线程读取而不影响热路径
+class BufferPool
+{
+private:
+    // 空闲缓冲区链表节点（直接复用空闲缓冲区的前8个字节）
+    struct FreeNode
+    {
+        FreeNode* next;
+    };
+
+    size_t buffer_size;           // 单个缓冲区大小（按缓存行对齐）
+    size_t buffers_per_slab;      // 每个slab包含的缓冲区数
+    std::vector<char*> slabs;     // 已分配的slab（析构时统一释放）
+    FreeNode* free_list;          // 空闲缓冲区链表头
+
+    std::atomic<uint64_t> hits;       // 命中次数
+    std::atomic<uint64_t> misses;     // 未命中次数
+    std::atomic<uint64_t> capacity;   // 缓冲区总数
+    std::atomic<uint64_t> in_use;     // 使用中的缓冲区数
+
+    // 分配一个新slab并把其中的缓冲区全部加入空闲链表
+    // 返回：true成功，false内存不足
+    bool grow();
+
+public:
+    // 构造函数
+    // 参数：
+    //   buffer_size - 单个缓冲区大小
+    //   buffers_per_slab - 每个slab包含的缓冲区数
+    BufferPool(size_t buffer_size, size_t buffers_per_slab);
+
+    // 析构函数：释放所有slab（调用方需保证此时已没有使用中的缓冲区）
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 预分配缓冲区，使空闲链表至少容纳count个缓冲区
+    // 参数：count - 预分配的缓冲区数
+    void reserve(size_t count);
+
+    // 取出一个缓冲区（内容未初始化）
+    // 返回：缓冲区指针，内存不足时返回nullptr
+    char* acquire();
+
+    // 归还缓冲区到空闲链表
+    // 参数：buffer - 由acquire取出的缓冲区
+    void release(char* buffer);
+
+    // 获取统计信息快照（可由其他线程调用）
+    BufferPoolStats stats() const;
+};
+
+#endif // BUFFER_POOL_H
@@ -2,17 +2,126 @@
 #include "common.h"       // 包含公共常量、配置结构体和日志函数
 #include <getopt.h>       // 用于解析命令行参数
 #include <iostream>       // 用于标准输入输出
+#include <fstream>        // 用于读取场景文件
+#include <string>         // 用于场景文件的逐行解析
+#include <vector>         // 用于场景的阶段列表
 
-// 解析命令行参数到客户端配置
+// 仅有长格式的选项编号（从256开始，避免与短选项字符冲突）
+enum LongOnlyOption
+{
+    OPT_ARRIVAL = 256,      // --arrival=poisson|constant
+    OPT_REPORT_INTERVAL,    // --report-interval=seconds
+    OPT_FORMAT,             // --format=text|json|csv
+    OPT_OUTPUT,             // --output=file
+    OPT_COALESCE,           // --coalesce
+    OPT_PROTOCOL,           // --protocol=1|2
+    OPT_BATCH,              // --batch=n
+    OPT_UNIX,               // --unix=path
+    OPT_SHM,                // --shm=path
+    OPT_SIZES,              // --sizes=size[:weight],...
+    OPT_RAMP,               // --ramp=seconds
+    OPT_CHURN,              // --churn=conns/s
+    OPT_IDLE,               // --idle=n
+    OPT_SLOW_READERS,       // --slow-readers=n
+    OPT_READ_PAUSE,         // --read-pause=ms
+    OPT_SCENARIO            // --scenario=file
+};
+
+// 正在解析的场景文件位置（"文件:行号"），出错时输出，解析命令行时为空
+static std::string option_context;
+
+// 输出用法提示
+// 参数：prog - 程序名
+static void print_usage(const char* prog)
+{
+    if (!option_context.empty()) {
+        std::cerr << "Invalid setting at " << option_context << "\n";
+    }
+    std::cerr << "Usage: " << prog << " [-c connections] [-m messages/conn] [-s msg_size] [-i ip] [-p port] [-l level]\n"
+              << "       [-t threads] [-r msgs/s] [-d seconds] [-w window] [--coalesce] [--arrival=poisson|constant]\n"
+              << "       [--report-interval=seconds] [--format=text|json|csv] [--output=file]\n"
+              << "       [--protocol=1|2] [--batch=n] [--unix=path] [--shm=path]\n"
+              << "       [--sizes=size[:weight],...] [--ramp=seconds] [--churn=conns/s] [--idle=n]\n"
+              << "       [--slow-readers=n] [--read-pause=ms] [--scenario=file]\n";
+}
+
+// 解析消息大小分布（"64:8,1024:2,65536"，省略权重时为1）
 // 参数：
-//   argc - 命令行参数数量
-//   argv - 命令行参数数组
+//   text - 分布描述
+//   mix - 输出参数，各项大小和权重
+// 返回：true合法，false格式错误或大小/权重不为正
+static bool parse_size_mix(const std::string& text, std::vector<MessageSizeWeight>& mix)
+{
+    mix.clear();
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        size_t colon = item.find(':');
+        MessageSizeWeight entry;
+        try {
+            size_t used = 0;
+            entry.size = std::stoi(item.substr(0, colon), &used);
+            if (used != (colon == std::string::npos ? item.size() : colon)) return false;
+            entry.weight = 1;
+            if (colon != std::string::npos) {
+                entry.weight = std::stoi(item.substr(colon + 1), &used);
+                if (used != item.size() - colon - 1) return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (entry.size <= 0 || entry.weight <= 0) return false;
+        mix.push_back(entry);
+        pos = end + 1;
+    }
+    return !mix.empty();
+}
+
+// 长选项表（场景文件中的设置项与长选项同名）
+static const struct option long_options[] = {
+    {"connections", required_argument, nullptr, 'c'},
+    {"messages",    required_argument, nullptr, 'm'},
+    {"size",        required_argument, nullptr, 's'},
+    {"ip",          required_argument, nullptr, 'i'},
+    {"port",        required_argument, nullptr, 'p'},
+    {"log-level",   required_argument, nullptr, 'l'},
+    {"threads",     required_argument, nullptr, 't'},
+    {"rate",        required_argument, nullptr, 'r'},
+    {"duration",    required_argument, nullptr, 'd'},
+    {"window",      required_argument, nullptr, 'w'},
+    {"coalesce",    no_argument,       nullptr, OPT_COALESCE},
+    {"arrival",     required_argument, nullptr, OPT_ARRIVAL},
+    {"report-interval", required_argument, nullptr, OPT_REPORT_INTERVAL},
+    {"format",      required_argument, nullptr, OPT_FORMAT},
+    {"output",      required_argument, nullptr, OPT_OUTPUT},
+    {"protocol",    required_argument, nullptr, OPT_PROTOCOL},
+    {"batch",       required_argument, nullptr, OPT_BATCH},
+    {"unix",        required_argument, nullptr, OPT_UNIX},
+    {"shm",         required_argument, nullptr, OPT_SHM},
+    {"sizes",       required_argument, nullptr, OPT_SIZES},
+    {"ramp",        required_argument, nullptr, OPT_RAMP},
+    {"churn",       required_argument, nullptr, OPT_CHURN},
+    {"idle",        required_argument, nullptr, OPT_IDLE},
+    {"slow-readers", required_argument, nullptr, OPT_SLOW_READERS},
+    {"read-pause",  required_argument, nullptr, OPT_READ_PAUSE},
+    {"scenario",    required_argument, nullptr, OPT_SCENARIO},
+    {nullptr, 0, nullptr, 0}
+};
+
+// 解析选项到客户端配置（不做选项间的一致性检查，见finish_config）
+// 说明：可重复调用（每次重新开始扫描argv），场景文件的每一行都经由这里解析
+// 参数：
+//   argc - 参数数量
+//   argv - 参数数组（argv[0]为程序名）
 //   config - 输出参数，存储解析后的配置
-void parse_args(int argc, char* argv[], ClientConfig& config) 
+//   scenario - 输出参数，--scenario指定的场景文件（可为nullptr，表示不接受该选项）
+static void parse_options(int argc, char* argv[], ClientConfig& config, std::string* scenario)
 {
-    int opt;  // 存储getopt的返回值（解析到的选项）
-    // 使用getopt循环解析短选项（格式：-选项 参数）
-    while ((opt = getopt(argc, argv, "c:m:s:i:p")) != -1) {
+    optind = 0;  // glibc：从头重新初始化getopt的扫描状态
+    int opt;  // 存储getopt_long的返回值（解析到的选项）
+    while ((opt = getopt_long(argc, argv, "c:m:s:i:p:l:t:r:d:w:", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'c':  // 连接数（-c）
                 config.connections = std::stoi(optarg);  // optarg为选项后的参数值
@@ -20,8 +129,12 @@ void parse_args(int argc, char* argv[], ClientConfig& config)
             case 'm':  // 每个连接的消息数（-m）
                 config.messages_per_conn = std::stoi(optarg);
                 break;
-            case 's':  // 消息大小（-s）
+            case 's':  // 消息大小（-s），可超过BUFFER_SIZE（服务端流式回射）
                 config.message_size = std::stoi(optarg);
+                if (config.message_size <= 0) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
                 break;
             case 'i':  // 服务器IP（-i）
                 config.server_ip = optarg;
@@ -29,29 +142,275 @@ void parse_args(int argc, char* argv[], ClientConfig& config)
             case 'p':  // 服务器端口（-p）
                 config.server_port = std::stoi(optarg);
                 break;
+            case 'l': {  // 日志级别（-l debug|info|warn|error|off）
+                LogLevel level;
+                if (!Logger::parse_level(optarg, level)) {
+                    std::cerr << "Invalid log level: " << optarg << "\n";
+                    exit(1);
+                }
+                Logger::set_level(level);
+                break;
+            }
+            case 't':  // 事件驱动模式的线程数（-t，每个线程用epoll驱动多个连接）
+                config.threads = std::stoi(optarg);
+                break;
+            case 'r':  // 开环发送的目标总速率（-r 条/秒）
+                config.rate = std::stod(optarg);
+                break;
+            case 'd':  // 发送时长（-d 秒，不再受每连接消息数限制）
+                config.duration = std::stoi(optarg);
+                break;
+            case 'w':  // 每个连接的在途消息上限（-w，流水线发送）
+                config.window = std::stoi(optarg);
+                break;
+            case OPT_COALESCE:  // 多条报文合并为一次send
+                config.coalesce = true;
+                break;
+            case OPT_ARRIVAL:  // 开环发送的到达过程
+                if (std::string(optarg) == "poisson") {
+                    config.arrival = ArrivalProcess::POISSON;
+                } else if (std::string(optarg) == "constant") {
+                    config.arrival = ArrivalProcess::CONSTANT;
+                } else {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_REPORT_INTERVAL:  // 周期报告间隔（秒，仅事件驱动模式）
+                config.report_interval = std::stoi(optarg);
+                break;
+            case OPT_FORMAT:  // 统计结果格式（json/csv供回归看板直接读取）
+                if (std::string(optarg) == "text") {
+                    config.report_format = ReportFormat::TEXT;
+                } else if (std::string(optarg) == "json") {
+                    config.report_format = ReportFormat::JSON;
+                } else if (std::string(optarg) == "csv") {
+                    config.report_format = ReportFormat::CSV;
+                } else {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_OUTPUT:  // JSON/CSV结果的输出文件
+                config.report_file = optarg;
+                break;
+            case OPT_PROTOCOL:  // 报文版本（2：带报文头CRC32C，可批量）
+                config.protocol = std::stoi(optarg);
+                if (config.protocol != 1 && config.protocol != 2) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_BATCH:  // v2每个报文的子消息数
+                config.batch = std::stoi(optarg);
+                if (config.batch <= 0 || config.batch > UINT16_MAX) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_UNIX:  // 经Unix域套接字连接服务端（服务端--unix的路径）
+                config.unix_path = optarg;
+                break;
+            case OPT_SHM:  // 经共享内存通道连接服务端（服务端--shm的路径）
+                config.shm_path = optarg;
+                break;
+            case OPT_SIZES:  // 消息大小分布（每个报文按权重随机选取）
+                if (!parse_size_mix(optarg, config.size_mix)) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_RAMP:  // 开环速率从0线性升到--rate的时间（秒）
+                config.ramp_up = std::stod(optarg);
+                break;
+            case OPT_CHURN:  // 每秒关闭并重连的连接数
+                config.churn_rate = std::stod(optarg);
+                break;
+            case OPT_IDLE:  // 额外的空闲连接数（只建立、不发送）
+                config.idle_connections = std::stoi(optarg);
+                break;
+            case OPT_SLOW_READERS:  // 慢读连接数（发送连接中的前n个）
+                config.slow_readers = std::stoi(optarg);
+                break;
+            case OPT_READ_PAUSE:  // 慢读连接每次读取后的暂停时间（毫秒）
+                config.read_pause_ms = std::stoi(optarg);
+                if (config.read_pause_ms <= 0) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_SCENARIO:  // 场景文件（只能在命令行上指定）
+                if (scenario == nullptr) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                *scenario = optarg;
+                break;
             default:  // 未知选项
-                // 输出用法提示并退出
-                std::cerr << "Usage: " << argv[0] << " [-c connections] [-m messages/conn] [-s msg_size] [-i ip] [-p port] [-t]\n";
+                print_usage(argv[0]);
                 exit(1);
         }
     }
+    if (optind < argc) {  // 不接受非选项参数
+        print_usage(argv[0]);
+        exit(1);
+    }
+}
+
+// 检查选项间的一致性并补全默认值（出错时退出）
+// 参数：config - 客户端配置
+static void finish_config(ClientConfig& config)
+{
+    const char* where = option_context.empty() ? "" : option_context.c_str();
+    const char* sep = option_context.empty() ? "" : ": ";
+    if (config.connections <= 0 || config.idle_connections < 0 || config.slow_readers < 0 ||
+        config.slow_readers > config.connections || config.ramp_up < 0 || config.churn_rate < 0) {
+        std::cerr << where << sep << "invalid connection, idle, slow reader, ramp or churn setting\n";
+        exit(1);
+    }
+    if (!config.unix_path.empty() && !config.shm_path.empty()) {
+        std::cerr << where << sep << "--unix and --shm are mutually exclusive\n";
+        exit(1);
+    }
+    if (config.batch > 1 && config.protocol != 2) {  // 批量报文只有v2支持
+        std::cerr << where << sep << "--batch requires --protocol=2\n";
+        exit(1);
+    }
+    // 速率、时长、窗口、合并发送和周期报告只对事件驱动模式有效：未指定线程数时默认使用一个事件线程；
+    // 每连接一线程模式的单次send/recv不处理短读短写，超过BUFFER_SIZE的消息同样改用事件驱动模式；
+    // v2报文、Unix域套接字、共享内存传输和场景文件描述的负载形态也只由事件驱动模式支持
+    if ((config.rate > 0 || config.duration > 0 || config.window > 0 || config.coalesce ||
+         config.report_interval > 0 || config.message_size > BUFFER_SIZE || config.protocol == 2 ||
+         !config.unix_path.empty() || !config.shm_path.empty() || !config.size_mix.empty() ||
+         config.ramp_up > 0 || config.churn_rate > 0 || config.idle_connections > 0 || config.slow_readers > 0) &&
+        config.threads <= 0) {
+        config.threads = 1;
+    }
+}
+
+// 解析命令行参数到客户端配置
+// 参数：
+//   argc - 命令行参数数量
+//   argv - 命令行参数数组
+//   config - 输出参数，存储解析后的配置
+//   scenario - 输出参数，--scenario指定的场景文件（未指定时为空）
+void parse_args(int argc, char* argv[], ClientConfig& config, std::string& scenario)
+{
+    parse_options(argc, argv, config, &scenario);
+    finish_config(config);
+}
+
+// 去掉字符串首尾的空白
+static std::string trim(const std::string& text)
+{
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// 读取场景文件：每个阶段在命令行配置之上叠加文件中的设置
+// 说明：文件格式为逐行的"设置项 = 值"，设置项与长选项同名（如connections、rate、sizes、churn），
+//       不带值的开关（如coalesce）只写名称；#之后为注释。"[名称]"开始一个新阶段，
+//       第一个阶段之前的设置作用于所有阶段。各阶段互不继承，阶段之间依次运行。
+//       报告格式、输出文件和日志级别作用于整个场景，只能在命令行上指定
+// 参数：
+//   prog - 程序名（用法提示）
+//   path - 场景文件路径
+//   base - 命令行配置
+//   phases - 输出参数，各阶段的配置
+// 返回：true成功，false文件无法读取或格式错误（错误已输出到stderr；设置项的值非法时直接退出）
+static bool load_scenario(const char* prog, const std::string& path, const ClientConfig& base,
+                          std::vector<ScenarioPhase>& phases)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open scenario file " << path << "\n";
+        return false;
+    }
+
+    // 先按阶段收集设置项（连同行号），再逐项解析
+    struct Setting
+    {
+        std::string option;   // "--设置项=值"
+        int line;
+    };
+    std::vector<Setting> defaults;
+    std::vector<std::pair<std::string, std::vector<Setting>>> sections;
+    std::string text;
+    for (int line = 1; std::getline(in, text); ++line) {
+        text = trim(text.substr(0, text.find('#')));
+        if (text.empty()) continue;
+        std::string where = path + ":" + std::to_string(line);
+        if (text.front() == '[') {
+            std::string name = text.back() == ']' ? trim(text.substr(1, text.size() - 2)) : "";
+            if (name.empty() || name.find_first_of(" \t,\"") != std::string::npos) {
+                std::cerr << where << ": invalid phase header " << text << "\n";
+                return false;
+            }
+            sections.emplace_back(name, std::vector<Setting>());
+            continue;
+        }
+        size_t eq = text.find('=');
+        std::string key = trim(text.substr(0, eq));
+        if (key == "scenario" || key == "format" || key == "output" || key == "log-level") {
+            std::cerr << where << ": " << key << " can only be set on the command line\n";
+            return false;
+        }
+        std::string option = "--" + key;
+        if (eq != std::string::npos) option += "=" + trim(text.substr(eq + 1));
+        (sections.empty() ? defaults : sections.back().second).push_back(Setting{option, line});
+    }
+    if (sections.empty()) {
+        std::cerr << path << ": no phases defined\n";
+        return false;
+    }
+
+    for (const auto& section : sections) {
+        ScenarioPhase phase;
+        phase.name = section.first;
+        phase.config = base;
+        std::vector<Setting> settings = defaults;
+        settings.insert(settings.end(), section.second.begin(), section.second.end());
+        for (const Setting& setting : settings) {
+            option_context = path + ":" + std::to_string(setting.line);
+            std::vector<char> arg(setting.option.begin(), setting.option.end());
+            arg.push_back('\0');
+            char* argv[] = {const_cast<char*>(prog), arg.data(), nullptr};
+            parse_options(2, argv, phase.config, nullptr);
+        }
+        option_context = path + " [" + phase.name + "]";
+        finish_config(phase.config);
+        if (phase.config.threads <= 0) phase.config.threads = 1;  // 阶段总是以事件驱动模式运行
+        phases.push_back(phase);
+    }
+    option_context.clear();
+    return true;
 }
 
 // 客户端程序入口函数
 int main(int argc, char* argv[])
 {
     ClientConfig config;  // 客户端配置对象（使用默认值初始化）
-    parse_args(argc, argv, config);  // 解析命令行参数更新配置
+    std::string scenario;  // 场景文件（可选）
+    parse_args(argc, argv, config, scenario);  // 解析命令行参数更新配置
+    std::vector<ScenarioPhase> phases;  // 场景的各个阶段
+    if (!scenario.empty() && !load_scenario(argv[0], scenario, config, phases)) {
+        return 1;
+    }
+    Logger::start();  // 日志改由后台线程批量输出
 
     try {
-        // 初始化EchoClient对象，传入配置
-        EchoClient client(config);
+        // 初始化EchoClient对象，传入配置（和场景的各个阶段）
+        EchoClient client(config, phases);
         // 运行客户端（建立连接并发送消息）
         client.run();
     } catch (const std::exception& e) {
         // 捕获并输出客户端运行过程中的异常
-        log_error("Client exception: " + std::string(e.what()));
+        LOG_ERROR("Client exception: %s", e.what());
+        Logger::stop();
         return 1;  // 异常退出
     }
+    Logger::stop();  // 输出剩余日志
     return 0;  // 正常退出
 }
\ No newline at end of file
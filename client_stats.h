@@ -0,0 +1,21 @@
+#ifndef CLIENT_STATS_H
+#define CLIENT_STATS_H
+
+#include "per_thread_counters.h"  // 包含单线程统计计数块
+
+// 客户端计数器下标
+enum ClientCounter
+{
+    CLIENT_CONNECTIONS,   // 成功建立的连接数
+    CLIENT_SENT,          // 发出的消息数
+    CLIENT_RECEIVED,      // 收到且校验通过的回射数
+    CLIENT_ERRORS,        // 错误数
+    CLIENT_BYTES,         // 校验通过的回射字节数（报文头+数据）
+    CLIENT_RECONNECTS,    // 按连接更替速率（--churn）主动关闭并重连的次数
+    CLIENT_COUNTER_COUNT
+};
+
+// 客户端每个线程（同步模式的每个连接线程或事件驱动模式的每个压测线程）一个统计块
+typedef PerThreadCounters<CLIENT_COUNTER_COUNT> ClientStats;
+
+#endif // CLIENT_STATS_H
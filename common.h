@@ -2,18 +2,34 @@
 #define COMMON_H
 
 #include <cstdint>   // 用于固定宽度整数类型（如uint32_t）
+#include <cstddef>   // 用于size_t
 #include <string>    // 用于字符串处理
+#include <vector>    // 用于列表类配置项
+#include "logger.h"  // 包含日志宏（LOG_INFO/LOG_ERROR等）
 
 // 32位有效魔数（0x1A2B3C4D = 439041101 < 2^32）
 // 作用：用于校验客户端与服务器之间的通信合法性，防止非法连接
 const uint32_t MAGIC_NUMBER = 0x1A2B3C4D;
 
+// v2报文的魔数：与v1的魔数只差最低位，服务端按魔数区分两种报文，同一连接上可以混用
+const uint32_t MAGIC_NUMBER_V2 = 0x1A2B3C4E;
+
 // 默认服务端监听端口
 const int DEFAULT_PORT = 15000;
 
-// 缓冲区大小（设置为大于最大消息长度，避免数据截断）
+// 缓冲区大小：服务端整条缓存后回射的最大数据长度，更长的报文改为流式回射（见ConnState::STREAM_PAYLOAD）
 const int BUFFER_SIZE = 4096;
 
+// 服务端每个连接的接收缓冲区大小（可一次容纳多条流水线报文，且不小于一条整条缓存的报文）
+// 注：流式回射的大报文也经由该缓冲区分段转发，每个连接的内存占用与报文大小无关
+const int RX_BUFFER_SIZE = 16384;
+
+// 默认允许的最大数据长度（16MB），超出时视为长度非法并关闭连接
+const uint32_t DEFAULT_MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+
+// 默认的监听队列长度（listen的backlog参数，实际上限受net.core.somaxconn限制）
+const int DEFAULT_LISTEN_BACKLOG = 1024;
+
 // 报文头结构（固定12字节）
 // 作用：定义通信协议的头部格式，用于解析消息边界和元信息
 struct MessageHeader
@@ -23,8 +39,49 @@ struct MessageHeader
     uint32_t msg_id;     // 消息ID（网络字节序）：用于消息编号和匹配请求/响应
 };
 
+// v2报文头结构（固定20字节）：一个报文头描述一批等长的子消息，并带有报文头校验
+// 说明：数据部分为count条子消息依次排列，每条data_len / count字节，
+//       第i条子消息的ID为msg_id + i。header_crc为前16字节的CRC32C，
+//       报文头损坏（如长度字段错位）时服务端立即关闭连接，而不是按错误的长度继续切分
+struct MessageHeaderV2
+{
+    uint32_t magic;      // 魔数（网络字节序，MAGIC_NUMBER_V2）
+    uint32_t data_len;   // 数据部分总长度（网络字节序，所有子消息之和，必须是count的整数倍）
+    uint32_t msg_id;     // 第一条子消息的ID（网络字节序）
+    uint16_t count;      // 子消息条数（网络字节序，至少为1）
+    uint16_t flags;      // 标志位（网络字节序，目前没有定义，必须为0）
+    uint32_t header_crc; // 报文头前16字节的CRC32C（网络字节序）
+};
+
+static_assert(sizeof(MessageHeaderV2) == 20, "MessageHeaderV2 must not be padded");
+
+// v2报文头中参与CRC计算的字节数（header_crc之前的全部字段）
+const size_t HEADER_V2_CRC_BYTES = 16;
+
+// 开环发送的到达过程
+enum class ArrivalProcess
+{
+    CONSTANT, // 固定间隔
+    POISSON   // 泊松过程（间隔服从指数分布，更接近真实流量）
+};
+
+// 客户端统计结果的输出格式
+enum class ReportFormat
+{
+    TEXT,     // 可读文本（经日志输出）
+    JSON,     // 每条报告一行JSON对象（JSON Lines）
+    CSV       // 表头加每条报告一行
+};
+
+// 消息大小分布中的一项：按权重随机选取每个报文的数据长度
+struct MessageSizeWeight
+{
+    int size;                             // 数据部分大小（字节，v2批量时为每条子消息的大小）
+    int weight;                           // 权重（相对值）
+};
+
 // 客户端配置结构体
-// 作用：存储客户端的所有配置参数，通过命令行参数初始化
+// 作用：存储客户端的所有配置参数，通过命令行参数（或场景文件中的一个阶段）初始化
 struct ClientConfig 
 {
     std::string server_ip = "127.0.0.1";  // 服务器IP地址，默认本地回环
@@ -32,20 +89,86 @@ struct ClientConfig
     int connections = 1;                  // 连接数，默认1个连接
     int messages_per_conn = 1;            // 每个连接发送的消息数，默认1条
     int message_size = 1024;              // 每条消息的数据部分大小，默认1024字节
+    int threads = 0;                      // 事件驱动模式的线程数，0表示每个连接一个线程（同步闭环模式）
+    double rate = 0;                      // 事件驱动模式的目标总发送速率（条/秒），0表示闭环（收到回射后立即发下一条）
+    ArrivalProcess arrival = ArrivalProcess::POISSON;  // 开环发送的到达过程
+    int duration = 0;                     // 事件驱动模式的发送时长（秒），0表示发完每连接消息数即结束
+    int window = 0;                       // 事件驱动模式每个连接的在途消息上限，0表示默认（闭环1条，开环不限）
+    bool coalesce = false;                // 是否把一轮处理中的多条报文合并为一次send
+    int report_interval = 0;              // 周期报告间隔（秒，仅事件驱动模式），0表示只在结束时报告
+    ReportFormat report_format = ReportFormat::TEXT;  // 统计结果的输出格式
+    std::string report_file;              // JSON/CSV结果的输出文件，为空表示输出到stdout
+    int protocol = 1;                     // 报文版本：1为MessageHeader，2为MessageHeaderV2（带报文头CRC32C）
+    int batch = 1;                        // v2每个报文携带的子消息数（统计和-m按子消息计，窗口按报文计）
+    std::string unix_path;                // 经Unix域套接字连接服务端（忽略IP和端口），为空表示使用TCP
+    std::string shm_path;                 // 经共享内存通道连接服务端（该路径为服务端的--shm套接字），为空表示不使用
+    std::vector<MessageSizeWeight> size_mix;  // 消息大小分布，为空表示所有消息都是message_size
+    double ramp_up = 0;                   // 开环速率从0线性升到rate所用的时间（秒），0表示直接以rate开始
+    double churn_rate = 0;                // 每秒关闭并重连的连接数（连接先取完在途回射再重连），0表示不重连
+    int idle_connections = 0;             // 额外建立、只保持不发送的空闲连接数
+    int slow_readers = 0;                 // 慢读连接数（每次读取后暂停read_pause_ms，不计入空闲连接）
+    int read_pause_ms = 100;              // 慢读连接每次读取后暂停读取的时间（毫秒）
 };
 
-// 日志函数：输出信息级日志
-// 参数：msg - 日志内容
-inline void log_info(const std::string& msg)
+// 服务端IO后端
+enum class IoBackend
 {
-    printf("[INFO] %s\n", msg.c_str());
-}
+    EPOLL,    // epoll事件循环（默认，适用于所有内核）
+    URING     // io_uring（多路accept/recv + 链式send，内核不支持时回退到epoll）
+};
 
-// 日志函数：输出错误级日志
-// 参数：msg - 日志内容
-inline void log_error(const std::string& msg)
+// 工作线程事件循环的轮询策略
+enum class PollMode
 {
-    printf("[ERROR] %s\n", msg.c_str());
-}
+    BLOCK,    // 没有事件时阻塞等待（默认，空闲时不占用CPU）
+    SPIN,     // 最近一次有事件后的poll_spin_us内不阻塞、持续轮询，之后阻塞等待
+    BUSY      // 从不阻塞（独占一个核，换取最低的唤醒延迟）
+};
+
+// 服务端配置结构体
+// 作用：存储服务端的所有配置参数，通过命令行参数初始化
+struct ServerConfig
+{
+    int port = DEFAULT_PORT;              // 监听端口，默认15000
+    int worker_threads = 0;               // 工作线程数，0表示按CPU核数自动设置
+    bool reuseport = false;               // 多reactor模式：每个线程独立epoll+SO_REUSEPORT监听
+    std::vector<int> cpu_list;            // 工作线程绑定的CPU列表（为空表示不绑定）
+    bool numa = false;                    // 按NUMA节点放置工作线程及其缓冲池，新连接交给接收CPU所在节点的线程
+    bool tcp_nodelay = true;              // 已接受连接是否设置TCP_NODELAY（关闭Nagle算法）
+    int sndbuf = 0;                       // 已接受连接的SO_SNDBUF，0表示使用系统默认值
+    int rcvbuf = 0;                       // 已接受连接的SO_RCVBUF，0表示使用系统默认值
+    int pool_slab_buffers = 64;           // 缓冲池每个slab包含的缓冲区数
+    int pool_prealloc = 0;                // 每个工作线程启动时预分配的缓冲区数
+    int stats_interval = 0;               // 周期性输出统计日志的间隔（秒），0表示不输出
+    IoBackend backend = IoBackend::EPOLL; // 工作线程使用的IO后端
+    int zerocopy_threshold = 0;           // 数据部分不小于该字节数的报文经splice零拷贝回射，0表示关闭（仅epoll后端）
+    int admin_port = 0;                   // 管理端口（GET /metrics输出Prometheus指标），0表示关闭
+    uint32_t max_message_size = DEFAULT_MAX_MESSAGE_SIZE; // 允许的最大数据长度（字节）
+    int output_high_water = 8192;         // 待回射字节数达到该值时暂停读取该连接（写回背压）
+    int write_timeout = 10;               // 回射持续被阻塞超过该秒数的连接视为慢消费者并关闭，0表示不限制
+    int idle_timeout = 60;                // 没有未完成报文的连接空闲超过该秒数后关闭，0表示不限制
+    int listen_backlog = DEFAULT_LISTEN_BACKLOG; // 监听队列长度
+    int accept_budget = 64;               // 每轮事件循环最多接受的新连接数，0表示不限制（接受到EAGAIN为止）
+    int defer_accept = 0;                 // TCP_DEFER_ACCEPT秒数：连接收到首个数据后才唤醒accept，0表示关闭
+    int drain_timeout = 10;               // 收到关闭信号后等待连接排空的最长秒数
+    std::string handoff_path;             // 热重启交接监听套接字的Unix域套接字路径，为空表示关闭
+    std::string unix_path;                // 额外的Unix域监听套接字路径（同机客户端绕过TCP协议栈），为空表示关闭
+    std::string shm_path;                 // 共享内存传输的Unix域套接字路径（建立通道用），为空表示关闭
+    size_t shm_ring_size = 1 << 20;       // 共享内存通道单个环的大小（字节，2的幂且为页大小的整数倍）
+    PollMode poll_mode = PollMode::BLOCK; // 各工作线程（含共享内存线程）事件循环的轮询策略
+    int poll_spin_us = 50;                // SPIN策略下最近一次有事件后继续轮询的微秒数
+    int busy_poll_us = 0;                 // 内核忙轮询微秒数（SO_BUSY_POLL、epoll/io_uring的NAPI忙轮询），0表示关闭
+    bool prefer_busy_poll = false;        // 设置SO_PREFER_BUSY_POLL（配合网卡中断延迟，忙轮询期间不再触发软中断）
+    int event_budget = 65536;             // 一个连接每轮最多读取的字节数（乘以连接权重），用完后让出，0表示不限制（仅epoll后端）
+    int event_frame_budget = 0;           // 一个连接每轮最多回射的报文数（乘以连接权重），0表示不限制（仅epoll后端）
+    int tcp_weight = 1;                   // TCP监听套接字上的连接的调度权重（每轮预算的倍数）
+    int unix_weight = 1;                  // Unix域监听套接字上的连接的调度权重
+    int max_connections = 0;              // 总连接数上限（含Unix域和共享内存连接），超出时接受后立即拒绝，0表示不限制
+    int max_connections_per_ip = 0;       // 单个来源IP的连接数上限，0表示不限制
+    long long max_inflight_bytes = 0;     // 待回射字节数上限（按工作线程平分），超出时暂停读取，0表示不限制（仅epoll后端）
+    uint32_t trace_sample = 0;            // 每N条报文抽样追踪一条（GET /trace或SIGUSR1导出），0表示关闭（epoll/io_uring后端）
+    int trace_capacity = 4096;            // 每个工作线程保留的最近追踪记录数
+    std::string trace_file;               // SIGUSR1导出追踪记录的文件路径，为空表示echo-trace-<pid>.json
+};
 
 #endif // COMMON_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include "common.h"               // 包含报文头结构和缓冲区大小
+#include "iovec_list.h"           // 包含分散/聚集写列表
+#include "timer_wheel.h"          // 包含超时定时器节点
+#include "trace.h"                // 包含抽样报文的追踪记录
+#include <chrono>                 // 用于记录阶段开始时间（超时控制）
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint64_t
+
+// 连接解析状态：描述接收缓冲区末尾那条尚未收全的报文所处的阶段
+enum class ConnState
+{
+    READ_HEADER,     // 正在等待报文头（缓冲区为空或报文头不足12字节）
+    READ_PAYLOAD,    // 报文头已收全并校验通过，正在等待数据部分
+    SPLICE_PAYLOAD,  // 大报文零拷贝回射：数据部分经管道从套接字直接转发回套接字（不进入接收缓冲区）
+    STREAM_PAYLOAD   // 大报文流式回射：数据部分分段读入接收缓冲区，每段读到后立即回射
+};
+
+// 单个客户端连接的状态：保存读写缓冲区及游标，使不完整的报文和回射可以跨事件续传
+// 说明：一次read可能带来多条流水线报文，解析出的所有完整报文按顺序以
+//       "报文头+数据"两段iovec加入回射列表（直接引用接收缓冲区，不拷贝），一次writev回射；
+//       末尾不完整的报文保留在接收缓冲区，等待下一次事件
+// 注：连接固定归属一个工作线程，只被该线程访问。对象存放在按fd索引的连接表中，
+//     按缓存行对齐，避免相邻连接共享缓存行；epoll事件的data.ptr直接指向该对象
+struct alignas(64) Connection
+{
+    int fd;                                  // 客户端文件描述符（槽位空闲时为-1）
+    bool in_use;                             // 槽位是否被连接占用
+    bool want_write;                         // 是否已在epoll中注册EPOLLOUT（写被阻塞时）
+    bool queued;                             // 槽位在工作线程的就绪队列中（用完预算、等待下一轮，仅epoll后端）
+    ConnState state;                         // 末尾未完成报文的解析状态
+    uint32_t weight;                         // 调度权重：每轮预算的倍数（按所属监听套接字设置）
+
+    char* rx_buf;                            // 接收缓冲区（RX_BUFFER_SIZE字节，取自工作线程的缓冲池）
+    size_t rx_start;                         // 未解析数据的起始位置
+    size_t rx_end;                           // 已接收数据的结束位置
+
+    IovecList output;                        // 待回射的iovec列表（引用rx_buf，写完前不可整理rx_buf）
+
+    // 大报文转发状态（仅SPLICE_PAYLOAD/STREAM_PAYLOAD阶段使用）
+    size_t payload_remaining;                // 数据部分尚未从套接字读出（流式：尚未加入回射列表）的字节数
+    uint32_t payload_msg_id;                 // 正在转发的报文ID（用于日志）
+    int pipe_fds[2];                         // splice中转管道（首次遇到大报文时创建，关闭连接时释放）
+    size_t pipe_bytes;                       // 已进入管道、尚未写回套接字的字节数
+
+    // 当前阶段开始时间：用于报文头/数据读取超时和空闲超时
+    std::chrono::steady_clock::time_point stage_start;
+
+    // 写阻塞开始时间：回射被对端写缓冲区阻塞时记录（io_uring：send链提交时记录），
+    // 用于阶段耗时统计和写超时
+    std::chrono::steady_clock::time_point write_start;
+
+    // 超时定时器（挂在所属工作线程的时间轮上，关闭连接时取消）
+    TimerNode timer;
+
+    // 连接级统计
+    uint64_t frames;                         // 已回射的报文数
+    uint64_t bytes_in;                       // 已接收字节数
+    uint64_t bytes_out;                      // 已写出字节数
+
+    // 抽样追踪（仅开启--trace-sample时使用）：正在追踪的报文，回射写出到trace_end（按bytes_out计）时完成
+    bool tracing;                            // 是否有正在追踪的报文
+    uint64_t trace_end;                      // 该报文回射的结束位置（写出字节数达到该值即写出完成）
+    FrameTrace trace;                        // 追踪记录
+
+    Connection()
+        : fd(-1), in_use(false), want_write(false), queued(false), state(ConnState::READ_HEADER), weight(1),
+          rx_buf(nullptr), rx_start(0), rx_end(0), output(16),
+          payload_remaining(0), payload_msg_id(0), pipe_bytes(0),
+          frames(0), bytes_in(0), bytes_out(0), tracing(false), trace_end(0) {
+        pipe_fds[0] = -1;
+        pipe_fds[1] = -1;
+        timer.owner = this;
+    }
+
+    // 为新连接复位槽位（保留回射列表已分配的容量，槽位复用时无需重新分配）
+    // 注：不复位queued，槽位仍在就绪队列中时由队列出队时清除（新连接只是多得到一轮）
+    // 参数：
+    //   fd - 客户端文件描述符
+    //   rx_buf - 接收缓冲区（由调用方从缓冲池取出，关闭连接时归还）
+    void reset(int fd, char* rx_buf) {
+        this->fd = fd;
+        this->rx_buf = rx_buf;
+        in_use = true;
+        want_write = false;
+        state = ConnState::READ_HEADER;
+        weight = 1;
+        stage_start = std::chrono::steady_clock::now();  // 空闲超时从连接建立起计时
+        write_start = stage_start;
+        rx_start = 0;
+        rx_end = 0;
+        output.clear();
+        payload_remaining = 0;
+        pipe_bytes = 0;
+        payload_msg_id = 0;
+        frames = 0;
+        bytes_in = 0;
+        bytes_out = 0;
+        tracing = false;
+    }
+};
+
+#endif // CONNECTION_H
@@ -0,0 +1,105 @@
+#ifndef CONNECTION_TABLE_H
+#define CONNECTION_TABLE_H
+
+#include "connection.h"           // 包含连接状态结构
+#include <vector>                 // 用于存储分块指针
+#include <cstddef>                // 用于size_t
+#include <new>                    // 用于std::nothrow
+
+// 连接表：按fd直接索引的扁平连接槽位数组
+// 说明：fd是很小且稠密的整数，直接用作下标即可定位连接，无需哈希和加锁。
+//       槽位按固定大小分块分配，扩容时已有槽位的地址保持不变，
+//       因此可以把槽位指针存入epoll_event.data.ptr或io_uring的user_data
+// 模板参数：Conn - 槽位类型（Connection或其派生类，需提供fd、in_use和reset(fd, rx_buf)）
+// 注：只被所属工作线程访问
+template <typename Conn = Connection>
+class ConnectionTable
+{
+private:
+    static const int CHUNK_SHIFT = 10;                     // 每块槽位数的对数
+    static const size_t CHUNK_SIZE = 1u << CHUNK_SHIFT;    // 每块槽位数（1024）
+
+    std::vector<Conn*> chunks;        // 槽位分块（按缓存行对齐分配）
+    size_t active;                    // 使用中的槽位数
+
+    // 确保指定分块已分配
+    // 说明：槽位类型按缓存行对齐，C++17的new[]会按alignof(Conn)分配
+    // 参数：chunk_index - 分块下标
+    // 返回：true成功，false内存不足
+    bool ensure_chunk(size_t chunk_index) {
+        if (chunk_index >= chunks.size()) {
+            chunks.resize(chunk_index + 1, nullptr);
+        }
+        if (chunks[chunk_index] != nullptr) return true;
+
+        Conn* chunk = new (std::nothrow) Conn[CHUNK_SIZE]();
+        if (chunk == nullptr) return false;
+        chunks[chunk_index] = chunk;
+        return true;
+    }
+
+public:
+    ConnectionTable() : active(0) {}
+
+    // 析构函数：析构所有槽位并释放分块（不关闭fd，由调用方负责）
+    ~ConnectionTable() {
+        for (Conn* chunk : chunks) {
+            delete[] chunk;
+        }
+    }
+
+    ConnectionTable(const ConnectionTable&) = delete;
+    ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+    // 为新连接占用fd对应的槽位
+    // 参数：
+    //   fd - 客户端文件描述符
+    //   rx_buf - 接收缓冲区
+    // 返回：槽位指针，内存不足时返回nullptr
+    Conn* open(int fd, char* rx_buf) {
+        if (fd < 0) return nullptr;
+        size_t index = static_cast<size_t>(fd);
+        if (!ensure_chunk(index >> CHUNK_SHIFT)) return nullptr;
+        Conn* conn = &chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)];
+        if (!conn->in_use) ++active;
+        conn->reset(fd, rx_buf);
+        return conn;
+    }
+
+    // 查找fd对应的使用中的槽位
+    // 返回：槽位指针，不存在时返回nullptr
+    Conn* get(int fd) const {
+        if (fd < 0) return nullptr;
+        size_t index = static_cast<size_t>(fd);
+        size_t chunk_index = index >> CHUNK_SHIFT;
+        if (chunk_index >= chunks.size() || chunks[chunk_index] == nullptr) return nullptr;
+        Conn* conn = &chunks[chunk_index][index & (CHUNK_SIZE - 1)];
+        return conn->in_use ? conn : nullptr;
+    }
+
+    // 释放槽位（不关闭fd、不归还缓冲区）
+    void release(Conn* conn) {
+        if (conn == nullptr || !conn->in_use) return;
+        conn->in_use = false;
+        conn->fd = -1;
+        conn->rx_buf = nullptr;
+        --active;
+    }
+
+    // 使用中的槽位数
+    size_t size() const { return active; }
+
+    // 遍历所有使用中的槽位（回调中释放当前槽位是安全的）
+    // 参数：func - 回调，参数为Conn&
+    template <typename Func>
+    void for_each(Func func) {
+        for (Conn* chunk : chunks) {
+            if (chunk == nullptr) continue;
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                if (chunk[i].in_use) func(chunk[i]);
+            }
+        }
+    }
+};
+
+#endif // CONNECTION_TABLE_H
@@ -0,0 +1,111 @@
+#include "crc32c.h"
+#include <cstring>            // 用于memcpy
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>        // 用于SSE4.2 crc32指令
+#define CRC32C_HAVE_SSE42 1
+#endif
+
+namespace {
+
+// 编译目标不保证支持SSE4.2时才需要查表实现和运行时选择
+#ifndef __SSE4_2__
+const uint32_t POLY = 0x82F63B78;  // CRC32C多项式（反射形式）
+
+// 查表实现使用的256项表（首次使用时生成）
+struct Crc32cTable
+{
+    uint32_t entries[256];
+
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (POLY & (0u - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+// 查表实现：逐字节计算
+uint32_t crc32c_scalar(const void* data, size_t len, uint32_t crc) {
+    static const Crc32cTable table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+#endif
+
+#ifdef CRC32C_HAVE_SSE42
+// SSE4.2实现：按8字节处理，尾部逐字节处理
+// 注：只对本函数启用SSE4.2指令，整个程序无需-msse4.2，在不支持的CPU上不会被调用
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(const void* data, size_t len, uint32_t crc) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    for (; len >= 4; len -= 4, p += 4) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; len > 0; --len, ++p) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return ~crc;
+}
+#endif
+
+#ifndef __SSE4_2__
+typedef uint32_t (*Crc32cFunc)(const void*, size_t, uint32_t);
+
+// 按CPU能力选择实现
+Crc32cFunc select_impl() {
+#ifdef CRC32C_HAVE_SSE42
+    if (__builtin_cpu_supports("sse4.2")) return crc32c_sse42;
+#endif
+    return crc32c_scalar;
+}
+
+// 已选择的实现（首次调用时选择，之后只读）
+Crc32cFunc impl() {
+    static const Crc32cFunc func = select_impl();
+    return func;
+}
+#endif
+
+} // namespace
+
+// 计算CRC32C
+// 说明：编译目标已保证支持SSE4.2时（如-march=native的release构建）直接调用，省去运行时选择
+uint32_t crc32c(const void* data, size_t len, uint32_t crc) {
+#ifdef __SSE4_2__
+    return crc32c_sse42(data, len, crc);
+#else
+    return impl()(data, len, crc);
+#endif
+}
+
+// 当前使用的实现名称
+const char* crc32c_impl() {
+#ifdef __SSE4_2__
+    return "sse4.2 (compile-time)";
+#else
+#ifdef CRC32C_HAVE_SSE42
+    if (impl() == crc32c_sse42) return "sse4.2";
+#endif
+    return "scalar";
+#endif
+}
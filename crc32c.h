@@ -0,0 +1,21 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint32_t
+
+// CRC32C（Castagnoli多项式，iSCSI/ext4等使用的同一校验）
+// 说明：首次调用时按CPU能力选择实现：支持SSE4.2时使用crc32指令（每条指令处理8字节），
+//       否则使用查表实现；两者结果完全一致，客户端和服务端可以运行在不同的机器上。
+//       编译目标已启用SSE4.2（如-march=native）时直接使用crc32指令，不做运行时选择
+// 参数：
+//   data - 数据起始地址（不要求对齐）
+//   len - 数据长度
+//   crc - 初始值（分段计算时传入上一段的结果，首段为0）
+// 返回：CRC32C值
+uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0);
+
+// 当前使用的实现名称（"sse4.2"或"scalar"，用于日志）
+const char* crc32c_impl();
+
+#endif // CRC32C_H
@@ -1,4 +1,5 @@
 #include "echo_client.h"
+#include "load_worker.h"    // 包含事件驱动压测线程
 #include <sys/socket.h>       // 用于socket相关系统调用
 #include <netinet/in.h>       // 用于网络地址结构
 #include <arpa/inet.h>        // 用于IP地址转换
@@ -10,15 +11,11 @@
 #include <cstring>            // 用于内存操作
 #include <sstream>            // 用于字符串流（线程ID处理）
 #include <vector>             // 用于存储线程对象
-
-// 初始化静态原子变量（统计计数器）
-std::atomic<int> EchoClient::total_connections(0);
-std::atomic<int> EchoClient::total_sent(0);
-std::atomic<int> EchoClient::total_received(0);
-std::atomic<int> EchoClient::total_errors(0);
+#include <cstdio>             // 用于输出JSON/CSV结果
 
 // 构造函数：初始化配置
-EchoClient::EchoClient(const ClientConfig& cfg) : config(cfg) {}
+EchoClient::EchoClient(const ClientConfig& cfg, const std::vector<ScenarioPhase>& scenario)
+    : config(cfg), phases(scenario), totals(), report_out(nullptr), csv_header_written(false) {}
 
 // 获取当前线程ID的后3位（用于日志区分线程）
 std::string EchoClient::get_thread_id() {
@@ -30,20 +27,21 @@ std::string EchoClient::get_thread_id() {
 }
 
 // 处理正常连接：建立连接，发送消息并验证回射
-void EchoClient::handle_normal_connection() {
+void EchoClient::handle_normal_connection(ClientStats* stats) {
     std::string thread_id = get_thread_id();  // 获取线程标识
-    log_info("[Thread " + thread_id + "] Starting normal connection");
+    LOG_INFO("[Thread %s] Starting normal connection", thread_id.c_str());
 
     int sockfd = -1;  // 客户端套接字
+    LatencyHistogram local_histogram;  // 本线程的往返延迟（结束时并入总直方图）
     try {
         // 创建套接字（IPv4，TCP）
         sockfd = socket(AF_INET, SOCK_STREAM, 0);
         if (sockfd == -1) {  // 创建失败
-            log_error("[Thread " + thread_id + "] Socket creation failed (errno: " + std::to_string(errno) + ")");
-            total_errors++;  // 统计错误
+            LOG_ERROR("[Thread %s] Socket creation failed (errno: %d)", thread_id.c_str(), errno);
+            stats->add(CLIENT_ERRORS);  // 统计错误
             return;
         }
-        log_info("[Thread " + thread_id + "] Created socket (fd: " + std::to_string(sockfd) + ")");
+        LOG_INFO("[Thread %s] Created socket (fd: %d)", thread_id.c_str(), sockfd);
 
         // 设置套接字为非阻塞模式（避免recv阻塞线程）
         int flags = fcntl(sockfd, F_GETFL, 0);
@@ -56,21 +54,21 @@ void EchoClient::handle_normal_connection() {
         server_addr.sin_port = htons(config.server_port);  // 端口（主机转网络字节序）
         // 转换服务器IP字符串为网络字节序
         if (inet_pton(AF_INET, config.server_ip.c_str(), &server_addr.sin_addr) <= 0) {
-            log_error("[Thread " + thread_id + "] Invalid server IP");
+            LOG_ERROR("[Thread %s] Invalid server IP", thread_id.c_str());
             close(sockfd);
-            total_errors++;
+            stats->add(CLIENT_ERRORS);
             return;
         }
 
         // 连接服务器（非阻塞模式，可能返回EINPROGRESS表示正在连接）
         if (connect(sockfd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1 && errno != EINPROGRESS) {
-            log_error("[Thread " + thread_id + "] Connect failed (errno: " + std::to_string(errno) + ")");
+            LOG_ERROR("[Thread %s] Connect failed (errno: %d)", thread_id.c_str(), errno);
             close(sockfd);
-            total_errors++;
+            stats->add(CLIENT_ERRORS);
             return;
         }
-        total_connections++;  // 统计连接成功数
-        log_info("[Thread " + thread_id + "] Connection established (fd: " + std::to_string(sockfd) + ")");
+        stats->add(CLIENT_CONNECTIONS);  // 统计连接成功数
+        LOG_INFO("[Thread %s] Connection established (fd: %d)", thread_id.c_str(), sockfd);
 
         // 准备发送的数据（指定大小，填充'a'）
         std::string send_data(config.message_size, 'a');
@@ -89,29 +87,29 @@ void EchoClient::handle_normal_connection() {
             // 校验魔数转换是否正确（避免逻辑错误）
             uint32_t check_magic = ntohl(header.magic);
             if (check_magic != MAGIC_NUMBER) {
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " magic invalid");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d magic invalid", thread_id.c_str(), i);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;  // 跳转到清理部分
             }
-            log_info("[Thread " + thread_id + "] Sending msg_id=" + std::to_string(i) + 
-                     " (magic: 0x" + std::to_string(MAGIC_NUMBER) + ")");
+            LOG_DEBUG("[Thread %s] Sending msg_id=%d (magic: 0x%08x)", thread_id.c_str(), i, MAGIC_NUMBER);
+            auto send_start = std::chrono::steady_clock::now();  // 往返延迟的起点
 
             // 发送报文头
             ssize_t send_len = send(sockfd, &header, sizeof(MessageHeader), 0);
             if (send_len != sizeof(MessageHeader)) {  // 发送失败
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " header send failed");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d header send failed", thread_id.c_str(), i);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 发送数据部分
             send_len = send(sockfd, send_data.c_str(), send_data.size(), 0);
             if (send_len != (ssize_t)send_data.size()) {  // 发送失败
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " data send failed");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d data send failed", thread_id.c_str(), i);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
-            total_sent++;  // 统计发送成功数
+            stats->add(CLIENT_SENT);  // 统计发送成功数
 
             // 等待服务器回射消息
             MessageHeader recv_header;  // 接收的报文头
@@ -127,8 +125,8 @@ void EchoClient::handle_normal_connection() {
                 // 检查是否超时
                 auto now = std::chrono::high_resolution_clock::now();
                 if (now - msg_start > msg_timeout) {
-                    log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " header recv timeout (5s)");
-                    total_errors++;
+                    LOG_ERROR("[Thread %s] Msg %d header recv timeout (5s)", thread_id.c_str(), i);
+                    stats->add(CLIENT_ERRORS);
                     goto msg_timeout_exit;
                 }
 
@@ -137,52 +135,52 @@ void EchoClient::handle_normal_connection() {
                 if (bytes_read > 0) {
                     break;  // 读取成功，退出循环
                 } else if (bytes_read == 0) {  // 服务器断开连接
-                    log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " server disconnected");
-                    total_errors++;
+                    LOG_ERROR("[Thread %s] Msg %d server disconnected", thread_id.c_str(), i);
+                    stats->add(CLIENT_ERRORS);
                     goto msg_timeout_exit;
                 } else {  // 读取失败
                     // 仅处理非阻塞导致的暂时无数据（EAGAIN/EWOULDBLOCK）
                     if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                        log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " recv error (errno: " + std::to_string(errno) + ")");
-                        total_errors++;
+                        LOG_ERROR("[Thread %s] Msg %d recv error (errno: %d)", thread_id.c_str(), i, errno);
+                        stats->add(CLIENT_ERRORS);
                         goto msg_timeout_exit;
                     }
                 }
 
                 // 重试前延迟并记录
-                log_info("[Thread " + thread_id + "] Msg " + std::to_string(i) + " recv retry " + std::to_string(retry+1) + "/" + std::to_string(max_retry));
+                LOG_DEBUG("[Thread %s] Msg %d recv retry %d/%d", thread_id.c_str(), i, retry+1, max_retry);
                 std::this_thread::sleep_for(std::chrono::milliseconds(retry_delay_ms));
                 retry++;
             }
 
             // 检查报文头读取结果（重试耗尽或长度错误）
             if (bytes_read == -1 || bytes_read != sizeof(MessageHeader)) {
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " header recv failed (read: " + std::to_string(bytes_read) + ")");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d header recv failed (read: %zd)", thread_id.c_str(), i, bytes_read);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 校验回射的魔数
             uint32_t recv_magic = ntohl(recv_header.magic);
             if (recv_magic != MAGIC_NUMBER) {
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " invalid recv magic (0x" + std::to_string(recv_magic) + ")");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d invalid recv magic (0x%08x)", thread_id.c_str(), i, recv_magic);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 校验消息ID（确保回射的是当前消息）
             uint32_t recv_msg_id = ntohl(recv_header.msg_id);
             if (recv_msg_id != (uint32_t)i) {
-                log_error("[Thread " + thread_id + "] Msg ID mismatch (expected: " + std::to_string(i) + ")");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg ID mismatch (expected: %d)", thread_id.c_str(), i);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 校验数据长度（确保回射的数据大小正确）
             uint32_t recv_data_len = ntohl(recv_header.data_len);
             if (recv_data_len != (uint32_t)config.message_size) {
-                log_error("[Thread " + thread_id + "] Data len mismatch (expected: " + std::to_string(config.message_size) + ")");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Data len mismatch (expected: %d)", thread_id.c_str(), config.message_size);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
@@ -193,8 +191,8 @@ void EchoClient::handle_normal_connection() {
                 // 检查超时
                 auto now = std::chrono::high_resolution_clock::now();
                 if (now - msg_start > msg_timeout) {
-                    log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " data recv timeout (5s)");
-                    total_errors++;
+                    LOG_ERROR("[Thread %s] Msg %d data recv timeout (5s)", thread_id.c_str(), i);
+                    stats->add(CLIENT_ERRORS);
                     goto msg_timeout_exit;
                 }
 
@@ -203,13 +201,13 @@ void EchoClient::handle_normal_connection() {
                 if (bytes_read > 0) {
                     break;  // 读取成功
                 } else if (bytes_read == 0) {  // 服务器断开
-                    log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " server disconnected");
-                    total_errors++;
+                    LOG_ERROR("[Thread %s] Msg %d server disconnected", thread_id.c_str(), i);
+                    stats->add(CLIENT_ERRORS);
                     goto msg_timeout_exit;
                 } else {  // 读取失败
                     if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                        log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " data recv error (errno: " + std::to_string(errno) + ")");
-                        total_errors++;
+                        LOG_ERROR("[Thread %s] Msg %d data recv error (errno: %d)", thread_id.c_str(), i, errno);
+                        stats->add(CLIENT_ERRORS);
                         goto msg_timeout_exit;
                     }
                 }
@@ -220,21 +218,24 @@ void EchoClient::handle_normal_connection() {
 
             // 检查数据读取结果
             if (bytes_read == -1 || bytes_read != (ssize_t)recv_data_len) {
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " data recv failed (read: " + std::to_string(bytes_read) + ")");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d data recv failed (read: %zd)", thread_id.c_str(), i, bytes_read);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 校验数据内容（确保回射的数据与发送的一致）
             if (memcmp(recv_buffer.get(), send_data.c_str(), bytes_read) != 0) {
-                log_error("[Thread " + thread_id + "] Msg " + std::to_string(i) + " data mismatch");
-                total_errors++;
+                LOG_ERROR("[Thread %s] Msg %d data mismatch", thread_id.c_str(), i);
+                stats->add(CLIENT_ERRORS);
                 goto msg_timeout_exit;
             }
 
             // 成功接收并验证回射
-            total_received++;
-            log_info("[Thread " + thread_id + "] Received msg_id=" + std::to_string(i));
+            stats->add(CLIENT_RECEIVED);
+            stats->add(CLIENT_BYTES, sizeof(MessageHeader) + recv_data_len);
+            local_histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - send_start).count()));
+            LOG_DEBUG("[Thread %s] Received msg_id=%d", thread_id.c_str(), i);
 
             // 发送下一条消息前短暂延迟（避免服务器压力过大）
             if (i < config.messages_per_conn - 1) {
@@ -244,13 +245,15 @@ void EchoClient::handle_normal_connection() {
 
         // 所有消息处理完毕，关闭连接
         close(sockfd);
-        log_info("[Thread " + thread_id + "] Connection closed normally");
+        LOG_INFO("[Thread %s] Connection closed normally", thread_id.c_str());
+        std::lock_guard<std::mutex> lock(histogram_mutex);
+        histogram.merge(local_histogram);
         return;
 
     // 异常处理（若有异常抛出）
     } catch (const std::exception& e) {
-        log_error("[Thread " + thread_id + "] Exception: " + std::string(e.what()));
-        total_errors++;
+        LOG_ERROR("[Thread %s] Exception: %s", thread_id.c_str(), e.what());
+        stats->add(CLIENT_ERRORS);
     }
 
     // 清理标签（发生错误时跳转至此）
@@ -258,46 +261,297 @@ msg_timeout_exit:
     if (sockfd != -1) {
         close(sockfd);  // 关闭套接字
     }
-    log_info("[Thread " + thread_id + "] Connection closed due to error");
+    LOG_INFO("[Thread %s] Connection closed due to error", thread_id.c_str());
+    std::lock_guard<std::mutex> lock(histogram_mutex);
+    histogram.merge(local_histogram);
+}
+
+// 输出当前配置
+void EchoClient::log_config() {
+    if (!config.shm_path.empty()) {
+        LOG_INFO("  Server: shared memory via %s", config.shm_path.c_str());
+    } else if (!config.unix_path.empty()) {
+        LOG_INFO("  Server: unix socket %s", config.unix_path.c_str());
+    } else {
+        LOG_INFO("  Server IP: %s", config.server_ip.c_str());
+        LOG_INFO("  Server port: %d", config.server_port);
+    }
+    LOG_INFO("  Connections: %d", config.connections);
+    LOG_INFO("  Messages per connection: %d", config.messages_per_conn);
+    if (config.size_mix.empty()) {
+        LOG_INFO("  Message size: %d bytes", config.message_size);
+    } else {
+        std::string mix;
+        for (const MessageSizeWeight& entry : config.size_mix) {
+            if (!mix.empty()) mix += ",";
+            mix += std::to_string(entry.size) + ":" + std::to_string(entry.weight);
+        }
+        LOG_INFO("  Message sizes (bytes:weight): %s", mix.c_str());
+    }
 }
 
 // 运行客户端：根据配置创建线程处理连接
 void EchoClient::run() {
-    log_info("Starting client with config:");
-    log_info("  Server IP: " + config.server_ip);
-    log_info("  Server port: " + std::to_string(config.server_port));
-    log_info("  Connections: " + std::to_string(config.connections));
-    log_info("  Messages per connection: " + std::to_string(config.messages_per_conn));
-    log_info("  Message size: " + std::to_string(config.message_size) + " bytes");
-
-    // 存储线程对象的容器
-    std::vector<std::thread> threads;
-    threads.reserve(config.connections);  // 预分配空间
-
-    // 根据配置的连接数创建线程
-    for (int i = 0; i < config.connections; ++i) 
-    {
-        // 正常模式：每个线程处理一个连接
-        threads.emplace_back(&EchoClient::handle_normal_connection, this);
+    // JSON/CSV结果输出到指定文件或stdout
+    if (config.report_format != ReportFormat::TEXT) {
+        report_out = stdout;
+        if (!config.report_file.empty()) {
+            report_out = fopen(config.report_file.c_str(), "w");
+            if (report_out == nullptr) {
+                LOG_ERROR("Cannot open report file %s (errno: %d), using stdout", config.report_file.c_str(), errno);
+                report_out = stdout;
+            }
+        }
     }
 
-    // 等待所有线程完成
-    for (auto& t : threads) {
-        if (t.joinable()) {
-            t.join();
+    start_time = std::chrono::steady_clock::now();
+    phase_start = start_time;
+    if (!phases.empty()) {
+        run_scenario();
+        if (report_out != nullptr && report_out != stdout) fclose(report_out);
+        report_out = nullptr;
+        return;
+    }
+
+    LOG_INFO("Starting client with config:");
+    log_config();
+    if (config.threads > 0) {
+        run_event_mode();
+    } else {
+        // 存储线程对象的容器
+        std::vector<std::thread> threads;
+        threads.reserve(config.connections);  // 预分配空间
+        // 每个线程一个统计块（避免各线程争用同一缓存行）
+        std::vector<std::unique_ptr<ClientStats>> thread_stats;
+
+        // 根据配置的连接数创建线程
+        for (int i = 0; i < config.connections; ++i) 
+        {
+            // 正常模式：每个线程处理一个连接
+            thread_stats.emplace_back(new ClientStats());
+            threads.emplace_back(&EchoClient::handle_normal_connection, this, thread_stats.back().get());
         }
+
+        // 等待所有线程完成
+        for (auto& t : threads) {
+            if (t.joinable()) {
+                t.join();
+            }
+        }
+        for (auto& stats : thread_stats) stats->accumulate(totals);
     }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
 
     // 打印统计信息
     print_stats();
+    report("total", histogram, totals, elapsed);
+
+    if (report_out != nullptr && report_out != stdout) fclose(report_out);
+    report_out = nullptr;
 }
 
 // 打印统计信息
 void EchoClient::print_stats() {
-    log_info("\n===== Client Statistics =====");
-    log_info("Total connections: " + std::to_string(total_connections));
-    log_info("Total messages sent: " + std::to_string(total_sent));
-    log_info("Total messages received (verified): " + std::to_string(total_received));
-    log_info("Total errors: " + std::to_string(total_errors));
-    log_info("=============================");
-}
\ No newline at end of file
+    LOG_INFO("\n===== Client Statistics =====");
+    LOG_INFO("Total connections: %llu", static_cast<unsigned long long>(totals[CLIENT_CONNECTIONS]));
+    LOG_INFO("Total messages sent: %llu", static_cast<unsigned long long>(totals[CLIENT_SENT]));
+    LOG_INFO("Total messages received (verified): %llu", static_cast<unsigned long long>(totals[CLIENT_RECEIVED]));
+    LOG_INFO("Total errors: %llu", static_cast<unsigned long long>(totals[CLIENT_ERRORS]));
+    if (totals[CLIENT_RECONNECTS] > 0) {
+        LOG_INFO("Total churn reconnects: %llu", static_cast<unsigned long long>(totals[CLIENT_RECONNECTS]));
+    }
+    LOG_INFO("=============================");
+}
+
+// 事件驱动模式：连接按轮转方式分给各线程，总速率在线程间平均分配
+void EchoClient::run_event_mode() {
+    if (config.threads > config.connections) config.threads = config.connections;
+    if (config.rate > 0) {
+        LOG_INFO("  Mode: open-loop, %d threads, %.0f msgs/s (%s arrivals)", config.threads, config.rate,
+                 config.arrival == ArrivalProcess::POISSON ? "poisson" : "constant");
+        if (config.ramp_up > 0) {
+            LOG_INFO("  Ramp-up: %.1f s", config.ramp_up);
+        }
+    } else {
+        LOG_INFO("  Mode: closed-loop, %d threads", config.threads);
+        if (config.ramp_up > 0) {
+            LOG_WARN("  Ramp-up only applies to open-loop runs (--rate), ignored");
+        }
+    }
+    if (config.duration > 0) {
+        LOG_INFO("  Duration: %d s", config.duration);
+    }
+    if (config.window > 0 || config.coalesce) {
+        std::string window = config.window > 0 ? std::to_string(config.window) : (config.rate > 0 ? "unlimited" : "1");
+        LOG_INFO("  Window: %s per connection%s", window.c_str(), config.coalesce ? ", coalesced sends" : "");
+    }
+    if (config.churn_rate > 0) {
+        LOG_INFO("  Churn: %.1f reconnects/s", config.churn_rate);
+    }
+    if (config.idle_connections > 0) {
+        LOG_INFO("  Idle connections: %d", config.idle_connections);
+    }
+    if (config.slow_readers > 0) {
+        LOG_INFO("  Slow readers: %d (pause %d ms after each read)", config.slow_readers, config.read_pause_ms);
+    }
+
+    // 发送连接、空闲连接和慢读连接分别在各线程间平均分配
+    auto share = [this](int total, int i) { return total / config.threads + (i < total % config.threads ? 1 : 0); };
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (int i = 0; i < config.threads; ++i) {
+        workers.emplace_back(new LoadWorker(i, config, share(config.connections, i), share(config.idle_connections, i),
+                                            share(config.slow_readers, i)));
+    }
+    for (auto& w : workers) w->start();
+
+    // 周期报告：按间隔汇总各线程的计数（与上次报告相减得到增量）并取走已发布的延迟
+    // （各线程每100毫秒发布一次延迟）
+    if (config.report_interval > 0) {
+        auto interval = std::chrono::seconds(config.report_interval);
+        auto next_report = phase_start + interval;
+        LatencyHistogram latency;
+        ClientStats::Snapshot last = ClientStats::Snapshot();
+        while (true) {
+            bool any_running = false;
+            for (auto& w : workers) any_running = any_running || w->is_running();
+            if (!any_running) break;
+            if (std::chrono::steady_clock::now() < next_report) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            latency.reset();
+            ClientStats::Snapshot now = ClientStats::Snapshot();
+            for (auto& w : workers) {
+                w->collect_interval(latency);
+                w->counters().accumulate(now);
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            ClientStats::Snapshot delta;
+            for (size_t i = 0; i < delta.size(); ++i) delta[i] = now[i] - last[i];
+            report("interval", latency, delta, elapsed, static_cast<double>(config.report_interval));
+            last = now;
+            next_report += interval;
+        }
+    }
+    for (auto& w : workers) w->join();
+
+    // 汇总各线程的统计
+    for (auto& w : workers) {
+        w->counters().accumulate(totals);
+        histogram.merge(w->latency_histogram());
+    }
+}
+
+// 依次运行场景的各个阶段
+// 说明：每个阶段使用独立的压测线程和连接（上一阶段的连接全部关闭后才开始下一阶段），
+//       周期报告的时间从场景开始算起；最后的合并报告汇总所有阶段的计数和延迟，
+//       文本格式另外输出各阶段的对比表
+void EchoClient::run_scenario() {
+    struct PhaseResult
+    {
+        std::string name;
+        ClientStats::Snapshot counts;
+        LatencyHistogram latency;
+        double elapsed;
+    };
+    ClientConfig base = config;
+    std::vector<PhaseResult> results;
+    ClientStats::Snapshot combined = ClientStats::Snapshot();
+    LatencyHistogram combined_latency;
+    LOG_INFO("Running scenario with %zu phases", phases.size());
+
+    for (const ScenarioPhase& phase : phases) {
+        config = phase.config;
+        phase_name = phase.name;
+        LOG_INFO("===== Phase %s =====", phase.name.c_str());
+        log_config();
+        totals = ClientStats::Snapshot();
+        histogram.reset();
+        phase_start = std::chrono::steady_clock::now();
+        run_event_mode();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - phase_start).count();
+        report("phase", histogram, totals, elapsed);
+
+        for (size_t i = 0; i < combined.size(); ++i) combined[i] += totals[i];
+        combined_latency.merge(histogram);
+        results.push_back(PhaseResult{phase.name, totals, histogram, elapsed});
+    }
+
+    config = base;
+    phase_name.clear();
+    totals = combined;
+    histogram.reset();
+    histogram.merge(combined_latency);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    print_stats();
+    if (config.report_format == ReportFormat::TEXT) {
+        LOG_INFO("===== Scenario Summary =====");
+        LOG_INFO("%-16s %9s %10s %9s %10s %10s %10s %8s", "phase", "elapsed_s", "msgs/s", "MB/s", "p50_us", "p99_us",
+                 "p99.9_us", "errors");
+        for (const PhaseResult& r : results) {
+            double period = r.elapsed > 0 ? r.elapsed : 1;
+            LOG_INFO("%-16s %9.2f %10.0f %9.2f %10.1f %10.1f %10.1f %8llu", r.name.c_str(), r.elapsed,
+                     r.counts[CLIENT_RECEIVED] / period, r.counts[CLIENT_BYTES] / period / 1e6,
+                     r.latency.value_at_percentile(50) / 1000.0, r.latency.value_at_percentile(99) / 1000.0,
+                     r.latency.value_at_percentile(99.9) / 1000.0,
+                     static_cast<unsigned long long>(r.counts[CLIENT_ERRORS]));
+        }
+    }
+    report("total", histogram, totals, elapsed);
+}
+
+// 输出一条统计报告
+// 说明：开环模式下延迟从计划发送时刻算起，包含客户端侧排队（服务端跟不上时延迟随之增长）；
+//       MB/s按校验通过的回射字节数（报文头+数据）计算；运行场景时JSON带phase字段，
+//       CSV的phase列为当前阶段的名称（合并报告和非场景运行时为空）
+void EchoClient::report(const char* type, const LatencyHistogram& latency, const ClientStats::Snapshot& counts,
+                        double elapsed_sec, double period_sec) {
+    if (period_sec <= 0) period_sec = elapsed_sec;
+    double msgs_per_sec = period_sec > 0 ? counts[CLIENT_RECEIVED] / period_sec : 0;
+    double mb_per_sec = period_sec > 0 ? counts[CLIENT_BYTES] / period_sec / 1e6 : 0;
+    auto us = [&latency](double p) { return latency.value_at_percentile(p) / 1000.0; };
+    unsigned long long s = counts[CLIENT_SENT], r = counts[CLIENT_RECEIVED], e = counts[CLIENT_ERRORS];
+
+    switch (config.report_format) {
+    case ReportFormat::TEXT:
+        if (strcmp(type, "interval") == 0) {
+            LOG_INFO("[%7.1fs] sent=%llu recv=%llu err=%llu %.0f msgs/s %.2f MB/s "
+                     "p50=%.1f p99=%.1f p99.9=%.1f max=%.1f us",
+                     elapsed_sec, s, r, e, msgs_per_sec, mb_per_sec, us(50), us(99), us(99.9), latency.max() / 1000.0);
+            return;
+        }
+        if (strcmp(type, "phase") == 0) {
+            LOG_INFO("Phase %s: sent=%llu recv=%llu err=%llu", phase_name.c_str(), s, r, e);
+        }
+        if (latency.count() == 0) {
+            LOG_INFO("No latency samples");
+        } else {
+            LOG_INFO("Throughput: %.0f msgs/s, %.2f MB/s over %.2f s", msgs_per_sec, mb_per_sec, elapsed_sec);
+            LOG_INFO("Latency (us): min=%.1f mean=%.1f p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f p99.99=%.1f max=%.1f",
+                     latency.min() / 1000.0, latency.mean() / 1000.0, us(50), us(90), us(99), us(99.9), us(99.99),
+                     latency.max() / 1000.0);
+        }
+        return;
+    case ReportFormat::JSON: {
+        std::string phase_field = phase_name.empty() ? "" : ",\"phase\":\"" + phase_name + "\"";
+        fprintf(report_out,
+                "{\"type\":\"%s\"%s,\"elapsed_s\":%.3f,\"sent\":%llu,\"received\":%llu,\"errors\":%llu,"
+                "\"msgs_per_s\":%.1f,\"mb_per_s\":%.3f,\"latency_us\":{\"min\":%.1f,\"mean\":%.1f,"
+                "\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p99_9\":%.1f,\"p99_99\":%.1f,\"max\":%.1f}}\n",
+                type, phase_field.c_str(), elapsed_sec, s, r, e, msgs_per_sec, mb_per_sec, latency.min() / 1000.0,
+                latency.mean() / 1000.0, us(50), us(90), us(99), us(99.9), us(99.99), latency.max() / 1000.0);
+        break;
+    }
+    case ReportFormat::CSV:
+        if (!csv_header_written) {
+            fprintf(report_out, "type,elapsed_s,sent,received,errors,msgs_per_s,mb_per_s,"
+                                "min_us,mean_us,p50_us,p90_us,p99_us,p999_us,p9999_us,max_us,phase\n");
+            csv_header_written = true;
+        }
+        fprintf(report_out, "%s,%.3f,%llu,%llu,%llu,%.1f,%.3f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%s\n",
+                type, elapsed_sec, s, r, e, msgs_per_sec, mb_per_sec, latency.min() / 1000.0, latency.mean() / 1000.0,
+                us(50), us(90), us(99), us(99.9), us(99.99), latency.max() / 1000.0, phase_name.c_str());
+        break;
+    }
+    fflush(report_out);
+}
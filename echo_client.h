@@ -2,37 +2,78 @@
 #define ECHO_CLIENT_H
 
 #include "common.h"       // 包含公共常量、配置结构体和日志函数
+#include "latency_histogram.h"  // 包含延迟直方图
+#include "client_stats.h"      // 包含客户端统计计数块
 #include <thread>         // 用于多线程
-#include <atomic>         // 用于原子变量（多线程安全的计数器）
+#include <mutex>          // 用于合并各线程的延迟直方图
+#include <chrono>         // 用于运行计时
+#include <cstdio>         // 用于JSON/CSV结果输出
+#include <string>         // 用于阶段名称
+#include <vector>         // 用于场景的阶段列表
+
+// 场景中的一个阶段：名称和该阶段的完整配置（命令行配置叠加场景文件中的设置）
+struct ScenarioPhase
+{
+    std::string name;     // 阶段名称（报告中的phase字段）
+    ClientConfig config;  // 该阶段的配置
+};
 
 // 回射客户端类：实现多线程客户端，向服务器发送消息并验证回射
 class EchoClient
 {
 private:
-    ClientConfig config;  // 客户端配置（从命令行参数解析）
+    ClientConfig config;  // 客户端配置（从命令行参数解析；运行场景时为当前阶段的配置）
+    std::vector<ScenarioPhase> phases;          // 场景的各个阶段，为空表示只按config运行一次
+    std::string phase_name;                     // 当前阶段的名称（报告中的phase字段，非场景运行时为空）
+
+    // 汇总后的计数（各线程使用独立的统计块，结束时累加到这里）
+    ClientStats::Snapshot totals;
 
-    // 静态原子变量：用于多线程统计（原子操作确保线程安全）
-    static std::atomic<int> total_connections;  // 总连接数
-    static std::atomic<int> total_sent;         // 总发送消息数
-    static std::atomic<int> total_received;     // 总接收（验证成功）消息数
-    static std::atomic<int> total_errors;       // 总错误数
+    LatencyHistogram histogram;                 // 所有线程合并后的往返延迟（纳秒）
+    std::mutex histogram_mutex;                 // 保护histogram（同步模式下各线程结束时并入）
+    std::chrono::steady_clock::time_point start_time;  // 开始运行的时间
+    std::chrono::steady_clock::time_point phase_start; // 当前阶段开始的时间（非场景运行时与start_time相同）
+    FILE* report_out;                           // JSON/CSV结果的输出流
+    bool csv_header_written;                    // CSV表头是否已输出
 
     // 获取当前线程ID的后3位（用于日志区分线程）
     // 返回：线程ID的字符串表示（后3位）
     std::string get_thread_id();
 
     // 处理正常连接：同步发送消息（每条消息等待回射后再发下一条）
-    void handle_normal_connection();
+    // 参数：stats - 本线程的统计块
+    void handle_normal_connection(ClientStats* stats);
+
+    // 事件驱动模式：少量epoll线程驱动全部连接（开环按速率发送或闭环）
+    void run_event_mode();
+
+    // 依次运行场景的各个阶段，每个阶段结束时输出阶段报告，最后输出所有阶段合并的报告
+    void run_scenario();
+
+    // 输出当前配置（服务端地址、连接数、消息数和消息大小）
+    void log_config();
+
+    // 输出一条统计报告（吞吐和延迟分位数，格式由配置决定）
+    // 参数：
+    //   type - 报告类型（"interval"周期报告、"phase"阶段报告或"total"最终报告）
+    //   latency - 期间的延迟直方图
+    //   counts - 期间的计数（发送数、校验通过的回射数、错误数和回射字节数）
+    //   elapsed_sec - 自开始运行的时间（秒；阶段报告为阶段的时长）
+    //   period_sec - 期间长度（秒，用于计算速率），0表示与elapsed_sec相同
+    void report(const char* type, const LatencyHistogram& latency, const ClientStats::Snapshot& counts,
+                double elapsed_sec, double period_sec = 0);
 
 public:
     // 构造函数：初始化客户端配置
-    // 参数：cfg - 客户端配置
-    EchoClient(const ClientConfig& cfg);
+    // 参数：
+    //   cfg - 客户端配置（运行场景时决定报告格式和输出文件）
+    //   scenario - 场景的各个阶段，为空表示只按cfg运行一次
+    EchoClient(const ClientConfig& cfg, const std::vector<ScenarioPhase>& scenario = std::vector<ScenarioPhase>());
 
     // 析构函数：默认（无需额外资源释放）
     ~EchoClient() = default;
 
-    // 运行客户端：根据配置创建线程并执行
+    // 运行客户端：根据配置选择每连接一个线程的同步模式或事件驱动模式，或依次运行场景的各个阶段
     void run();
 
     // 打印统计信息（总连接、发送、接收、错误数）
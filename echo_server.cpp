@@ -1,380 +1,650 @@
 #include "echo_server.h"
+#include "socket_utils.h"     // 用于监听套接字创建和非阻塞设置
+#include "worker.h"           // 用于epoll工作线程
+#include "uring_worker.h"     // 用于io_uring工作线程
+#include "shm_worker.h"       // 用于共享内存工作线程
+#include "handoff.h"          // 用于热重启时交接监听套接字
+#include "crc32c.h"           // 用于输出CRC32C实现
+#include "protocol.h"         // 用于输出本次构建的协议特性
 #include <sys/socket.h>       // 用于socket相关系统调用
+#include <sys/signalfd.h>     // 用于signalfd（在事件循环中处理关闭信号）
+#include <signal.h>           // 用于信号屏蔽字
+#include <pthread.h>          // 用于pthread_sigmask
 #include <netinet/in.h>       // 用于网络地址结构（sockaddr_in）
 #include <arpa/inet.h>        // 用于IP地址转换（inet_pton等）
 #include <unistd.h>           // 用于close等系统调用
-#include <fcntl.h>            // 用于fcntl（设置非阻塞）
 #include <errno.h>            // 用于错误码（errno）
-#include <thread>             // 用于线程相关操作
-#include <chrono>             // 用于时间相关操作（超时控制）
-#include <cstring>            // 用于内存操作（memset等）
+#include <thread>             // 用于获取CPU核数（hardware_concurrency）
+#include <algorithm>          // 用于std::max
+#include <cstring>            // 用于内存操作（memset等）和strcmp
+#include <cstdio>             // 用于写追踪文件（fopen/fwrite）
+
+namespace {
+
+// 由接收线程经signalfd处理的信号集合：SIGINT/SIGTERM触发优雅关闭，SIGUSR1导出追踪记录
+void server_signals(sigset_t& mask) {
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+}
+
+// 从交接得到的监听套接字中取出绑定到path的Unix域监听套接字
+// 参数：
+//   inherited - 交接得到的监听套接字（取出的fd从中删除）
+//   path - 本进程配置的路径（为空时不取）
+// 返回：fd，没有时返回-1
+int take_unix_listener(std::vector<int>& inherited, const std::string& path) {
+    if (path.empty()) return -1;
+    for (size_t i = 0; i < inherited.size(); ++i) {
+        std::string bound;
+        if (unix_socket_path(inherited[i], bound) && bound == path) {
+            int fd = inherited[i];
+            inherited.erase(inherited.begin() + i);
+            return fd;
+        }
+    }
+    return -1;
+}
+
+// 关闭交接得到、本进程没有配置的Unix域监听套接字，剩下的都是TCP监听套接字
+// 参数：inherited - 交接得到的监听套接字
+void drop_unix_listeners(std::vector<int>& inherited) {
+    for (size_t i = 0; i < inherited.size();) {
+        std::string bound;
+        if (unix_socket_path(inherited[i], bound)) {
+            LOG_ERROR("Closing inherited listening socket on %s (not configured)", bound.c_str());
+            close(inherited[i]);
+            inherited.erase(inherited.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+// 轮询策略的名称（用于启动日志）
+const char* poll_mode_name(PollMode mode) {
+    switch (mode) {
+    case PollMode::SPIN:
+        return "spin";
+    case PollMode::BUSY:
+        return "busy";
+    default:
+        return "block";
+    }
+}
+
+} // namespace
 
 // 构造函数：初始化服务器状态
-// 参数：port - 监听端口
-EchoServer::EchoServer(int port) 
-    : server_fd(-1), epoll_fd(-1), port(port), running(false) {}
+// 参数：cfg - 服务端配置
+EchoServer::EchoServer(const ServerConfig& cfg)
+    : server_fd(-1), epoll_fd(-1), signal_fd(-1), handoff_fd(-1), unix_fd(-1), shm_fd(-1), config(cfg), running(false),
+      admission(cfg), next_worker(0) {}
 
 // 析构函数：停止服务器并释放资源
 EchoServer::~EchoServer() {
     running = false;  // 停止事件循环
-    // 关闭监听套接字和epoll句柄（若已初始化）
+    admin.reset();  // 管理线程读取工作线程的指标，先于工作线程停止
+    // 先停止并销毁工作线程（由其关闭名下的客户端连接）
+    for (auto& worker : workers) {
+        worker->stop();
+    }
+    workers.clear();
+    shm_worker.reset();
+    // 关闭监听套接字、交接套接字和epoll句柄（若已初始化）
     if (server_fd != -1) close(server_fd);
+    if (unix_fd != -1) close(unix_fd);
+    if (shm_fd != -1) close(shm_fd);
+    if (handoff_fd != -1) close(handoff_fd);
+    if (signal_fd != -1) close(signal_fd);
     if (epoll_fd != -1) close(epoll_fd);
-    // 清理客户端缓冲区（加锁保证线程安全）
-    std::lock_guard<std::mutex> lock(buffer_mutex);
-    client_buffers.clear();
-    // 清理客户端fd对应的互斥锁（加锁保证线程安全）
-    std::lock_guard<std::mutex> fd_lock(fd_mutex_map_mutex);
-    fd_mutexes.clear();
 }
 
-// 设置文件描述符为非阻塞模式
-// 作用：避免IO操作（read/write）阻塞进程，提高并发处理能力
-// 参数：fd - 目标文件描述符
-// 返回：0成功，-1失败
-int EchoServer::set_nonblocking(int fd) {
-    // 获取当前文件描述符的标志
-    int flags = fcntl(fd, F_GETFL, 0);
-    if (flags == -1) return -1;  // 获取失败
-    // 设置非阻塞标志（O_NONBLOCK）
-    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
-}
+// 创建并启动工作线程池
+// 作用：工作线程数为0时按CPU核数自动设置，每个工作线程拥有独立的epoll实例；
+//       多reactor模式下还会为每个线程创建各自的监听套接字（热重启时依次沿用交接得到的监听套接字）
+// 参数：inherited - 从旧进程接过的监听套接字
+// 返回：true成功，false失败
+bool EchoServer::start_workers(const std::vector<int>& inherited) {
+    int count = config.worker_threads;
+    if (count <= 0) {
+        count = static_cast<int>(std::thread::hardware_concurrency());
+        if (count <= 0) count = 1;  // 无法获取核数时退化为单线程
+    }
 
-// 关闭客户端连接并清理资源
-// 作用：释放客户端相关的文件描述符、缓冲区和互斥锁
-// 参数：client_fd - 客户端文件描述符
-void EchoServer::close_client(int client_fd) {
-    log_info("Closed connection for fd: " + std::to_string(client_fd));
-    close(client_fd);  // 关闭客户端套接字
-    // 清理缓冲区（加锁保证线程安全）
-    std::lock_guard<std::mutex> lock(buffer_mutex);
-    client_buffers.erase(client_fd);
-    // 清理该fd对应的互斥锁（加锁保证线程安全）
-    std::lock_guard<std::mutex> fd_lock(fd_mutex_map_mutex);
-    fd_mutexes.erase(client_fd);
-}
+    // 待回射字节数上限按工作线程平分：各线程独立计数，热路径上没有跨线程的原子操作
+    ServerConfig worker_config = config;
+    if (config.max_inflight_bytes > 0) {
+        worker_config.max_inflight_bytes = std::max(config.max_inflight_bytes / count, 1ll);
+    }
 
-// 获取客户端fd对应的互斥锁（不存在则创建）
-// 作用：确保同一客户端的IO操作串行化，避免多线程同时读写导致数据混乱
-// 参数：client_fd - 客户端文件描述符
-// 返回：该fd对应的互斥锁引用
-std::mutex& EchoServer::get_fd_mutex(int client_fd) {
-    std::lock_guard<std::mutex> lock(fd_mutex_map_mutex);  // 保护fd_mutexes的访问
-    // 若不存在则默认构造一个新的mutex，返回引用
-    return fd_mutexes[client_fd];
-}
+    if (config.numa && !topology.load()) {
+        LOG_WARN("NUMA topology unavailable, treating all CPUs as node 0");
+    }
 
-// 处理客户端数据：读取完整消息、校验、回射
-// 参数：client_fd - 客户端文件描述符
-void EchoServer::handle_client_data(int client_fd) {
-    // 加锁：确保同一客户端的操作串行执行（避免数据竞争）
-    std::lock_guard<std::mutex> fd_lock(get_fd_mutex(client_fd));
-
-    // 获取该客户端的缓冲区（智能指针管理，自动释放）
-    std::unique_ptr<char[]> buffer;
-    {
-        std::lock_guard<std::mutex> lock(buffer_mutex);  // 保护client_buffers
-        auto it = client_buffers.find(client_fd);
-        if (it == client_buffers.end()) {  // 缓冲区不存在（异常情况）
-            log_error("Client buffer not found (fd: " + std::to_string(client_fd) + ")");
-            close_client(client_fd);
-            return;
+    workers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // 多reactor模式：每个线程拥有独立的SO_REUSEPORT监听套接字
+        int listen_fd = -1;
+        if (config.reuseport) {
+            listen_fd = i < static_cast<int>(inherited.size())
+                ? inherited[i]
+                : create_listen_socket(config.port, true, config.listen_backlog, config.defer_accept);
+            if (listen_fd == -1) {
+                return false;
+            }
+            listen_fds.push_back(listen_fd);
         }
-        buffer = std::move(it->second);  // 转移缓冲区所有权
-        client_buffers.erase(it);        // 临时移除，处理完后归还
-    }
-
-    // 清空缓冲区（避免残留数据影响）
-    memset(buffer.get(), 0, BUFFER_SIZE);
-
-    // 读取完整报文头（固定12字节），循环读取直到读满（防止数据分片）
-    MessageHeader header;
-    size_t header_read = 0;  // 已读取的报文头字节数
-    const size_t header_total = sizeof(MessageHeader);  // 报文头总字节数（12）
-    auto header_start = std::chrono::high_resolution_clock::now();  // 开始读取时间
-    const std::chrono::seconds header_timeout(3);  // 报文头读取超时时间（3秒）
-
-    while (header_read < header_total) {
-        size_t remaining = header_total - header_read;  // 剩余未读字节数
-        // 读取剩余部分到header结构体中（从当前已读位置开始）
-        ssize_t bytes_read = read(client_fd, (char*)&header + header_read, remaining);
-
-        if (bytes_read == -1) {  // 读取失败
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 非阻塞模式下暂时无数据
-                std::this_thread::sleep_for(std::chrono::microseconds(200));  // 短暂等待后重试
-                // 检查是否超时
-                auto now = std::chrono::high_resolution_clock::now();
-                if (now - header_start > header_timeout) {
-                    log_error("Header read timeout (fd: " + std::to_string(client_fd) + ")");
-                    close_client(client_fd);
-                    return;
-                }
-                continue;  // 继续重试
-            } else {  // 其他错误（如连接断开）
-                log_error("Read header failed (fd: " + std::to_string(client_fd) + ")");
-                close_client(client_fd);
-                return;
+
+        // 按配置选择IO后端；io_uring初始化失败（旧内核或被禁用）时回退到epoll
+        std::unique_ptr<WorkerBase> worker;
+        if (config.backend == IoBackend::URING) {
+            worker.reset(new UringWorker(i, worker_config));
+            if (!worker->init(listen_fd)) {
+                LOG_ERROR("Worker %d io_uring unavailable, falling back to epoll", i);
+                worker.reset();
+            }
+        }
+        if (!worker) {
+            worker.reset(new Worker(i, worker_config));
+            if (!worker->init(listen_fd)) {
+                return false;
             }
-        } else if (bytes_read == 0) {  // 客户端主动断开连接
-            log_info("Client disconnected (fd: " + std::to_string(client_fd) + ") while reading header");
-            close_client(client_fd);
-            return;
         }
 
-        // 累加已读字节数并日志记录
-        header_read += bytes_read;
-        log_info("FD " + std::to_string(client_fd) + " read header chunk: " + 
-                 std::to_string(bytes_read) + " bytes (total: " + 
-                 std::to_string(header_read) + "/" + std::to_string(header_total) + ")");
-    }
-
-    // 校验魔数（网络字节序转主机字节序后对比）
-    uint32_t magic_host = ntohl(header.magic);  // 网络字节序（大端）转主机字节序
-    log_info("FD " + std::to_string(client_fd) + " received magic: " +
-             "net=0x" + std::to_string(header.magic) + ", " +  // 网络字节序原始值
-             "host=0x" + std::to_string(magic_host) + ", " +  // 转换后的值
-             "expected=0x" + std::to_string(MAGIC_NUMBER));   // 预期魔数
-    if (magic_host != MAGIC_NUMBER) {  // 魔数不匹配（非法消息）
-        log_error("Invalid magic number (fd: " + std::to_string(client_fd) + ")");
-        close_client(client_fd);
-        return;
+        // 可选的CPU亲和性：第i个线程绑定到列表中的第(i % 列表长度)个CPU
+        int cpu = -1;
+        if (!config.cpu_list.empty()) {
+            cpu = config.cpu_list[i % config.cpu_list.size()];
+        }
+        if (admission.enabled()) worker->set_admission(&admission);
+        if (config.numa) worker->set_numa_node(numa_node_for(i), &topology);
+        worker->start(cpu);
+        workers.push_back(std::move(worker));
+    }
+    LOG_INFO("Started %d worker threads (backend: %s, crc32c: %s, protocol: %s)", count,
+             workers.front()->backend_name(), crc32c_impl(), build_protocol_name());
+    if (config.numa) {
+        build_cpu_steering();
+        const char* steering = "none, single node";
+        if (!cpu_steering.empty()) {
+            // 多reactor模式：由内核按处理SYN的CPU选择监听套接字（组内下标即工作线程编号）
+            steering = !config.reuseport ? "acceptor"
+                : attach_reuseport_cpu_steering(listen_fds.front(), cpu_steering) ? "reuseport cBPF" : "hash fallback";
+        }
+        LOG_INFO("NUMA placement: %zu nodes with CPUs, connection steering by receive CPU: %s",
+                 topology.cpu_nodes_list().size(), steering);
+    }
+    if (config.poll_mode != PollMode::BLOCK || config.busy_poll_us > 0) {
+        LOG_INFO("Event loop polling: %s (spin: %dus, kernel busy poll: %dus%s)", poll_mode_name(config.poll_mode),
+                 config.poll_mode == PollMode::SPIN ? config.poll_spin_us : 0, config.busy_poll_us,
+                 config.prefer_busy_poll ? ", preferred" : "");
     }
+    if (admission.enabled()) {
+        LOG_INFO("Admission limits: %d connections, %d per source IP (0 = unlimited)",
+                 config.max_connections, config.max_connections_per_ip);
+    }
+    if (config.trace_sample > 0) {
+        LOG_INFO("Frame tracing: 1 in %u frames, last %d per worker (GET /trace or SIGUSR1; USDT probes: %s)",
+                 config.trace_sample, config.trace_capacity, BUILD_HAS_USDT ? "yes" : "no");
+    }
+    if (config.max_inflight_bytes > 0) {
+        LOG_INFO("Unsent echo limit: %lld bytes (%lld per worker; reads pause above it)",
+                 config.max_inflight_bytes, worker_config.max_inflight_bytes);
+    }
+    if (strcmp(workers.front()->backend_name(), "epoll") == 0 &&
+        (config.event_budget > 0 || config.event_frame_budget > 0)) {
+        LOG_INFO("Per-connection turn budget: %d bytes, %d frames (0 = unlimited; weights: tcp %d, unix %d)",
+                 config.event_budget, config.event_frame_budget, config.tcp_weight, config.unix_weight);
+    }
+    return true;
+}
 
-    // 解析数据长度和消息ID（网络字节序转主机字节序）
-    uint32_t data_len = ntohl(header.data_len);  // 数据部分长度
-    uint32_t msg_id = ntohl(header.msg_id);      // 消息ID
-    // 校验数据长度合法性（必须为正数且不超过缓冲区大小）
-    if (data_len <= 0 || data_len > BUFFER_SIZE) {
-        log_error("Invalid data length (" + std::to_string(data_len) + ") (fd: " + std::to_string(client_fd) + ")");
-        close_client(client_fd);
-        return;
+// 创建并启动共享内存工作线程
+// 说明：编号排在数据工作线程之后（指标中的worker标签），不参与TCP连接的轮询分配
+// 返回：true成功或未配置，false失败
+bool EchoServer::start_shm_worker() {
+    if (config.shm_path.empty()) return true;
+    shm_worker.reset(new ShmWorker(static_cast<int>(workers.size()), config));
+    if (!shm_worker->init(-1)) {
+        return false;
+    }
+    int cpu = -1;
+    if (!config.cpu_list.empty()) {
+        cpu = config.cpu_list[workers.size() % config.cpu_list.size()];
     }
+    if (admission.enabled()) shm_worker->set_admission(&admission);
+    if (config.numa) shm_worker->set_numa_node(numa_node_for(workers.size()), &topology);
+    shm_worker->start(cpu);
+    return true;
+}
 
-    // 读取完整数据部分（根据报文头的data_len）
-    size_t data_read = 0;  // 已读取的数据字节数
-    auto data_start = std::chrono::high_resolution_clock::now();  // 开始读取时间
-    const std::chrono::seconds data_timeout(5);  // 数据读取超时时间（5秒）
-    while (data_read < data_len) {
-        size_t remaining = data_len - data_read;  // 剩余未读字节数
-        // 读取剩余数据到缓冲区（从当前已读位置开始）
-        ssize_t bytes_read = read(client_fd, buffer.get() + data_read, remaining);
-
-        if (bytes_read == -1) {  // 读取失败
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 暂时无数据
-                std::this_thread::sleep_for(std::chrono::microseconds(200));  // 等待后重试
-                // 检查超时
-                auto now = std::chrono::high_resolution_clock::now();
-                if (now - data_start > data_timeout) {
-                    log_error("Data read timeout (fd: " + std::to_string(client_fd) + ")");
-                    close_client(client_fd);
-                    return;
-                }
-                continue;
-            } else {  // 其他错误
-                log_error("Read data failed (fd: " + std::to_string(client_fd) + ")");
-                close_client(client_fd);
-                return;
-            }
-        } else if (bytes_read == 0) {  // 客户端断开连接
-            log_info("Client disconnected (fd: " + std::to_string(client_fd) + ") while reading data");
-            close_client(client_fd);
-            return;
+// 第index个工作线程所属的NUMA节点
+// 参数：index - 工作线程编号
+// 返回：节点编号
+int EchoServer::numa_node_for(size_t index) const {
+    if (!config.cpu_list.empty()) {
+        int node = topology.node_of_cpu(config.cpu_list[index % config.cpu_list.size()]);
+        if (node >= 0) return node;
+    }
+    std::vector<int> nodes = topology.cpu_nodes_list();
+    return nodes[index % nodes.size()];
+}
+
+// 生成接收CPU → 工作线程的就近分配表
+void EchoServer::build_cpu_steering() {
+    if (topology.cpu_nodes_list().size() < 2) return;
+    cpu_steering.assign(topology.cpu_count(), -1);
+    node_workers.assign(topology.node_count(), std::vector<int>());
+    node_next.assign(topology.node_count(), 0);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        node_workers[workers[i]->node()].push_back(static_cast<int>(i));
+    }
+    // 绑定在某个CPU上的线程（cpu_list中靠前的线程优先）
+    if (!config.cpu_list.empty()) {
+        for (size_t i = workers.size(); i-- > 0;) {
+            int cpu = config.cpu_list[i % config.cpu_list.size()];
+            if (cpu >= 0 && cpu < topology.cpu_count()) cpu_steering[cpu] = static_cast<int>(i);
+        }
+    }
+    std::vector<size_t> next(topology.node_count(), 0);
+    size_t next_any = 0;
+    for (int cpu = 0; cpu < topology.cpu_count(); ++cpu) {
+        if (cpu_steering[cpu] >= 0) continue;
+        int node = topology.node_of_cpu(cpu);
+        if (node < 0) continue;  // 离线CPU不会处理数据包
+        const std::vector<int>& local = node_workers[node];
+        if (!local.empty()) {
+            cpu_steering[cpu] = local[next[node]++ % local.size()];
+        } else {
+            cpu_steering[cpu] = static_cast<int>(next_any++ % workers.size());
         }
+    }
+}
 
-        data_read += bytes_read;  // 累加已读字节数
-    }
-
-    // 回射数据：将接收到的报文头和数据原样返回给客户端
-    // 先回射报文头
-    size_t total_written = 0;  // 已写入的字节数
-    while (total_written < header_total) {
-        // 写入剩余的报文头部分
-        ssize_t bytes_written = write(client_fd, &header, header_total - total_written);
-        if (bytes_written == -1) {  // 写入失败
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 缓冲区满，暂时无法写入
-                std::this_thread::sleep_for(std::chrono::microseconds(1000));  // 等待后重试
-                continue;
-            } else {  // 其他错误
-                log_error("Write header failed (fd: " + std::to_string(client_fd) + ")");
-                close_client(client_fd);
-                return;
-            }
+// 为接收线程接受的TCP连接选择工作线程
+// 参数：client_fd - 客户端文件描述符
+// 返回：工作线程下标，-1表示按全局轮询
+int EchoServer::steer_connection(int client_fd) {
+    int cpu = incoming_cpu(client_fd);
+    if (cpu < 0 || cpu >= static_cast<int>(cpu_steering.size())) return -1;
+    if (!config.cpu_list.empty()) return cpu_steering[cpu];
+    int node = topology.node_of_cpu(cpu);
+    if (node < 0 || node_workers[node].empty()) return cpu_steering[cpu];
+    const std::vector<int>& local = node_workers[node];
+    return local[node_next[node]++ % local.size()];
+}
+
+// 创建（或沿用交接得到的）Unix域监听套接字并注册到epoll
+// 说明：Unix域监听套接字为水平触发，用完接受预算后下一轮epoll_wait会再次报告，无需额外的待接受标志
+// 参数：
+//   inherited_unix - 交接得到的Unix域数据监听套接字，-1表示新建
+//   inherited_shm - 交接得到的共享内存监听套接字，-1表示新建
+// 返回：true成功，false失败
+bool EchoServer::start_local_listeners(int inherited_unix, int inherited_shm) {
+    if (!config.unix_path.empty()) {
+        unix_fd = inherited_unix != -1 ? inherited_unix
+                                       : create_unix_listen_socket(config.unix_path, config.listen_backlog);
+        if (unix_fd == -1 || !watch(unix_fd, EPOLLIN)) {
+            return false;
         }
-        total_written += bytes_written;  // 累加已写入字节数
-    }
-
-    // 再回射数据部分
-    total_written = 0;
-    while (total_written < data_len) {
-        // 写入剩余的数据部分
-        ssize_t bytes_written = write(client_fd, buffer.get() + total_written, data_len - total_written);
-        if (bytes_written == -1) {  // 写入失败
-            if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 缓冲区满
-                std::this_thread::sleep_for(std::chrono::microseconds(1000));  // 等待后重试
-                continue;
-            } else {  // 其他错误
-                log_error("Write data failed (fd: " + std::to_string(client_fd) + ")");
-                close_client(client_fd);
-                return;
-            }
+        listen_fds.push_back(unix_fd);
+        LOG_INFO("Listening on unix socket %s", config.unix_path.c_str());
+    }
+    if (!config.shm_path.empty()) {
+        shm_fd = inherited_shm != -1 ? inherited_shm
+                                     : create_unix_listen_socket(config.shm_path, config.listen_backlog);
+        if (shm_fd == -1 || !watch(shm_fd, EPOLLIN)) {
+            return false;
         }
-        total_written += bytes_written;  // 累加已写入字节数
+        listen_fds.push_back(shm_fd);
+        LOG_INFO("Shared-memory transport on %s (ring: %zu bytes)", config.shm_path.c_str(), config.shm_ring_size);
     }
+    return true;
+}
 
-    // 清理残留数据（处理粘包：读取所有未处理的剩余数据，避免影响下一条消息）
-    char dummy[4096];  // 临时缓冲区
-    while (true) {
-        ssize_t leftover = read(client_fd, dummy, sizeof(dummy));  // 读取残留数据
-        if (leftover <= 0) break;  // 无残留数据或读取失败（正常退出）
-        log_info("FD " + std::to_string(client_fd) + " cleared leftover: " + std::to_string(leftover) + " bytes");
+// 启动管理端口
+// 返回：true成功或未配置，false失败
+bool EchoServer::start_admin() {
+    if (config.admin_port <= 0) return true;
+    admin.reset(new AdminServer([this]() { return render_metrics(); }));
+    if (config.trace_sample > 0) {
+        admin->add_route("/trace", "application/json", [this]() { return render_trace(); });
     }
+    return admin->start(config.admin_port);
+}
 
-    // 短暂延迟：避免快速重新注册事件导致的冲突
-    std::this_thread::sleep_for(std::chrono::microseconds(500));
+// 渲染所有工作线程的Prometheus指标
+// 说明：工作线程（含共享内存线程）在管理线程启动前创建、停止前销毁，遍历期间列表不会变化
+std::string EchoServer::render_metrics() const {
+    std::vector<const ServerMetrics*> metrics;
+    std::vector<BufferPoolStats> pools;
+    metrics.reserve(workers.size() + 1);
+    pools.reserve(workers.size() + 1);
+    for (const auto& worker : workers) {
+        metrics.push_back(&worker->server_metrics());
+        pools.push_back(worker->pool_stats());
+    }
+    if (shm_worker) {
+        metrics.push_back(&shm_worker->server_metrics());
+        pools.push_back(shm_worker->pool_stats());
+    }
+    std::string out;
+    render_prometheus(metrics, pools, out);
+    admission.render_prometheus(out);
+    return out;
+}
 
-    // 归还缓冲区并重新注册epoll事件（继续监听该客户端的新数据）
-    std::lock_guard<std::mutex> lock(buffer_mutex);
-    client_buffers[client_fd] = std::move(buffer);  // 归还缓冲区所有权
-    struct epoll_event event;
-    // 事件类型：可读（EPOLLIN）、边缘触发（EPOLLET）、一次性触发（EPOLLONESHOT）
-    // 注：EPOLLONESHOT确保事件只被一个线程处理，处理完需重新注册
-    event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
-    event.data.fd = client_fd;  // 关联客户端fd
-    // 修改epoll事件（重新启用监听）
-    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client_fd, &event);
-
-    log_info("Processed msg_id: " + std::to_string(msg_id) + ", fd: " + std::to_string(client_fd));
+// 渲染所有工作线程的抽样追踪记录（Chrome trace格式）
+// 说明：共享内存线程不做抽样追踪，不包含在内；pid即工作线程编号
+std::string EchoServer::render_trace() const {
+    std::vector<const FrameTracer*> tracers;
+    tracers.reserve(workers.size());
+    for (const auto& worker : workers) {
+        tracers.push_back(&worker->frame_tracer());
+    }
+    std::string out;
+    render_chrome_trace(tracers, out);
+    return out;
 }
 
-// 启动服务器：初始化并进入事件循环
+// 把抽样追踪记录写到trace_file（收到SIGUSR1时在接收线程中调用）
+void EchoServer::dump_trace() {
+    if (config.trace_sample == 0) {
+        LOG_WARN("Received SIGUSR1 but tracing is off (--trace-sample=N to enable)");
+        return;
+    }
+    std::string path = config.trace_file;
+    if (path.empty()) path = "echo-trace-" + std::to_string(getpid()) + ".json";
+    std::string text = render_trace();
+    FILE* f = fopen(path.c_str(), "w");
+    if (f == nullptr) {
+        LOG_ERROR("Open trace file %s failed (errno: %d)", path.c_str(), errno);
+        return;
+    }
+    size_t written = fwrite(text.data(), 1, text.size(), f);
+    if (fclose(f) != 0 || written != text.size()) {
+        LOG_ERROR("Write trace file %s failed (errno: %d)", path.c_str(), errno);
+        return;
+    }
+    LOG_INFO("Wrote %zu bytes of frame traces to %s", text.size(), path.c_str());
+}
+
+// 启动服务器：初始化并进入事件循环，收到关闭信号或完成热重启交接后排空并返回
 void EchoServer::start()
 {
-    // 创建监听套接字（IPv4，TCP）
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd == -1) {  // 创建失败
-        log_error("Socket creation failed (errno: " + std::to_string(errno) + ")");
+    // 热重启：先向旧进程索取监听套接字（没有旧进程时正常创建）
+    std::vector<int> inherited;
+    if (!config.handoff_path.empty() && !receive_listen_fds(config.handoff_path, inherited)) {
+        LOG_ERROR("Listening socket handoff failed");
         return;
     }
-
-    // 设置端口复用（避免服务器重启时端口被占用的TIME_WAIT状态阻塞）
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
-        log_error("Setsockopt failed (errno: " + std::to_string(errno) + ")");
-        close(server_fd);  // 清理资源
+    // 交接得到的Unix域监听套接字按绑定路径认出，其余为TCP监听套接字
+    int inherited_unix = take_unix_listener(inherited, config.unix_path);
+    int inherited_shm = take_unix_listener(inherited, config.shm_path);
+    drop_unix_listeners(inherited);
+
+    // 启动工作线程池（多reactor模式下各线程同时创建或接过自己的监听套接字）
+    if (!start_workers(inherited)) {
+        LOG_ERROR("Start workers failed");
+        if (inherited_unix != -1) close(inherited_unix);
+        if (inherited_shm != -1) close(inherited_shm);
         return;
     }
-
-    // 绑定套接字到指定端口
-    struct sockaddr_in server_addr;  // 服务器地址结构
-    memset(&server_addr, 0, sizeof(server_addr));  // 清零
-    server_addr.sin_family = AF_INET;  // IPv4
-    server_addr.sin_addr.s_addr = INADDR_ANY;  // 监听所有网络接口
-    server_addr.sin_port = htons(port);  // 端口（主机字节序转网络字节序）
-    if (bind(server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
-        log_error("Bind failed (errno: " + std::to_string(errno) + ")");
-        close(server_fd);
+    if (!start_shm_worker()) {
+        LOG_ERROR("Start shm worker failed");
+        if (inherited_unix != -1) close(inherited_unix);
+        if (inherited_shm != -1) close(inherited_shm);
         return;
     }
-
-    // 开始监听（最大等待队列长度1024）
-    if (listen(server_fd, 1024) == -1) {
-        log_error("Listen failed (errno: " + std::to_string(errno) + ")");
-        close(server_fd);
+    if (!start_admin()) {
+        LOG_ERROR("Start admin endpoint failed");
         return;
     }
 
-    // 设置监听套接字为非阻塞模式
-    if (set_nonblocking(server_fd) == -1) {
-        log_error("Set nonblocking failed for server_fd");
-        close(server_fd);
-        return;
+    // 单接收线程模式：创建（或沿用交接得到的）监听套接字
+    if (!config.reuseport) {
+        server_fd = inherited.empty()
+            ? create_listen_socket(config.port, false, config.listen_backlog, config.defer_accept)
+            : inherited.front();
+        if (server_fd == -1) {
+            return;
+        }
+        listen_fds.push_back(server_fd);
+    }
+    for (size_t i = listen_fds.size(); i < inherited.size(); ++i) {  // 旧进程的监听套接字多于本进程所需
+        LOG_ERROR("Closing surplus inherited listening socket (fd: %d)", inherited[i]);
+        close(inherited[i]);
     }
 
-    // 创建epoll实例（参数0表示不使用标志）
-    epoll_fd = epoll_create1(0);
+    // 创建epoll实例
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
     if (epoll_fd == -1) {
-        log_error("Epoll create failed");
-        close(server_fd);
+        LOG_ERROR("Epoll create failed");
+        return;
+    }
+    batches.resize(workers.size());
+
+    // 关闭信号和导出追踪的信号经signalfd在事件循环中处理（信号已由block_signals屏蔽）
+    sigset_t mask;
+    server_signals(mask);
+    signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd == -1 || !watch(signal_fd, EPOLLIN)) {
+        LOG_ERROR("Signalfd setup failed (errno: %d)", errno);
         return;
     }
 
     // 注册监听套接字到epoll（监听可读事件，边缘触发）
-    struct epoll_event event;
-    event.events = EPOLLIN | EPOLLET;  // 可读事件，边缘触发
-    event.data.fd = server_fd;         // 关联监听套接字
-    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_fd, &event) == -1) {  // 添加事件
-        log_error("Epoll add server_fd failed");
-        close(epoll_fd);
-        close(server_fd);
+    if (server_fd != -1 && !watch(server_fd, EPOLLIN | EPOLLET)) {
+        LOG_ERROR("Epoll add server_fd failed");
         return;
     }
+    if (!start_local_listeners(inherited_unix, inherited_shm)) {
+        LOG_ERROR("Start unix socket listeners failed");
+        return;
+    }
+
+    // 等待下一个进程来接手监听套接字
+    if (!config.handoff_path.empty()) {
+        handoff_fd = create_handoff_listener(config.handoff_path);
+        if (handoff_fd == -1 || !watch(handoff_fd, EPOLLIN)) {
+            return;
+        }
+    }
 
-    log_info("Server initialized on port " + std::to_string(port));
-    log_info("Server started, waiting for connections...");
+    if (config.reuseport) {
+        LOG_INFO("Server initialized on port %d (multi-reactor, %zu SO_REUSEPORT listeners)", config.port, workers.size());
+    } else {
+        LOG_INFO("Server initialized on port %d", config.port);
+    }
+    LOG_INFO("Server started, waiting for connections...");
     running = true;  // 标记服务器运行中
 
     // 事件循环：持续处理epoll事件
-    const int MAX_EVENTS = 1024;  // 一次最多处理的事件数
+    const int MAX_EVENTS = 16;  // 一次最多处理的事件数（最多只有5个fd）
     struct epoll_event events[MAX_EVENTS];  // 存储就绪事件的数组
+    bool accept_pending = false;  // 上一轮用完接受预算，监听队列中可能还有连接
 
     while (running) {
-        // 等待事件就绪（超时-1表示无限等待）
-        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        // 等待事件就绪（还有未接受的连接时不等待，否则无限等待）
+        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, accept_pending ? 0 : -1);
         if (num_events == -1) {  // 等待失败
             if (errno == EINTR) continue;  // 被信号中断，继续循环
-            log_error("Epoll wait failed");
+            LOG_ERROR("Epoll wait failed");
             break;  // 其他错误，退出循环
         }
 
-        // 处理每个就绪事件
         for (int i = 0; i < num_events; ++i) {
-            int fd = events[i].data.fd;  // 事件关联的文件描述符
-
-            // 监听套接字就绪：有新连接到来
-            if (fd == server_fd) {
-                while (true) {  // 循环接受所有新连接（边缘触发需一次性处理完）
-                    struct sockaddr_in client_addr;  // 客户端地址结构
-                    socklen_t client_len = sizeof(client_addr);
-                    // 接受新连接（非阻塞模式）
-                    int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-                    if (client_fd == -1) {  // 接受失败
-                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                            break;  // 没有更多连接，退出循环
-                        } else {
-                            log_error("Accept failed (errno: " + std::to_string(errno) + ")");
-                            break;
-                        }
-                    }
-
-                    // 输出客户端连接信息
-                    log_info("New connection from " + std::string(inet_ntoa(client_addr.sin_addr)) + 
-                             ":" + std::to_string(ntohs(client_addr.sin_port)) + 
-                             " (fd: " + std::to_string(client_fd) + ")");
-
-                    // 设置客户端套接字为非阻塞模式
-                    if (set_nonblocking(client_fd) == -1) {
-                        log_error("Set nonblocking failed for client_fd: " + std::to_string(client_fd));
-                        close(client_fd);
-                        continue;
-                    }
-
-                    // 为客户端分配缓冲区（4096字节）
-                    std::lock_guard<std::mutex> lock(buffer_mutex);
-                    client_buffers[client_fd] = std::make_unique<char[]>(BUFFER_SIZE);
-
-                    // 注册客户端套接字到epoll（可读事件，边缘触发，一次性触发）
-                    struct epoll_event client_event;
-                    client_event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
-                    client_event.data.fd = client_fd;
-                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &client_event) == -1) {
-                        log_error("Epoll add client_fd failed (fd: " + std::to_string(client_fd) + ")");
-                        close_client(client_fd);  // 清理失败的客户端
-                    }
-                }
-            } else {  // 客户端套接字就绪：有数据可读
-                // 启动线程处理客户端数据（避免阻塞事件循环）
-                std::thread(&EchoServer::handle_client_data, this, fd).detach();
+            int fd = events[i].data.fd;
+            if (fd == server_fd) {  // 监听套接字就绪：有新连接到来
+                accept_pending = true;
+            } else if (fd == signal_fd) {  // 关闭信号
+                handle_signal();
+            } else if (fd == handoff_fd) {  // 新进程请求接手监听套接字
+                handle_handoff();
+            } else if (running && (fd == unix_fd || fd == shm_fd)) {  // Unix域连接（水平触发）
+                accept_batch(fd);
+            }
+        }
+        if (running && accept_pending) {
+            accept_pending = accept_batch(server_fd);
+        }
+    }
+    drain_workers();
+}
+
+// 把fd注册到接收线程的epoll
+// 参数：
+//   fd - 文件描述符（事件的data.fd）
+//   events - 关注的事件
+// 返回：true成功，false失败
+bool EchoServer::watch(int fd, uint32_t events) {
+    struct epoll_event event;
+    event.events = events;
+    event.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+// 处理信号：SIGUSR1导出追踪记录；关闭信号停止接受新连接，退出事件循环后排空
+void EchoServer::handle_signal() {
+    struct signalfd_siginfo info;
+    while (read(signal_fd, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info))) {
+        if (info.ssi_signo == SIGUSR1) {
+            dump_trace();
+            continue;
+        }
+        LOG_INFO("Received signal %u, shutting down", info.ssi_signo);
+        stop_listening(true);
+        running = false;
+    }
+}
+
+// 处理热重启交接：把监听套接字发给新进程，成功后停止接受新连接并排空
+// 说明：先发送再停止接受，交接失败时本进程照常服务；发送后到工作线程停止accept之间
+//       被本进程接受的少量连接会在报文边界处关闭，客户端重连时由新进程接受
+void EchoServer::handle_handoff() {
+    int conn_fd = accept4(handoff_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR("Handoff accept failed (errno: %d)", errno);
+        }
+        return;
+    }
+    bool sent = send_listen_fds(conn_fd, listen_fds);
+    close(conn_fd);
+    if (sent) {
+        LOG_INFO("Handed off %zu listening sockets to the new process, draining", listen_fds.size());
+        stop_listening(false);  // 路径已由新进程重新绑定，不能删除
+        running = false;
+    }
+}
+
+// 停止接受新连接：关闭接收线程的监听套接字和交接套接字
+// 参数：remove_path - 是否删除各Unix域套接字路径（热重启交接后由新进程持有这些路径）
+void EchoServer::stop_listening(bool remove_path) {
+    if (server_fd != -1) {
+        close(server_fd);  // 内核会自动将其从epoll中移除
+        server_fd = -1;
+    }
+    if (handoff_fd != -1) {
+        close(handoff_fd);
+        handoff_fd = -1;
+        if (remove_path) unlink(config.handoff_path.c_str());
+    }
+    if (unix_fd != -1) {
+        close(unix_fd);
+        unix_fd = -1;
+        if (remove_path) unlink(config.unix_path.c_str());
+    }
+    if (shm_fd != -1) {
+        close(shm_fd);
+        shm_fd = -1;
+        if (remove_path) unlink(config.shm_path.c_str());
+    }
+}
+
+// 排空所有工作线程：各线程停止accept，回射完已收到的报文后关闭连接，超时则强制关闭
+void EchoServer::drain_workers() {
+    LOG_INFO("Draining connections (timeout: %ds)", config.drain_timeout);
+    for (auto& worker : workers) {
+        worker->drain();
+    }
+    if (shm_worker) shm_worker->drain();
+    for (auto& worker : workers) {
+        worker->join();
+    }
+    if (shm_worker) shm_worker->join();
+    LOG_INFO("Server stopped");
+}
+
+// 屏蔽关闭信号（SIGINT/SIGTERM）和导出追踪的信号（SIGUSR1）并忽略SIGPIPE
+// 说明：之后创建的线程都继承该信号屏蔽字，这些信号只由接收线程经signalfd处理；
+//       对端重置的连接上writev不应终止进程，错误由返回值处理
+void EchoServer::block_signals() {
+    sigset_t mask;
+    server_signals(mask);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// 接受一批新连接并按轮询方式批量投递给工作线程
+// 说明：每个工作线程一批只加一次锁、唤醒一次；连接数达到接受预算时先投递已接受的连接，
+//       剩余连接留到下一轮（监听套接字为边缘触发，由返回值提示调用方继续接受）
+// 参数：listen_fd - 就绪的监听套接字
+// 返回：true用完预算（可能还有未接受的连接），false已接受到EAGAIN或出错
+bool EchoServer::accept_batch(int listen_fd) {
+    for (auto& batch : batches) batch.clear();
+    shm_batch.clear();
+    bool more = false;
+    int accepted = 0;
+    while (true) {
+        if (config.accept_budget > 0 && accepted >= config.accept_budget) {
+            more = true;
+            break;
+        }
+        struct sockaddr_in client_addr;  // 客户端地址结构
+        int client_fd = accept_client(listen_fd, client_addr);
+        if (client_fd == -1) {  // 没有更多连接或出错（如fd耗尽，等下一个新连接再重试）
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR_RL("Accept failed (errno: %d)", errno);
             }
+            break;
+        }
+        ++accepted;
+        if (!admission.admit(client_fd, &client_addr)) {  // 超出准入上限：立即拒绝（RST），不投递给工作线程
+            LOG_WARN_RL("Shed connection (fd: %d, admitted: %d)", client_fd, admission.active_connections());
+            AdmissionControl::reject(client_fd);
+            continue;
         }
+
+        if (listen_fd == shm_fd) {  // 共享内存通道：由共享内存线程建立并服务
+            LOG_INFO("New shm connection (fd: %d)", client_fd);
+            shm_batch.push_back(client_fd);
+            continue;
+        }
+
+        // 输出客户端连接信息
+        if (listen_fd == server_fd) {
+            LOG_INFO("New connection from %s:%d (fd: %d)",
+                     inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), client_fd);
+        } else {
+            LOG_INFO("New unix socket connection (fd: %d)", client_fd);
+        }
+
+        // --numa：TCP连接交给接收CPU所在节点的工作线程；其余轮询分配。之后该连接的所有IO都由该线程处理
+        size_t target = next_worker;
+        int steered = cpu_steering.empty() || listen_fd != server_fd ? -1 : steer_connection(client_fd);
+        if (steered >= 0) {
+            target = static_cast<size_t>(steered);
+        } else {
+            next_worker = (next_worker + 1) % workers.size();
+        }
+        batches[target].push_back(client_fd);
     }
-}
\ No newline at end of file
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->add_connections(batches[i]);
+    }
+    if (shm_worker) shm_worker->add_connections(shm_batch);
+    return more;
+}
@@ -2,55 +2,129 @@
 #define ECHO_SERVER_H
 
 #include "common.h"               // 包含公共常量、结构体和日志函数
-#include <unordered_map>          // 用于存储客户端缓冲区和互斥锁的映射
-#include <mutex>                  // 用于线程同步
-#include <memory>                 // 用于智能指针（管理动态内存）
+#include "worker_base.h"          // 包含工作线程基类定义
+#include "admin_server.h"         // 包含管理端口（指标导出）
+#include "admission.h"            // 包含连接准入控制
+#include "numa.h"                 // 包含NUMA拓扑
+#include <vector>                 // 用于存储工作线程
+#include <memory>                 // 用于智能指针（管理工作线程对象）
 #include <sys/epoll.h>            // 用于epoll事件驱动机制
 
 // 回射服务器类：实现基于epoll的高性能TCP服务器，接收客户端消息并回射
+// 结构：默认模式下主线程负责接受新连接，并按轮询方式分配给固定数量的工作线程；
+//       多reactor模式下每个工作线程拥有独立的epoll和SO_REUSEPORT监听套接字，
+//       由内核分摊新连接，线程之间不共享任何状态。
+//       两种模式下连接在整个生命周期内都由同一个工作线程处理
 class EchoServer
 {
 private:
-    int server_fd;                  // 监听套接字文件描述符（用于接受新连接）
-    int epoll_fd;                   // epoll句柄（用于管理IO事件）
-    int port;                       // 服务器监听端口
-    bool running;                   // 服务器运行状态标志（控制事件循环）
-    
-    // 客户端缓冲区映射：key为客户端fd，value为该客户端的读写缓冲区（智能指针管理）
-    std::unordered_map<int, std::unique_ptr<char[]>> client_buffers;
-    std::mutex buffer_mutex;        // 保护client_buffers的互斥锁（多线程安全）
-    // 客户端fd对应的互斥锁：确保同一客户端的IO操作串行化（避免数据竞争）
-    std::unordered_map<int, std::mutex> fd_mutexes;
-    std::mutex fd_mutex_map_mutex;  // 保护fd_mutexes的互斥锁（多线程安全访问映射）
-
-    // 设置文件描述符为非阻塞模式
-    // 参数：fd - 目标文件描述符
-    // 返回：0成功，-1失败
-    int set_nonblocking(int fd);
-
-    // 关闭客户端连接并清理相关资源
-    // 参数：client_fd - 客户端文件描述符
-    void close_client(int client_fd);
+    int server_fd;                  // 监听套接字文件描述符（仅单接收线程模式使用）
+    int epoll_fd;                   // 接收线程的epoll句柄
+    int signal_fd;                  // signalfd：接收SIGINT/SIGTERM
+    int handoff_fd;                 // 热重启交接的Unix域监听套接字（未配置时为-1）
+    int unix_fd;                    // Unix域数据监听套接字（未配置时为-1）
+    int shm_fd;                     // 共享内存通道的Unix域监听套接字（未配置时为-1）
+    ServerConfig config;            // 服务端配置
+    bool running;                   // 服务器运行状态标志（控制事件循环，收到关闭信号或完成交接后置false）
+    std::vector<int> listen_fds;    // 全部数据监听套接字（热重启时交给新进程；不持有，由各自的所有者关闭）
+    // 连接准入控制：接受连接时检查总连接数和单IP连接数上限（各工作线程共享，先于工作线程创建、后于其销毁）
+    AdmissionControl admission;
+
+    // 工作线程池：数量由配置决定，默认等于CPU核数；IO后端（epoll/io_uring）由配置选择
+    std::vector<std::unique_ptr<WorkerBase>> workers;
+    size_t next_worker;             // 下一个分配连接的工作线程下标（轮询分配）
+    NumaTopology topology;          // NUMA拓扑（仅--numa时读取）
+    std::vector<int> cpu_steering;  // 接收CPU → 就近的工作线程下标（仅--numa且有多个节点；为空表示轮询分配）
+    std::vector<std::vector<int>> node_workers;  // 各节点上的工作线程下标（接收线程按节点轮询分配）
+    std::vector<size_t> node_next;  // 各节点下一个分配连接的工作线程（node_workers中的下标）
+    std::vector<std::vector<int>> batches;  // 本轮分配给各工作线程的新连接（批量投递，复用内存）
+
+    // 共享内存工作线程（配置了shm_path时创建），服务所有共享内存通道
+    std::unique_ptr<WorkerBase> shm_worker;
+    std::vector<int> shm_batch;     // 本轮投递给共享内存线程的新连接
+
+    // 管理端口（配置了admin_port时创建），读取各工作线程的指标
+    std::unique_ptr<AdminServer> admin;
+
+    // 创建并启动工作线程池
+    // 参数：inherited - 从旧进程接过的监听套接字（多reactor模式下依次分给各工作线程）
+    // 返回：true成功，false失败
+    bool start_workers(const std::vector<int>& inherited);
 
-    // 获取客户端fd对应的互斥锁（不存在则创建）
+    // 第index个工作线程所属的NUMA节点：绑定了CPU时为该CPU的节点，否则在有CPU的节点间轮流
+    // 参数：index - 工作线程编号（共享内存线程排在数据工作线程之后）
+    // 返回：节点编号
+    int numa_node_for(size_t index) const;
+
+    // 生成接收CPU → 工作线程的就近分配表：优先绑定在该CPU上的线程，其次同节点的线程（按CPU轮流），
+    // 节点上没有工作线程时按CPU轮流分给所有线程；同时按节点归类工作线程
+    // 注：只有一个节点时不生成（没有跨节点访问可避免，按CPU分配反而会让处理网卡中断的CPU上的线程独占连接）
+    void build_cpu_steering();
+
+    // 为接收线程接受的TCP连接选择工作线程：绑定了CPU时按分配表，否则在接收CPU所在节点的线程间轮询
     // 参数：client_fd - 客户端文件描述符
-    // 返回：该fd对应的互斥锁引用
-    std::mutex& get_fd_mutex(int client_fd);
+    // 返回：工作线程下标，-1表示不就近分配（按全局轮询）
+    int steer_connection(int client_fd);
+
+    // 创建并启动共享内存工作线程（shm_path为空时不创建）
+    // 返回：true成功或未配置，false失败
+    bool start_shm_worker();
+
+    // 创建（或沿用交接得到的）Unix域数据监听套接字和共享内存监听套接字，并注册到epoll
+    // 参数：inherited - 从旧进程接过的Unix域监听套接字（按路径认出，-1表示需要新建）
+    // 返回：true成功，false失败
+    bool start_local_listeners(int inherited_unix, int inherited_shm);
+
+    // 把fd注册到接收线程的epoll
+    // 返回：true成功，false失败
+    bool watch(int fd, uint32_t events);
+
+    // 处理关闭信号
+    void handle_signal();
+
+    // 处理新进程的热重启交接请求
+    void handle_handoff();
+
+    // 停止接受新连接：关闭接收线程的监听套接字和交接套接字
+    // 参数：remove_path - 是否删除交接套接字路径
+    void stop_listening(bool remove_path);
+
+    // 排空并停止所有工作线程
+    void drain_workers();
+
+    // 启动管理端口（admin_port为0时不启动）
+    // 返回：true成功或未配置，false失败
+    bool start_admin();
+
+    // 接受一批新连接并批量投递给工作线程（TCP：单接收线程模式；Unix域：两种模式）
+    // 参数：listen_fd - 就绪的监听套接字（共享内存套接字上的连接投递给共享内存线程）
+    // 返回：true用完接受预算（可能还有未接受的连接），false已接受完
+    bool accept_batch(int listen_fd);
+
+    // 渲染所有工作线程的Prometheus指标（在管理线程中调用）
+    std::string render_metrics() const;
+
+    // 渲染所有工作线程的抽样追踪记录（Chrome trace格式；在管理线程或接收线程中调用）
+    std::string render_trace() const;
+
+    // 把抽样追踪记录写到trace_file（收到SIGUSR1时调用；未开启追踪时只记录日志）
+    void dump_trace();
 
 public:
-    // 构造函数：初始化服务器端口
-    // 参数：port - 监听端口
-    EchoServer(int port);
+    // 构造函数：初始化服务器配置
+    // 参数：cfg - 服务端配置
+    EchoServer(const ServerConfig& cfg);
 
     // 析构函数：停止服务器并释放资源
     ~EchoServer();
 
-    // 启动服务器：初始化套接字、epoll，进入事件循环
+    // 启动服务器：初始化套接字、epoll和工作线程池，进入事件循环
+    // 说明：收到SIGINT/SIGTERM或把监听套接字交给新进程后停止接受新连接，
+    //       排空已有连接（最长drain_timeout秒）后返回
     void start();
 
-    // 处理客户端数据：读取、校验、回射消息
-    // 参数：client_fd - 客户端文件描述符
-    void handle_client_data(int client_fd);
+    // 屏蔽关闭信号并忽略SIGPIPE（须在创建任何线程之前调用，包括日志线程）
+    static void block_signals();
 };
 
 #endif // ECHO_SERVER_H
\ No newline at end of file
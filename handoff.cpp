@@ -0,0 +1,155 @@
+#include "handoff.h"
+#include "common.h"           // 用于日志宏
+#include <sys/socket.h>       // 用于sendmsg/recvmsg和SCM_RIGHTS
+#include <sys/un.h>           // 用于Unix域地址结构（sockaddr_un）
+#include <sys/time.h>         // 用于SO_RCVTIMEO超时
+#include <unistd.h>           // 用于close/unlink
+#include <errno.h>            // 用于错误码
+#include <cstring>            // 用于memset/memcpy
+
+namespace {
+
+const size_t MAX_HANDOFF_FDS = 253;    // 一条消息最多携带的fd数（内核SCM_MAX_FD）
+const int RECEIVE_TIMEOUT_SEC = 5;     // 等待旧进程发送监听fd的超时
+
+// 填写Unix域地址
+// 返回：true成功，false路径过长
+bool make_address(const std::string& path, struct sockaddr_un& addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Handoff path too long: %s", path.c_str());
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+} // namespace
+
+// 创建交接用的Unix域监听套接字
+// 参数：path - 套接字路径
+// 返回：监听套接字fd，失败返回-1
+int create_handoff_listener(const std::string& path) {
+    struct sockaddr_un addr;
+    if (!make_address(path, addr)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("Handoff socket creation failed (errno: %d)", errno);
+        return -1;
+    }
+    unlink(path.c_str());  // 删除旧进程或上次运行留下的路径（旧进程已打开的套接字不受影响）
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, 4) == -1) {
+        LOG_ERROR("Handoff listen on %s failed (errno: %d)", path.c_str(), errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 把监听fd发送给新进程：数据部分为fd个数，fd本身放在SCM_RIGHTS控制消息中
+// 参数：
+//   conn_fd - 与新进程的连接
+//   fds - 监听fd列表
+// 返回：true成功，false失败
+bool send_listen_fds(int conn_fd, const std::vector<int>& fds) {
+    if (fds.empty() || fds.size() > MAX_HANDOFF_FDS) {
+        LOG_ERROR("Cannot hand off %zu listening sockets", fds.size());
+        return false;
+    }
+    uint32_t count = static_cast<uint32_t>(fds.size());
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()), 0);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+    while (sendmsg(conn_fd, &msg, MSG_NOSIGNAL) == -1) {
+        if (errno == EINTR) continue;
+        LOG_ERROR("Handoff send failed (errno: %d)", errno);
+        return false;
+    }
+    return true;
+}
+
+// 连接旧进程的交接套接字并接收其监听fd
+// 参数：
+//   path - 套接字路径
+//   fds - 输出参数，接收到的监听fd
+// 返回：true成功或没有旧进程，false交接失败
+bool receive_listen_fds(const std::string& path, std::vector<int>& fds) {
+    fds.clear();
+    struct sockaddr_un addr;
+    if (!make_address(path, addr)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("Handoff socket creation failed (errno: %d)", errno);
+        return false;
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        int err = errno;
+        close(fd);
+        if (err == ENOENT || err == ECONNREFUSED) return true;  // 没有旧进程在等待：正常启动
+        LOG_ERROR("Handoff connect to %s failed (errno: %d)", path.c_str(), err);
+        return false;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = RECEIVE_TIMEOUT_SEC;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    uint32_t count = 0;
+    struct iovec iov;
+    iov.iov_base = &count;
+    iov.iov_len = sizeof(count);
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * MAX_HANDOFF_FDS), 0);
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t n;
+    while ((n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)) == -1 && errno == EINTR) {}
+    int err = errno;
+    close(fd);
+    if (n != static_cast<ssize_t>(sizeof(count))) {
+        LOG_ERROR("Handoff receive failed (errno: %d)", n == -1 ? err : 0);
+        return false;
+    }
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        size_t received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char* data = CMSG_DATA(cmsg);
+        for (size_t i = 0; i < received; ++i) {
+            int listen_fd;
+            memcpy(&listen_fd, data + i * sizeof(int), sizeof(int));
+            fds.push_back(listen_fd);
+        }
+    }
+    if (fds.size() != count || (msg.msg_flags & MSG_CTRUNC)) {
+        LOG_ERROR("Handoff expected %u listening sockets, received %zu", count, fds.size());
+        for (int listen_fd : fds) close(listen_fd);
+        fds.clear();
+        return false;
+    }
+    LOG_INFO("Received %zu listening sockets from the previous process", fds.size());
+    return true;
+}
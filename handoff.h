@@ -0,0 +1,30 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+// 热重启的监听套接字交接：旧进程在Unix域套接字上等待，新进程启动时连接该套接字，
+// 旧进程把全部监听fd经SCM_RIGHTS传给新进程后开始排空。监听套接字本身（及其中
+// 尚未accept的连接）始终存在，部署期间既不拒绝新连接，也不会让所有客户端同时重连
+
+#include <string>                 // 用于套接字路径
+#include <vector>                 // 用于监听fd列表
+
+// 创建交接用的Unix域监听套接字（非阻塞；路径已存在时先删除）
+// 参数：path - 套接字路径
+// 返回：监听套接字fd，失败返回-1（错误已记录日志）
+int create_handoff_listener(const std::string& path);
+
+// 把监听fd发送给已连接的新进程
+// 参数：
+//   conn_fd - 与新进程的连接
+//   fds - 监听fd列表（发送后本进程仍持有自己的副本）
+// 返回：true成功，false失败（错误已记录日志）
+bool send_listen_fds(int conn_fd, const std::vector<int>& fds);
+
+// 连接旧进程的交接套接字并接收其监听fd
+// 参数：
+//   path - 套接字路径
+//   fds - 输出参数，接收到的监听fd（没有旧进程时为空）
+// 返回：true成功或没有旧进程在等待（首次启动），false交接失败（错误已记录日志）
+bool receive_listen_fds(const std::string& path, std::vector<int>& fds);
+
+#endif // HANDOFF_H
@@ -0,0 +1,61 @@
+#include "iovec_list.h"
+#include <limits.h>           // 用于IOV_MAX
+
+// 构造函数：预留iovec容量
+// 参数：capacity - 预留的iovec数量
+IovecList::IovecList(size_t capacity) : head(0), pending(0) {
+    iovs.reserve(capacity);
+}
+
+// 追加一段待写内存
+// 参数：
+//   base - 内存起始地址
+//   len - 内存长度
+void IovecList::push(const void* base, size_t len) {
+    if (len == 0) return;
+    struct iovec iov;
+    iov.iov_base = const_cast<void*>(base);
+    iov.iov_len = len;
+    iovs.push_back(iov);
+    pending += len;
+}
+
+// 清空列表（保留容量）
+void IovecList::clear() {
+    iovs.clear();
+    head = 0;
+    pending = 0;
+}
+
+// 按已写出的字节数推进iovec
+// 参数：bytes - 本次写出的字节数
+void IovecList::advance(size_t bytes) {
+    pending -= bytes;
+    while (bytes > 0) {
+        struct iovec& iov = iovs[head];
+        if (bytes >= iov.iov_len) {  // 该段已写完，跳到下一段
+            bytes -= iov.iov_len;
+            ++head;
+        } else {  // 该段只写了一部分，修正起始位置和剩余长度
+            iov.iov_base = static_cast<char*>(iov.iov_base) + bytes;
+            iov.iov_len -= bytes;
+            bytes = 0;
+        }
+    }
+    if (pending == 0) {  // 全部写出，复位以便复用
+        clear();
+    }
+}
+
+// 调用一次writev写出尽可能多的数据
+// 参数：fd - 目标文件描述符
+// 返回：写出的字节数，失败返回-1
+ssize_t IovecList::write_to(int fd) {
+    size_t remaining = iovs.size() - head;
+    int count = remaining > IOV_MAX ? IOV_MAX : static_cast<int>(remaining);
+    ssize_t bytes_written = writev(fd, iovs.data() + head, count);
+    if (bytes_written > 0) {
+        advance(static_cast<size_t>(bytes_written));
+    }
+    return bytes_written;
+}
@@ -0,0 +1,52 @@
+#ifndef IOVEC_LIST_H
+#define IOVEC_LIST_H
+
+#include <sys/uio.h>              // 用于struct iovec和writev
+#include <vector>                 // 用于存储iovec数组
+#include <cstddef>                // 用于size_t
+
+// 分散/聚集写列表：把多段内存（如多条回射报文的报文头和数据）聚合成一次writev
+// 说明：列表只引用外部内存，不拷贝数据；调用方需保证写出完成前这些内存保持有效。
+//       部分写出时按已写字节数推进iovec，下次从中断位置继续
+class IovecList
+{
+private:
+    std::vector<struct iovec> iovs;  // iovec数组（预留容量后复用，热路径不分配内存）
+    size_t head;                     // 第一个未写完的iovec下标
+    size_t pending;                  // 未写出的总字节数
+
+    // 按已写出的字节数推进iovec（跳过写完的段，修正写了一半的段）
+    // 参数：bytes - 本次写出的字节数
+    void advance(size_t bytes);
+
+public:
+    // 构造函数：预留iovec容量
+    // 参数：capacity - 预留的iovec数量
+    explicit IovecList(size_t capacity = 0);
+
+    // 追加一段待写内存（长度为0时忽略）
+    // 参数：
+    //   base - 内存起始地址
+    //   len - 内存长度
+    void push(const void* base, size_t len);
+
+    // 是否已全部写出
+    bool empty() const { return pending == 0; }
+
+    // 未写出的总字节数
+    size_t bytes() const { return pending; }
+
+    // 当前列表中的iovec段数（含已写完的段）
+    size_t count() const { return iovs.size(); }
+
+    // 清空列表（保留容量）
+    void clear();
+
+    // 调用一次writev写出尽可能多的数据，并推进游标
+    // 说明：单次最多提交IOV_MAX段，超出部分由下次调用继续
+    // 参数：fd - 目标文件描述符
+    // 返回：写出的字节数，失败返回-1（errno由writev设置）
+    ssize_t write_to(int fd);
+};
+
+#endif // IOVEC_LIST_H
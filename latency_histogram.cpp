@@ -0,0 +1,76 @@
+#include "latency_histogram.h"
+#include <algorithm>          // 用于std::min/std::fill
+#include <cmath>              // 用于std::ceil
+
+const int LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t LatencyHistogram::SUB_BUCKETS;
+const int LatencyHistogram::MAX_VALUE_BITS;
+
+// 构造函数：按可记录的最大值一次性分配所有桶
+LatencyHistogram::LatencyHistogram()
+    : counts(bucket_index((1ull << MAX_VALUE_BITS) - 1) + 1, 0), total(0), min_value(UINT64_MAX),
+      max_value(0), sum(0) {}
+
+// 值对应的桶下标
+// 说明：value < SUB_BUCKETS时直接对应；否则取最高SUB_BUCKET_BITS位作为段内位置，
+//       第e段（e >= 1）覆盖下标[(e+1)*SUB_BUCKETS/2, (e+2)*SUB_BUCKETS/2)
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BUCKET_BITS + 1;
+    return static_cast<size_t>(shift) * (SUB_BUCKETS / 2) + static_cast<size_t>(value >> shift);
+}
+
+// 桶内的最大值
+uint64_t LatencyHistogram::bucket_upper(size_t index) {
+    if (index < SUB_BUCKETS) return index;
+    uint64_t shift = index / (SUB_BUCKETS / 2) - 1;
+    uint64_t mantissa = index - shift * (SUB_BUCKETS / 2);
+    return (mantissa << shift) + (1ull << shift) - 1;
+}
+
+// 记录一个值
+void LatencyHistogram::record(uint64_t value) {
+    size_t index = std::min(bucket_index(value), counts.size() - 1);
+    counts[index]++;
+    total++;
+    sum += static_cast<double>(value);
+    if (value < min_value) min_value = value;
+    if (value > max_value) max_value = value;
+}
+
+// 把另一个直方图的计数累加到本直方图
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.total == 0) return;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    if (other.min_value < min_value) min_value = other.min_value;
+    if (other.max_value > max_value) max_value = other.max_value;
+}
+
+// 清空所有计数
+void LatencyHistogram::reset() {
+    if (total == 0) return;
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+    sum = 0;
+}
+
+// 计算分位数
+// 说明：最大值所在桶的上界可能超过实际最大值，此时返回实际最大值
+uint64_t LatencyHistogram::value_at_percentile(double percentile) const {
+    if (total == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total));
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= target) return std::min(bucket_upper(i), max_value);
+    }
+    return max_value;
+}
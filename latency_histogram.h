@@ -0,0 +1,56 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>                 // 用于桶计数
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint64_t
+
+// 延迟直方图（HDR风格的对数-线性分桶）
+// 说明：值（纳秒）按最高有效位分段，每段再线性分成SUB_BUCKETS/2个桶，
+//       相对误差不超过1/(SUB_BUCKETS/2)（约0.8%），可覆盖1ns到约18分钟；
+//       记录只做一次位运算和一次加法，不分配内存。每个线程各用一个实例，
+//       结束时（或周期报告时）合并，自身不加锁
+class LatencyHistogram
+{
+private:
+    static const int SUB_BUCKET_BITS = 8;                       // 每段线性桶数的位数
+    static const uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS; // 第0段的桶数（之后每段SUB_BUCKETS/2个）
+    static const int MAX_VALUE_BITS = 40;                        // 可记录的最大值位数（超出部分计入最后一个桶）
+
+    std::vector<uint64_t> counts;     // 各桶计数
+    uint64_t total;                   // 记录总数
+    uint64_t min_value;               // 最小值
+    uint64_t max_value;               // 最大值
+    double sum;                       // 所有值之和（用于平均值）
+
+    // 值对应的桶下标
+    static size_t bucket_index(uint64_t value);
+
+    // 桶内的最大值（报告分位数时使用，保证不低估）
+    static uint64_t bucket_upper(size_t index);
+
+public:
+    LatencyHistogram();
+
+    // 记录一个值
+    // 参数：value - 延迟（纳秒）
+    void record(uint64_t value);
+
+    // 把另一个直方图的计数累加到本直方图
+    void merge(const LatencyHistogram& other);
+
+    // 清空所有计数
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? sum / total : 0; }
+
+    // 计算分位数
+    // 参数：percentile - 百分位（0~100，如99.9）
+    // 返回：不小于该比例样本的最小桶上界（纳秒），没有样本时返回0
+    uint64_t value_at_percentile(double percentile) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,849 @@
+#include "load_worker.h"
+#include "crc32c.h"           // 用于v2报文头校验
+#include <sys/socket.h>       // 用于socket相关系统调用
+#include <sys/epoll.h>        // 用于epoll
+#include <sys/timerfd.h>      // 用于按计划发送时刻唤醒
+#include <netinet/in.h>       // 用于网络地址结构
+#include <netinet/tcp.h>      // 用于TCP_NODELAY
+#include <sys/un.h>           // 用于Unix域地址结构（sockaddr_un）
+#include <arpa/inet.h>        // 用于IP地址转换
+#include <unistd.h>           // 用于close/read
+#include <errno.h>            // 用于错误码
+#include <algorithm>          // 用于std::max
+#include <cmath>              // 用于计算发送间隔
+#include <cstring>            // 用于内存操作
+#include <ctime>              // 用于clock_gettime
+
+namespace {
+
+const int MAX_EVENTS = 256;                             // 单次epoll_wait最多处理的事件数
+const int POLL_TIMEOUT_MS = 100;                        // epoll_wait超时（用于检查连接/回射等待超时）
+const uint64_t CONNECT_TIMEOUT_NS = 5000000000ull;      // 连接阶段超时（5秒）
+const uint64_t DRAIN_TIMEOUT_NS = 5000000000ull;        // 停止发送后等待在途回射的超时（5秒）
+const size_t RX_CHUNK = 65536;                          // 每次recv的最小可用空间
+const uint64_t TIMER_TOKEN = UINT64_MAX;                // 定时器在epoll中的标识（连接用下标标识）
+const uint64_t SHM_TOKEN_BIT = 1ull << 62;              // 共享内存通道eventfd的标识位（低位为连接下标）
+const uint64_t PUBLISH_INTERVAL_NS = 100000000ull;      // 向主线程发布周期统计的间隔（100毫秒）
+const uint64_t CONNECT_CHECK_NS = 100000000ull;         // 检查connect超时的间隔（100毫秒）
+const double RAMP_MIN_FRACTION = 0.01;                  // 速率爬升的起始比例（避免起点的间隔无限大）
+
+// 单调时钟纳秒数（与timerfd的CLOCK_MONOTONIC一致）
+uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} // namespace
+
+// 构造函数：初始化配置并计算本线程的发送间隔
+// 说明：总速率和连接更替速率在各线程间平均分配，每个线程独立产生到达时刻；
+//       连接下标[0, slow_count)为慢读连接，[connection_count, connection_count + idle_count)为空闲连接
+LoadWorker::LoadWorker(int id, const ClientConfig& cfg, int connection_count, int idle_count, int slow_count)
+    : id(id), config(cfg), epoll_fd(-1), timer_fd(-1), conns(connection_count + idle_count),
+      header_len(cfg.protocol == 2 ? sizeof(MessageHeaderV2) : sizeof(MessageHeader)), server_addr_len(0),
+      open_loop(cfg.rate > 0), max_inflight(cfg.window > 0 ? cfg.window : (cfg.rate > 0 ? SIZE_MAX : 1)),
+      interval_ns(0), rng(std::random_device{}() + id), exp_dist(1.0),
+      next_arrival(0), end_time(0), drain_deadline(0), last_progress(0), begin_time(0), ramp_ns(cfg.ramp_up * 1e9),
+      churn_interval_ns(0), next_churn(0), churn_next(0),
+      read_pause_ns(static_cast<uint64_t>(cfg.read_pause_ms) * 1000000ull), next_connect_check(0),
+      rr_next(0), started(false), schedule_done(false), pending_connects(0), outstanding(0), last_publish(0),
+      running(false) {
+    if (open_loop) {
+        interval_ns = 1e9 * cfg.threads / cfg.rate;
+    }
+    if (cfg.churn_rate > 0) {
+        churn_interval_ns = 1e9 * cfg.threads / cfg.churn_rate;
+    }
+
+    // 消息大小：未指定分布时只有message_size一种
+    std::vector<double> weights;
+    if (cfg.size_mix.empty()) {
+        sizes.push_back(static_cast<uint32_t>(cfg.message_size) * cfg.batch);
+        weights.push_back(1);
+    }
+    for (const MessageSizeWeight& entry : cfg.size_mix) {
+        sizes.push_back(static_cast<uint32_t>(entry.size) * cfg.batch);
+        weights.push_back(entry.weight);
+    }
+    size_dist = std::discrete_distribution<size_t>(weights.begin(), weights.end());
+    payload.assign(*std::max_element(sizes.begin(), sizes.end()), 'a');
+    memset(&server_addr, 0, sizeof(server_addr));
+
+    for (int i = 0; i < slow_count && i < connection_count; ++i) {
+        conns[i].slow = true;
+        slow_conns.push_back(&conns[i]);
+    }
+    for (size_t i = connection_count; i < conns.size(); ++i) {
+        conns[i].idle = true;
+    }
+}
+
+// 析构函数：等待线程结束并关闭所有描述符
+LoadWorker::~LoadWorker() {
+    join();
+    for (auto& conn : conns) {
+        if (conn.fd != -1) close(conn.fd);
+    }
+    if (timer_fd != -1) close(timer_fd);
+    if (epoll_fd != -1) close(epoll_fd);
+}
+
+// 启动事件循环线程
+void LoadWorker::start() {
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&LoadWorker::run, this);
+}
+
+// 等待事件循环线程结束
+void LoadWorker::join() {
+    if (thread.joinable()) thread.join();
+}
+
+// 发起本线程所有连接的非阻塞connect
+// 说明：connect完成由EPOLLOUT通知，全部完成（或失败/超时）后才开始发送，
+//       避免建连耗时被计入第一批消息的延迟；Unix域套接字的connect立即完成（同样经EPOLLOUT确认）
+void LoadWorker::open_connections() {
+    if (config.shm_path.empty() && !resolve_server()) {
+        stats.add(CLIENT_ERRORS, conns.size());
+        return;
+    }
+    for (size_t i = 0; i < conns.size(); ++i) {
+        open_connection(conns[i], i);
+    }
+}
+
+// 解析服务端地址（TCP或Unix域）
+// 返回：true成功，false地址非法
+bool LoadWorker::resolve_server() {
+    if (!config.unix_path.empty()) {
+        struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&server_addr);
+        if (config.unix_path.size() >= sizeof(un->sun_path)) {
+            LOG_ERROR("[Loader %d] Unix socket path too long", id);
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        memcpy(un->sun_path, config.unix_path.c_str(), config.unix_path.size());
+        server_addr_len = sizeof(struct sockaddr_un);
+        return true;
+    }
+    struct sockaddr_in* in = reinterpret_cast<struct sockaddr_in*>(&server_addr);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(config.server_port);
+    if (inet_pton(AF_INET, config.server_ip.c_str(), &in->sin_addr) <= 0) {
+        LOG_ERROR("[Loader %d] Invalid server IP", id);
+        return false;
+    }
+    server_addr_len = sizeof(struct sockaddr_in);
+    return true;
+}
+
+// 建立一个连接：发起非阻塞connect，或建立共享内存通道
+// 参数：
+//   conn - 连接
+//   index - 连接下标
+// 返回：true成功发起，false失败
+bool LoadWorker::open_connection(LoadConnection& conn, size_t index) {
+    if (!config.shm_path.empty()) return open_shm(conn, index);
+
+    int fd = socket(server_addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR_RL("[Loader %d] Socket creation failed (errno: %d)", id, errno);
+        stats.add(CLIENT_ERRORS);
+        return false;
+    }
+    // 关闭Nagle算法：开环模式下同一连接上会连续发出小报文，不能等待前一条的ACK
+    if (server_addr.ss_family == AF_INET) {
+        int opt = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    }
+
+    if (connect(fd, (struct sockaddr*)&server_addr, server_addr_len) == -1 && errno != EINPROGRESS) {
+        LOG_ERROR_RL("[Loader %d] Connect failed (errno: %d)", id, errno);
+        close(fd);
+        stats.add(CLIENT_ERRORS);
+        return false;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = index;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        LOG_ERROR_RL("[Loader %d] epoll_ctl failed (errno: %d)", id, errno);
+        close(fd);
+        stats.add(CLIENT_ERRORS);
+        return false;
+    }
+    conn.fd = fd;
+    conn.want_write = true;
+    conn.connect_deadline = monotonic_ns() + CONNECT_TIMEOUT_NS;
+    conn.rx.resize(std::max(RX_CHUNK, 2 * (header_len + payload.size())));
+    pending_connects++;
+    return true;
+}
+
+// 连接更替：关闭连接并立即重连
+// 说明：新连接沿用原来的下标和已发消息数（-m按连接槽位计），闭环模式下建立后重新填满窗口
+// 参数：conn - 连接
+void LoadWorker::reconnect(LoadConnection& conn) {
+    LOG_DEBUG("[Loader %d] Churning connection fd %d", id, conn.fd);
+    close(conn.fd);  // 内核会自动将其从epoll中移除
+    conn.fd = -1;
+    conn.shm.reset();
+    conn.connected = false;
+    conn.want_write = false;
+    conn.peer_closed = false;
+    conn.read_paused = false;
+    conn.retiring = false;
+    conn.tx.clear();
+    conn.tx_off = 0;
+    conn.rx_len = 0;
+    stats.add(CLIENT_RECONNECTS);
+    if (open_connection(conn, static_cast<size_t>(&conn - conns.data())) && conn.connected) {
+        fill_window(conn, monotonic_ns());  // 共享内存通道建立即可用
+        flush_pending();
+    }
+}
+
+// 按更替速率选出到期的连接
+// 说明：更替间隔固定，轮转选择连接；在途消息取完（handle_read）后才关闭，
+//       计时的回射不会因更替而丢失。事件循环醒来晚了就一次更替所有到期的连接
+// 参数：now - 当前时刻
+void LoadWorker::churn(uint64_t now) {
+    while (next_churn <= now) {
+        next_churn += static_cast<uint64_t>(churn_interval_ns);
+        LoadConnection* victim = nullptr;
+        for (size_t tried = 0; tried < conns.size() && victim == nullptr; ++tried) {
+            LoadConnection& conn = conns[churn_next];
+            churn_next = (churn_next + 1) % conns.size();
+            if (conn.fd != -1 && conn.connected && !conn.retiring) victim = &conn;
+        }
+        if (victim == nullptr) {  // 所有连接都在更替中：跳过积压的更替
+            next_churn = now + static_cast<uint64_t>(churn_interval_ns);
+            return;
+        }
+        victim->retiring = true;
+        if (victim->inflight.empty()) reconnect(*victim);
+    }
+}
+
+// 是否仍在按速率更替连接（停止发送后不再更替）
+// 参数：now - 当前时刻
+bool LoadWorker::churning(uint64_t now) const {
+    return started && churn_interval_ns > 0 && !schedule_done && (end_time == 0 || now < end_time);
+}
+
+// 放弃超过截止时刻仍未完成的connect（每CONNECT_CHECK_NS检查一次）
+// 参数：now - 当前时刻
+void LoadWorker::check_connect_timeouts(uint64_t now) {
+    if (now < next_connect_check) return;
+    next_connect_check = now + CONNECT_CHECK_NS;
+    for (auto& conn : conns) {
+        if (conn.fd != -1 && !conn.connected && now >= conn.connect_deadline) {
+            fail_connection(conn, "connect timeout");
+            pending_connects--;
+        }
+    }
+}
+
+// 闭环模式：填满连接的发送窗口
+// 参数：
+//   conn - 连接
+//   now - 当前时刻
+void LoadWorker::fill_window(LoadConnection& conn, uint64_t now) {
+    if (!started || open_loop) return;
+    while (conn.fd != -1 && can_issue(conn) && conn.inflight.size() < max_inflight &&
+           (end_time == 0 || now < end_time)) {
+        send_message(conn, now);
+    }
+}
+
+// 建立一个共享内存通道并注册到epoll
+// 说明：Unix域连接用连接下标标识（服务端关闭时可读），通道的eventfd用下标加SHM_TOKEN_BIT标识
+// 参数：
+//   conn - 连接
+//   index - 连接下标
+// 返回：true成功，false失败
+bool LoadWorker::open_shm(LoadConnection& conn, size_t index) {
+    conn.shm.reset(new ShmChannel());
+    int fd;
+    if (!conn.shm->connect(config.shm_path, fd)) {
+        conn.shm.reset();
+        stats.add(CLIENT_ERRORS);
+        return false;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = index;
+    bool ok = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    ev.data.u64 = index | SHM_TOKEN_BIT;
+    ok = ok && epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn.shm->wait_event_fd(), &ev) == 0;
+    if (!ok) {
+        LOG_ERROR_RL("[Loader %d] epoll_ctl failed (errno: %d)", id, errno);
+        close(fd);
+        conn.shm.reset();
+        stats.add(CLIENT_ERRORS);
+        return false;
+    }
+    conn.fd = fd;
+    conn.connected = true;
+    conn.rx.resize(std::max(RX_CHUNK, 2 * (header_len + payload.size())));
+    stats.add(CLIENT_CONNECTIONS);
+    return true;
+}
+
+// 事件循环：建立连接、按计划发送并处理回射
+// 说明：发送时刻由timerfd按绝对时间唤醒（精度不受epoll_wait毫秒超时限制）；
+//       唤醒晚了就把所有已到期的消息一次补发，计划时刻不顺延
+void LoadWorker::run() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epoll_fd == -1 || timer_fd == -1) {
+        LOG_ERROR("[Loader %d] epoll/timerfd creation failed (errno: %d)", id, errno);
+        stats.add(CLIENT_ERRORS, conns.size());
+        running.store(false, std::memory_order_release);
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = TIMER_TOKEN;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+
+    open_connections();
+
+    struct epoll_event events[MAX_EVENTS];
+    while (true) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, poll_timeout(monotonic_ns()));
+        if (n == -1 && errno != EINTR) {
+            LOG_ERROR("[Loader %d] epoll_wait failed (errno: %d)", id, errno);
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == TIMER_TOKEN) {
+                uint64_t expirations;
+                ssize_t ret = read(timer_fd, &expirations, sizeof(expirations));
+                (void)ret;
+                continue;
+            }
+            if (events[i].data.u64 & SHM_TOKEN_BIT) {  // 服务端推进了共享内存通道
+                LoadConnection& conn = conns[events[i].data.u64 & ~SHM_TOKEN_BIT];
+                if (conn.fd != -1) handle_shm_event(conn);
+                continue;
+            }
+            LoadConnection& conn = conns[events[i].data.u64];
+            if (conn.fd != -1) handle_event(conn, events[i].events);
+        }
+
+        // 慢读连接恢复读取时收到的回射会更新last_progress，须先于取当前时刻处理
+        if (!slow_conns.empty()) resume_readers(monotonic_ns());
+        uint64_t now = monotonic_ns();
+        if (pending_connects > 0) check_connect_timeouts(now);  // 包括更替后的重连
+        if (!started && pending_connects == 0) begin(now);
+        if (started && open_loop && !schedule_done) issue_due(now);
+        if (churning(now)) churn(now);
+        if (started && now - last_publish >= PUBLISH_INTERVAL_NS) publish_window();
+        if (started && finished(now)) break;
+    }
+    publish_window();
+
+    // 关闭所有连接
+    for (auto& conn : conns) {
+        if (conn.fd != -1) {
+            close(conn.fd);
+            conn.fd = -1;
+        }
+    }
+    running.store(false, std::memory_order_release);
+}
+
+// 处理一个连接上的epoll事件
+void LoadWorker::handle_event(LoadConnection& conn, uint32_t events) {
+    if (conn.shm) {  // 共享内存传输的Unix域连接可读：服务端已关闭通道，取完回射后关闭
+        char byte;
+        if (recv(conn.fd, &byte, sizeof(byte), MSG_DONTWAIT) == -1 && errno == EAGAIN) return;
+        conn.peer_closed = true;
+        if (!conn.read_paused) handle_read(conn);  // 慢读连接在恢复读取时取走剩余的回射
+        return;
+    }
+    if (!conn.connected) {
+        if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) return;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        pending_connects--;
+        if (err != 0) {
+            fail_connection(conn, strerror(err));
+            return;
+        }
+        conn.connected = true;
+        stats.add(CLIENT_CONNECTIONS);
+        update_events(conn, false);
+        fill_window(conn, monotonic_ns());  // 更替后的重连：闭环模式重新填满窗口
+        flush_pending();
+        return;
+    }
+
+    if (events & EPOLLIN) {
+        if (!handle_read(conn)) return;
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        if (!(events & EPOLLIN)) fail_connection(conn, "socket error");
+        return;
+    }
+    if ((events & EPOLLOUT) && conn.fd != -1) {
+        flush_output(conn);
+    }
+}
+
+// 处理共享内存通道的唤醒：清空eventfd计数，取走回射并继续写出积压的发送队列
+void LoadWorker::handle_shm_event(LoadConnection& conn) {
+    uint64_t count;
+    ssize_t ret = read(conn.shm->wait_event_fd(), &count, sizeof(count));
+    (void)ret;
+    if (!conn.read_paused && !handle_read(conn)) return;
+    if (conn.fd != -1 && conn.want_write) flush_output(conn);
+}
+
+// 从连接读取数据
+// 说明：共享内存通道为空时先置位等待标志再检查一次，之后服务端写入回射会写eventfd唤醒本线程
+// 返回：读到的字节数；0表示服务端已关闭；-1表示出错或暂无数据
+ssize_t LoadWorker::receive(LoadConnection& conn, char* buf, size_t len) {
+    if (!conn.shm) return recv(conn.fd, buf, len, 0);
+    ShmRing& rx = conn.shm->rx_ring();
+    size_t n = rx.readable();
+    if (n == 0) {
+        conn.shm->prepare_wait();
+        n = rx.readable();
+    }
+    if (n == 0) {
+        if (conn.peer_closed) return 0;
+        errno = EAGAIN;
+        return -1;
+    }
+    n = std::min(n, len);
+    memcpy(buf, rx.read_ptr(), n);
+    rx.consume(n);
+    conn.shm->notify_peer();  // 服务端可能因回射环已满而在等待
+    return static_cast<ssize_t>(n);
+}
+
+// 向连接写出数据
+// 说明：共享内存请求环已满时先置位等待标志再检查一次，服务端取走请求腾出空间后唤醒本线程；
+//       写入请求后本线程要等待回射，同样需要置位等待标志
+// 返回：写出的字节数；-1表示出错或暂时写不下
+ssize_t LoadWorker::transmit(LoadConnection& conn, const char* data, size_t len) {
+    if (!conn.shm) return send(conn.fd, data, len, MSG_NOSIGNAL);
+    if (conn.peer_closed) {
+        errno = EPIPE;
+        return -1;
+    }
+    ShmRing& tx = conn.shm->tx_ring();
+    size_t n = tx.writable();
+    if (n == 0) {
+        conn.shm->prepare_wait();
+        n = tx.writable();
+    }
+    if (n == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    n = std::min(n, len);
+    memcpy(tx.write_ptr(), data, n);
+    conn.shm->prepare_wait();  // 先于推进写位置置位：服务端看到这批请求时一定也看到标志，回射会唤醒本线程
+    tx.produce(n);
+    conn.shm->notify_peer();
+    return static_cast<ssize_t>(n);
+}
+
+// 连接阶段结束，开始发送
+void LoadWorker::begin(uint64_t now) {
+    started = true;
+    begin_time = now;
+    last_progress = now;
+    last_publish = now;
+    next_churn = now + static_cast<uint64_t>(churn_interval_ns);
+    if (config.duration > 0) {
+        end_time = now + static_cast<uint64_t>(config.duration) * 1000000000ull;
+    }
+    LOG_INFO("[Loader %d] %llu/%zu connections established, start sending", id,
+             static_cast<unsigned long long>(stats.get(CLIENT_CONNECTIONS)), conns.size());
+
+    if (open_loop) {
+        next_arrival = now;
+        return;
+    }
+    // 闭环模式：每个连接先填满窗口，之后每收到一条回射补发一条
+    for (auto& conn : conns) {
+        fill_window(conn, now);
+    }
+    flush_pending();
+}
+
+// 开环模式：发出所有计划时刻已到的消息并重设定时器
+void LoadWorker::issue_due(uint64_t now) {
+    while (next_arrival <= now) {
+        if (end_time != 0 && next_arrival >= end_time) {
+            schedule_done = true;
+            break;
+        }
+        LoadConnection* conn = pick_connection();
+        if (conn == nullptr) {
+            // 所有连接的窗口都已满时积压到期的消息，收到回射后由refill补发（计划时刻不变）；
+            // 所有连接都已发完或已关闭时停止发送
+            bool any = false;
+            for (auto& c : conns) any = any || may_issue(c);
+            if (!any) schedule_done = true;
+            break;
+        }
+        send_message(*conn, next_arrival);
+        advance_arrival();
+    }
+    flush_pending();
+
+    if (schedule_done) {
+        drain_deadline = now + DRAIN_TIMEOUT_NS;
+        return;
+    }
+    if (next_arrival > now) arm_timer();
+}
+
+// 开环模式：连接收到回射腾出窗口后，补发积压的到期消息
+void LoadWorker::refill(LoadConnection& conn, uint64_t now) {
+    bool backlogged = next_arrival <= now;
+    while (!schedule_done && next_arrival <= now && conn.fd != -1 && can_issue(conn) &&
+           conn.inflight.size() < max_inflight) {
+        if (end_time != 0 && next_arrival >= end_time) break;  // 由issue_due结束发送
+        send_message(conn, next_arrival);
+        advance_arrival();
+    }
+    if (backlogged && !schedule_done && next_arrival > now) arm_timer();
+}
+
+// 按下一条消息的计划发送时刻设置定时器
+void LoadWorker::arm_timer() {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = static_cast<time_t>(next_arrival / 1000000000ull);
+    its.it_value.tv_nsec = static_cast<long>(next_arrival % 1000000000ull);
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &its, nullptr);
+}
+
+// 计算下一条消息的计划发送时刻
+// 说明：速率爬升期间按当前时刻的目标速率（rate乘以已爬升的比例）放大间隔
+void LoadWorker::advance_arrival() {
+    double gap = interval_ns;
+    if (config.arrival == ArrivalProcess::POISSON) {
+        gap *= exp_dist(rng);
+    }
+    if (ramp_ns > 0) {
+        double progress = (next_arrival - begin_time) / ramp_ns;
+        if (progress < 1) gap /= std::max(progress, RAMP_MIN_FRACTION);
+    }
+    next_arrival += static_cast<uint64_t>(std::llround(gap));
+}
+
+// 连接是否还能继续发送消息（限时运行时不限条数；空闲连接和等待更替的连接不发送）
+bool LoadWorker::can_issue(const LoadConnection& conn) const {
+    return conn.connected && !conn.idle && !conn.retiring &&
+           (config.duration > 0 || conn.issued < config.messages_per_conn);
+}
+
+// 连接之后是否还可能发送消息：等待更替或正在重连的连接重连后还会继续发送
+bool LoadWorker::may_issue(const LoadConnection& conn) const {
+    if (conn.fd == -1 || conn.idle) return false;
+    return conn.retiring || !conn.connected || can_issue(conn);
+}
+
+// 轮转选出下一条开环消息的连接
+LoadConnection* LoadWorker::pick_connection() {
+    for (size_t tried = 0; tried < conns.size(); ++tried) {
+        LoadConnection& conn = conns[rr_next];
+        rr_next = (rr_next + 1) % conns.size();
+        if (conn.fd != -1 && can_issue(conn) && conn.inflight.size() < max_inflight) return &conn;
+    }
+    return nullptr;
+}
+
+// 把一条消息（v2批量时为一个报文的batch条子消息）追加到连接的发送队列并尝试写出
+// 说明：指定了消息大小分布时每个报文按权重随机选取数据长度
+void LoadWorker::send_message(LoadConnection& conn, uint64_t intended) {
+    uint32_t data_len = sizes.size() == 1 ? sizes[0] : sizes[size_dist(rng)];
+    LOG_DEBUG("[Loader %d] Sending msg_id=%u (%u bytes) on fd %d", id, conn.next_msg_id, data_len, conn.fd);
+    if (config.protocol == 2) {
+        MessageHeaderV2 header;
+        header.magic = htonl(MAGIC_NUMBER_V2);
+        header.data_len = htonl(data_len);
+        header.msg_id = htonl(conn.next_msg_id);
+        header.count = htons(static_cast<uint16_t>(config.batch));
+        header.flags = 0;
+        header.header_crc = htonl(crc32c(&header, HEADER_V2_CRC_BYTES));
+        const char* hdr = reinterpret_cast<const char*>(&header);
+        conn.tx.insert(conn.tx.end(), hdr, hdr + sizeof(header));
+    } else {
+        MessageHeader header;
+        header.magic = htonl(MAGIC_NUMBER);
+        header.data_len = htonl(data_len);
+        header.msg_id = htonl(conn.next_msg_id);
+        const char* hdr = reinterpret_cast<const char*>(&header);
+        conn.tx.insert(conn.tx.end(), hdr, hdr + sizeof(header));
+    }
+    conn.tx.insert(conn.tx.end(), payload.begin(), payload.begin() + data_len);
+    conn.inflight.push_back(InFlightMessage{conn.next_msg_id, intended, data_len});
+    conn.next_msg_id += config.batch;
+    conn.issued += config.batch;
+    outstanding++;
+    stats.add(CLIENT_SENT, config.batch);
+
+    if (conn.want_write) return;  // 已注册EPOLLOUT时说明套接字不可写，等待可写再一起写出
+    if (!config.coalesce) {
+        flush_output(conn);
+    } else if (!conn.dirty) {  // 合并发送：本轮结束时由flush_pending一次写出
+        conn.dirty = true;
+        dirty.push_back(&conn);
+    }
+}
+
+// 合并发送：写出本轮追加过报文的连接
+void LoadWorker::flush_pending() {
+    for (LoadConnection* conn : dirty) {
+        conn->dirty = false;
+        if (conn->fd != -1) flush_output(*conn);
+    }
+    dirty.clear();
+}
+
+// 写出发送队列，写不完时注册EPOLLOUT
+bool LoadWorker::flush_output(LoadConnection& conn) {
+    while (conn.tx_off < conn.tx.size()) {
+        ssize_t n = transmit(conn, conn.tx.data() + conn.tx_off, conn.tx.size() - conn.tx_off);
+        if (n > 0) {
+            conn.tx_off += n;
+            continue;
+        }
+        if (n == -1 && errno == EINTR) continue;
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 丢弃已写出的前缀，避免发送队列在持续积压时无限增长
+            if (conn.tx_off > conn.tx.size() / 2) {
+                conn.tx.erase(conn.tx.begin(), conn.tx.begin() + conn.tx_off);
+                conn.tx_off = 0;
+            }
+            update_events(conn, true);
+            return true;
+        }
+        LOG_ERROR_RL("[Loader %d] Send failed on fd %d (errno: %d)", id, conn.fd, errno);
+        fail_connection(conn, "send failed");
+        return false;
+    }
+    conn.tx.clear();
+    conn.tx_off = 0;
+    update_events(conn, false);
+    return true;
+}
+
+// 读取并校验回射
+// 说明：逐条校验魔数、长度和数据内容，按消息ID匹配在途消息，
+//       延迟为收到完整回射的时刻减去该消息的计划发送时刻。
+//       慢读连接每次只读一段就暂停读取；等待更替的连接取完在途回射后立即重连
+bool LoadWorker::handle_read(LoadConnection& conn) {
+    while (true) {
+        if (conn.rx.size() - conn.rx_len < RX_CHUNK) {
+            conn.rx.resize(conn.rx_len + RX_CHUNK);
+        }
+        ssize_t n = receive(conn, conn.rx.data() + conn.rx_len, conn.rx.size() - conn.rx_len);
+        if (n == 0) {
+            if (!conn.inflight.empty() || can_issue(conn)) {
+                fail_connection(conn, "server disconnected");
+                return false;
+            }
+            close(conn.fd);
+            conn.fd = -1;
+            return false;
+        }
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            LOG_ERROR_RL("[Loader %d] Recv failed on fd %d (errno: %d)", id, conn.fd, errno);
+            fail_connection(conn, "recv failed");
+            return false;
+        }
+        conn.rx_len += n;
+
+        // 逐条处理完整的回射
+        uint64_t now = monotonic_ns();
+        size_t pos = 0;
+        while (conn.rx_len - pos >= header_len) {
+            const char* frame = conn.rx.data() + pos;
+            const char* data = frame + header_len;
+            uint32_t msg_id;
+            uint32_t data_len;
+            if (!check_echo_header(frame, msg_id, data_len)) {
+                fail_connection(conn, "invalid echo header");
+                return false;
+            }
+            if (conn.rx_len - pos < header_len + data_len) break;  // 回射尚未收全
+            // 按msg_id匹配在途消息（服务端按序回射时总是匹配队首）
+            auto it = conn.inflight.begin();
+            while (it != conn.inflight.end() && it->msg_id != msg_id) ++it;
+            if (it == conn.inflight.end()) {
+                fail_connection(conn, "unexpected msg_id");
+                return false;
+            }
+            if (it->data_len != data_len || memcmp(data, payload.data(), data_len) != 0) {
+                fail_connection(conn, "data mismatch");
+                return false;
+            }
+            LOG_DEBUG("[Loader %d] Received msg_id=%u on fd %d", id, msg_id, conn.fd);
+            for (int i = 0; i < config.batch; ++i) {  // 批量报文中的每条子消息延迟相同
+                histogram.record(now - it->intended);
+                window.record(now - it->intended);
+            }
+            last_progress = now;
+            conn.inflight.erase(it);
+            outstanding--;
+            stats.add(CLIENT_RECEIVED, config.batch);
+            stats.add(CLIENT_BYTES, header_len + data_len);
+            pos += header_len + data_len;
+
+            // 闭环模式：收到回射后立即补发，保持窗口内的在途消息数
+            if (!open_loop) {
+                fill_window(conn, now);
+                if (conn.fd == -1) return false;
+            } else {
+                refill(conn, now);
+                if (conn.fd == -1) return false;
+            }
+        }
+        flush_pending();
+        if (conn.fd == -1) return false;
+        if (pos > 0) {
+            memmove(conn.rx.data(), conn.rx.data() + pos, conn.rx_len - pos);
+            conn.rx_len -= pos;
+        }
+        if (conn.slow) {
+            pause_reading(conn, now);
+            break;
+        }
+    }
+    if (conn.retiring && conn.inflight.empty()) {
+        reconnect(conn);
+        return false;
+    }
+    return true;
+}
+
+// 校验回射的报文头：版本和子消息数与发送时一致，长度不超过最大的消息，v2报文头的CRC32C正确
+// 说明：长度与对应在途消息是否一致在匹配msg_id后检查
+// 参数：
+//   frame - 报文起始地址（不要求对齐）
+//   msg_id - 输出参数，（第一条子）消息ID
+//   data_len - 输出参数，数据部分长度
+// 返回：true合法，false非法
+bool LoadWorker::check_echo_header(const char* frame, uint32_t& msg_id, uint32_t& data_len) const {
+    if (config.protocol == 2) {
+        MessageHeaderV2 header;
+        memcpy(&header, frame, sizeof(header));
+        msg_id = ntohl(header.msg_id);
+        data_len = ntohl(header.data_len);
+        return ntohl(header.magic) == MAGIC_NUMBER_V2 && data_len <= payload.size() &&
+               ntohs(header.count) == config.batch && header.flags == 0 &&
+               ntohl(header.header_crc) == crc32c(frame, HEADER_V2_CRC_BYTES);
+    }
+    MessageHeader header;
+    memcpy(&header, frame, sizeof(header));
+    msg_id = ntohl(header.msg_id);
+    data_len = ntohl(header.data_len);
+    return ntohl(header.magic) == MAGIC_NUMBER && data_len <= payload.size();
+}
+
+// 更新连接关注的epoll事件（仅在状态变化时调用epoll_ctl）
+// 说明：共享内存连接的可写通知来自通道的eventfd，只记录状态
+void LoadWorker::update_events(LoadConnection& conn, bool want_write) {
+    if (conn.want_write == want_write) return;
+    conn.want_write = want_write;
+    if (!conn.shm) apply_events(conn);
+}
+
+// 按连接当前的状态重新设置关注的epoll事件（暂停读取的慢读连接不关注EPOLLIN）
+void LoadWorker::apply_events(LoadConnection& conn) {
+    struct epoll_event ev;
+    ev.events = (conn.read_paused ? 0 : EPOLLIN) | (conn.want_write ? EPOLLOUT : 0);
+    ev.data.u64 = static_cast<uint64_t>(&conn - conns.data());
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+// 慢读连接：暂停读取
+// 说明：套接字连接不再关注EPOLLIN，回射积压在内核缓冲区中，服务端的发送随之受阻；
+//       共享内存连接在暂停期间忽略通道的唤醒，回射积压在回射环中
+void LoadWorker::pause_reading(LoadConnection& conn, uint64_t now) {
+    conn.read_paused = true;
+    conn.read_resume = now + read_pause_ns;
+    if (!conn.shm) apply_events(conn);
+}
+
+// 恢复暂停已到期的慢读连接：重新关注EPOLLIN并立即读一次
+// （共享内存通道在暂停期间的唤醒已被忽略，不能等下一次唤醒）
+void LoadWorker::resume_readers(uint64_t now) {
+    for (LoadConnection* conn : slow_conns) {
+        if (!conn->read_paused || now < conn->read_resume) continue;
+        conn->read_paused = false;
+        if (conn->fd == -1) continue;
+        if (!conn->shm) apply_events(*conn);
+        if (handle_read(*conn) && conn->fd != -1 && conn->want_write) flush_output(*conn);
+    }
+}
+
+// 计算epoll_wait的超时
+int LoadWorker::poll_timeout(uint64_t now) const {
+    uint64_t deadline = now + POLL_TIMEOUT_MS * 1000000ull;
+    if (churning(now)) deadline = std::min(deadline, next_churn);
+    for (const LoadConnection* conn : slow_conns) {
+        if (conn->read_paused) deadline = std::min(deadline, conn->read_resume);
+    }
+    return deadline <= now ? 0 : static_cast<int>((deadline - now + 999999) / 1000000);
+}
+
+// 关闭出错的连接，其在途消息计为错误
+void LoadWorker::fail_connection(LoadConnection& conn, const char* reason) {
+    LOG_ERROR_RL("[Loader %d] Closing fd %d: %s (%zu messages in flight)", id, conn.fd, reason,
+                 conn.inflight.size());
+    stats.add(CLIENT_ERRORS, conn.inflight.empty() ? 1 : conn.inflight.size() * config.batch);
+    outstanding -= conn.inflight.size();
+    conn.inflight.clear();
+    close(conn.fd);
+    conn.fd = -1;
+}
+
+// 把window中的延迟发布给主线程
+// 说明：每PUBLISH_INTERVAL_NS最多一次，加锁开销不在逐条消息的路径上
+void LoadWorker::publish_window() {
+    last_publish = monotonic_ns();
+    std::lock_guard<std::mutex> lock(publish_mutex);
+    published.merge(window);
+    window.reset();
+}
+
+// 取走已发布的统计增量
+void LoadWorker::collect_interval(LatencyHistogram& out) {
+    std::lock_guard<std::mutex> lock(publish_mutex);
+    out.merge(published);
+    published.reset();
+}
+
+// 是否已全部完成
+// 说明：闭环模式下没有在途消息即表示所有连接都已发完；
+//       开环模式停止发送后最多再等待DRAIN_TIMEOUT_NS，仍未收到的回射计为错误；
+//       两种模式下连续DRAIN_TIMEOUT_NS收不到任何回射都视为服务端无响应而结束
+bool LoadWorker::finished(uint64_t now) {
+    if (outstanding == 0 && pending_connects == 0 && (!open_loop || schedule_done)) return true;
+    if (outstanding > 0 && now - last_progress >= DRAIN_TIMEOUT_NS) {  // 服务端停止响应
+        LOG_ERROR("[Loader %d] No echo received for %llus", id,
+                  static_cast<unsigned long long>(DRAIN_TIMEOUT_NS / 1000000000ull));
+    } else if (!schedule_done || now < drain_deadline) {
+        return false;
+    }
+    LOG_ERROR("[Loader %d] %llu echoes not received before timeout", id,
+              static_cast<unsigned long long>(outstanding));
+    stats.add(CLIENT_ERRORS, outstanding * config.batch);
+    outstanding = 0;
+    return true;
+}
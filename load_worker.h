@@ -0,0 +1,301 @@
+#ifndef LOAD_WORKER_H
+#define LOAD_WORKER_H
+
+#include "common.h"       // 包含公共常量、配置结构体和日志宏
+#include "latency_histogram.h"  // 包含延迟直方图
+#include "client_stats.h"      // 包含客户端统计计数块
+#include "shm_channel.h"       // 包含共享内存通道
+#include <sys/socket.h>   // 用于服务端地址（sockaddr_storage）
+#include <cstdint>        // 用于固定宽度整数类型
+#include <atomic>         // 用于运行状态标志
+#include <cstddef>        // 用于size_t
+#include <deque>          // 用于记录在途消息
+#include <memory>         // 用于共享内存通道
+#include <mutex>          // 用于保护周期报告的统计快照
+#include <random>         // 用于泊松到达间隔
+#include <string>         // 用于发送数据
+#include <thread>         // 用于事件循环线程
+#include <vector>         // 用于连接列表
+
+// 在途消息：用于按msg_id匹配回射
+struct InFlightMessage
+{
+    uint32_t msg_id;                  // 消息ID
+    uint64_t intended;                // 计划发送时刻（单调时钟纳秒，延迟的起点）
+    uint32_t data_len;                // 数据部分长度（消息大小按分布随机选取，回射须与之一致）
+};
+
+// 压测连接状态：一个非阻塞连接上的发送队列、接收缓冲区和在途消息
+// 说明：共享内存连接的fd为与服务端的Unix域连接（只用于发现服务端关闭），数据经shm收发
+struct LoadConnection
+{
+    int fd;                           // 套接字，-1表示已关闭
+    bool connected;                   // 非阻塞connect是否已完成
+    bool want_write;                  // 是否已注册EPOLLOUT（发送队列未写完）
+    bool dirty;                       // 本轮是否追加过报文、等待合并写出
+    std::vector<char> tx;             // 待写出的数据（开环模式下套接字不可写时在此排队，不推迟计划时间）
+    size_t tx_off;                    // tx中已写出的字节数
+    std::vector<char> rx;             // 接收缓冲区
+    size_t rx_len;                    // rx中的有效字节数
+    std::deque<InFlightMessage> inflight;  // 在途消息（按发送顺序）
+    uint32_t next_msg_id;             // 下一条发送消息的ID（v2批量报文占用batch个连续ID）
+    int issued;                       // 已发出的消息数
+    std::unique_ptr<ShmChannel> shm;  // 共享内存通道（仅共享内存传输）
+    bool peer_closed;                 // 共享内存传输：服务端已关闭通道（取完回射环中的数据后关闭连接）
+    bool idle;                        // 空闲连接：只建立连接，不发送消息
+    bool slow;                        // 慢读连接：每次读取后暂停读取一段时间
+    bool read_paused;                 // 慢读连接正在暂停读取
+    uint64_t read_resume;             // 恢复读取的时刻
+    bool retiring;                    // 连接更替：不再分配新消息，在途回射取完后关闭并重连
+    uint64_t connect_deadline;        // 非阻塞connect的截止时刻
+
+    LoadConnection()
+        : fd(-1), connected(false), want_write(false), dirty(false), tx_off(0), rx_len(0), next_msg_id(0),
+          issued(0), peer_closed(false), idle(false), slow(false), read_paused(false), read_resume(0),
+          retiring(false), connect_deadline(0) {}
+};
+
+// 事件驱动压测线程：单个epoll线程驱动多个非阻塞连接
+// 说明：开环模式（rate > 0）按固定速率产生发送时刻（固定间隔或泊松到达），
+//       到时即把报文追加到连接的发送队列，不等待之前的回射；延迟从计划发送时刻算起，
+//       服务端变慢导致的排队会计入延迟，避免"协调遗漏"（coordinated omission）。
+//       闭环模式（rate == 0）每个连接保持窗口内的在途消息数，收到回射即补发；
+//       开环模式下窗口满的连接不再分配新消息，全部连接都满时到期消息积压到回射腾出窗口
+//       （延迟仍从计划时刻算起）。开启合并发送时，一轮处理中追加的多条报文用一次send写出。
+//       场景文件描述的负载形态也在这里实现：按分布随机选取的消息大小、开环速率的线性爬升、
+//       按速率关闭并重连的连接更替、只保持不发送的空闲连接和每次读取后暂停的慢读连接
+class LoadWorker
+{
+private:
+    int id;                                   // 线程编号（用于日志）
+    const ClientConfig& config;               // 客户端配置
+    int epoll_fd;                             // epoll实例
+    int timer_fd;                             // 下一发送时刻的定时器（timerfd，绝对时间）
+    std::vector<LoadConnection> conns;        // 本线程负责的连接
+    std::string payload;                      // 报文数据部分的来源（填充'a'，长度为最大的消息，各报文取其前缀）
+    size_t header_len;                        // 报文头长度（v1为12，v2为20）
+    std::vector<uint32_t> sizes;              // 可选的数据部分长度（v2批量时为batch条子消息之和）
+    std::discrete_distribution<size_t> size_dist;  // 按权重选取sizes的下标
+    struct sockaddr_storage server_addr;      // 服务端地址（TCP或Unix域，重连时复用）
+    socklen_t server_addr_len;                // 服务端地址长度
+
+    // 发送调度
+    bool open_loop;                           // 是否开环发送
+    size_t max_inflight;                      // 每个连接的在途消息上限（发送窗口）
+    double interval_ns;                       // 平均发送间隔（纳秒）
+    std::mt19937_64 rng;                      // 泊松间隔的随机数发生器
+    std::exponential_distribution<double> exp_dist;  // 均值为1的指数分布
+    uint64_t next_arrival;                    // 下一条消息的计划发送时刻
+    uint64_t end_time;                        // 停止发送的时刻（0表示不限时）
+    uint64_t drain_deadline;                  // 停止发送后等待在途回射的截止时刻
+    uint64_t last_progress;                   // 最近一次收到回射的时刻（用于发现服务端无响应）
+    uint64_t begin_time;                      // 开始发送的时刻（速率爬升的起点）
+    double ramp_ns;                           // 速率爬升时长（纳秒），0表示不爬升
+    double churn_interval_ns;                 // 连接更替的平均间隔（纳秒），0表示不更替
+    uint64_t next_churn;                      // 下一次连接更替的时刻
+    size_t churn_next;                        // 轮转选择更替连接的下一个位置
+    uint64_t read_pause_ns;                   // 慢读连接每次读取后的暂停时长
+    std::vector<LoadConnection*> slow_conns;  // 慢读连接（检查暂停是否到期）
+    uint64_t next_connect_check;              // 下一次检查connect超时的时刻
+    size_t rr_next;                           // 轮转选择连接的下一个位置
+    bool started;                             // 连接阶段是否已结束、开始发送
+    bool schedule_done;                       // 是否已停止发送新消息
+    std::vector<LoadConnection*> dirty;       // 本轮追加过报文、等待合并写出的连接
+    int pending_connects;                     // 尚未完成的connect数
+    uint64_t outstanding;                     // 所有连接的在途消息总数
+
+    // 统计：计数由本线程写入，EchoClient周期报告和结束时读取汇总
+    // （错误包括连接失败、校验失败、丢失或超时的消息）
+    ClientStats stats;                        // 本线程的计数
+    LatencyHistogram histogram;               // 所有回射的延迟（纳秒，从计划发送时刻算起）
+
+    // 周期报告：本线程先记录到window，每隔一段时间在锁内并入published，由主线程取走
+    LatencyHistogram window;                  // 自上次发布以来的延迟
+    uint64_t last_publish;                    // 上次发布的时刻
+    std::mutex publish_mutex;                 // 保护published
+    LatencyHistogram published;               // 已发布、尚未被取走的延迟
+
+    std::atomic<bool> running;                // 事件循环是否仍在运行
+    std::thread thread;                       // 事件循环线程
+
+    // 事件循环：建立连接、按计划发送并处理回射
+    void run();
+
+    // 发起本线程所有连接的非阻塞connect（共享内存传输为阻塞地建立通道）
+    void open_connections();
+
+    // 解析服务端地址（TCP或Unix域）
+    // 返回：true成功，false地址非法（错误已记录日志）
+    bool resolve_server();
+
+    // 建立一个连接：发起非阻塞connect，或建立共享内存通道
+    // 参数：
+    //   conn - 连接
+    //   index - 连接下标（epoll事件标识）
+    // 返回：true成功发起（共享内存为已建立），false失败（已计入错误）
+    bool open_connection(LoadConnection& conn, size_t index);
+
+    // 连接更替：关闭连接并立即重连（调用时连接上没有在途消息）
+    // 参数：conn - 连接
+    void reconnect(LoadConnection& conn);
+
+    // 按更替速率选出到期的连接：没有在途消息的立即重连，否则先停止分配新消息
+    // 参数：now - 当前时刻
+    void churn(uint64_t now);
+
+    // 是否仍在按速率更替连接
+    // 参数：now - 当前时刻
+    bool churning(uint64_t now) const;
+
+    // 放弃超过截止时刻仍未完成的connect
+    // 参数：now - 当前时刻
+    void check_connect_timeouts(uint64_t now);
+
+    // 闭环模式：填满连接的发送窗口（合并发送时由调用方flush_pending）
+    // 参数：
+    //   conn - 连接
+    //   now - 当前时刻
+    void fill_window(LoadConnection& conn, uint64_t now);
+
+    // 慢读连接：暂停读取（套接字连接从epoll中去掉EPOLLIN）
+    // 参数：
+    //   conn - 连接
+    //   now - 当前时刻
+    void pause_reading(LoadConnection& conn, uint64_t now);
+
+    // 恢复暂停已到期的慢读连接并取走积压的回射
+    // 参数：now - 当前时刻
+    void resume_readers(uint64_t now);
+
+    // 计算epoll_wait的超时：不超过POLL_TIMEOUT_MS，并在下一次连接更替或慢读恢复时醒来
+    // 参数：now - 当前时刻
+    // 返回：超时（毫秒）
+    int poll_timeout(uint64_t now) const;
+
+    // 建立一个共享内存通道并注册到epoll
+    // 参数：
+    //   conn - 连接
+    //   index - 连接下标（epoll事件标识）
+    // 返回：true成功，false失败（已计入错误）
+    bool open_shm(LoadConnection& conn, size_t index);
+
+    // 处理共享内存通道的唤醒：取走回射并继续写出发送队列
+    void handle_shm_event(LoadConnection& conn);
+
+    // 从连接读取数据（TCP/Unix域：recv；共享内存：从回射环拷贝）
+    // 返回：读到的字节数；0表示服务端已关闭；-1表示出错或暂无数据（errno为EAGAIN）
+    ssize_t receive(LoadConnection& conn, char* buf, size_t len);
+
+    // 向连接写出数据（TCP/Unix域：send；共享内存：拷贝到请求环）
+    // 返回：写出的字节数；-1表示出错或暂时写不下（errno为EAGAIN）
+    ssize_t transmit(LoadConnection& conn, const char* data, size_t len);
+
+    // 处理一个连接上的epoll事件
+    // 参数：
+    //   conn - 连接
+    //   events - 就绪事件
+    void handle_event(LoadConnection& conn, uint32_t events);
+
+    // 连接阶段结束，开始发送
+    // 参数：now - 当前时刻
+    void begin(uint64_t now);
+
+    // 开环模式：发出所有计划时刻已到的消息并重设定时器
+    // 参数：now - 当前时刻
+    void issue_due(uint64_t now);
+
+    // 开环模式：连接收到回射腾出窗口后，补发积压的到期消息
+    // 参数：
+    //   conn - 连接
+    //   now - 当前时刻
+    void refill(LoadConnection& conn, uint64_t now);
+
+    // 按下一条消息的计划发送时刻设置定时器
+    void arm_timer();
+
+    // 计算下一条消息的计划发送时刻（固定间隔或指数分布间隔）
+    void advance_arrival();
+
+    // 轮转选出下一条开环消息的连接（跳过已关闭、已发完或窗口已满的连接）
+    // 返回：连接指针，没有可用连接时返回nullptr
+    LoadConnection* pick_connection();
+
+    // 连接是否还能继续发送消息
+    bool can_issue(const LoadConnection& conn) const;
+
+    // 连接之后是否还可能发送消息（正在重连或等待更替的连接也算）
+    bool may_issue(const LoadConnection& conn) const;
+
+    // 把一条消息追加到连接的发送队列并尝试写出
+    // 参数：
+    //   conn - 连接
+    //   intended - 计划发送时刻（延迟的起点）
+    void send_message(LoadConnection& conn, uint64_t intended);
+
+    // 合并发送：写出本轮追加过报文的连接
+    void flush_pending();
+
+    // 写出发送队列，写不完时注册EPOLLOUT
+    // 返回：true成功（含部分写出），false连接出错已关闭
+    bool flush_output(LoadConnection& conn);
+
+    // 读取并校验回射
+    // 返回：true成功，false连接出错已关闭
+    bool handle_read(LoadConnection& conn);
+
+    // 校验回射的报文头（版本、长度、子消息数和v2报文头CRC32C）
+    // 参数：
+    //   frame - 报文起始地址
+    //   msg_id - 输出参数，（第一条子）消息ID
+    //   data_len - 输出参数，数据部分长度
+    // 返回：true合法，false非法
+    bool check_echo_header(const char* frame, uint32_t& msg_id, uint32_t& data_len) const;
+
+    // 更新连接关注的epoll事件
+    void update_events(LoadConnection& conn, bool want_write);
+
+    // 按连接当前的状态（是否暂停读取、是否等待可写）重新设置关注的epoll事件
+    void apply_events(LoadConnection& conn);
+
+    // 关闭出错的连接，其在途消息计为错误
+    // 参数：
+    //   conn - 连接
+    //   reason - 错误原因（用于日志）
+    void fail_connection(LoadConnection& conn, const char* reason);
+
+    // 把window中的延迟发布给主线程
+    void publish_window();
+
+    // 是否已全部完成（停止发送且在途回射已收齐或等待超时）
+    // 参数：now - 当前时刻
+    bool finished(uint64_t now);
+
+public:
+    // 构造函数：初始化线程编号、配置和本线程负责的连接数
+    // 参数：
+    //   id - 线程编号
+    //   cfg - 客户端配置
+    //   connection_count - 本线程负责的发送连接数
+    //   idle_count - 本线程负责的空闲连接数
+    //   slow_count - 发送连接中慢读连接的个数
+    LoadWorker(int id, const ClientConfig& cfg, int connection_count, int idle_count, int slow_count);
+
+    // 析构函数：等待线程结束并释放资源
+    ~LoadWorker();
+
+    // 启动事件循环线程
+    void start();
+
+    // 等待事件循环线程结束
+    void join();
+
+    const ClientStats& counters() const { return stats; }
+    const LatencyHistogram& latency_histogram() const { return histogram; }
+    bool is_running() const { return running.load(std::memory_order_acquire); }
+
+    // 取走已发布的延迟（主线程周期报告时调用）
+    // 参数：out - 输出参数，延迟累加到其中
+    void collect_interval(LatencyHistogram& out);
+};
+
+#endif // LOAD_WORKER_H
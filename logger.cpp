@@ -0,0 +1,270 @@
+#include "logger.h"
+#include <cstdio>             // 用于vsnprintf/fwrite
+#include <cstdarg>            // 用于可变参数
+#include <cstring>            // 用于memcpy/strcmp
+#include <ctime>              // 用于clock_gettime
+#include <chrono>             // 用于后台线程休眠间隔
+#include <memory>             // 用于智能指针（管理各线程的环形缓冲区）
+#include <mutex>              // 用于保护环形缓冲区注册表
+#include <thread>             // 用于后台输出线程
+#include <vector>             // 用于环形缓冲区注册表
+
+std::atomic<int> Logger::runtime_level(LOG_LEVEL_INFO);
+
+namespace {
+
+const size_t RECORD_SIZE = 256;       // 单条记录的最大长度（含级别前缀和换行，超出部分截断）
+const size_t RING_CAPACITY = 4096;    // 每个线程环形缓冲区的记录数（2的幂）
+const size_t BATCH_SIZE = 64 * 1024;  // 后台线程单次写出的最大字节数
+
+// 单条已格式化的日志记录
+struct LogRecord
+{
+    uint64_t timestamp;               // 提交时间（单调时钟纳秒，用于多线程记录按时间合并输出）
+    uint32_t len;                     // 有效长度
+    char text[RECORD_SIZE];           // 完整的一行（"[LEVEL] ...\n"）
+};
+
+// 单生产者单消费者环形缓冲区：生产者为所属线程，消费者为后台输出线程
+// 注：head和tail分处不同缓存行，避免生产者与消费者互相干扰
+struct LogRing
+{
+    alignas(64) std::atomic<uint64_t> tail;      // 生产者写入位置
+    alignas(64) std::atomic<uint64_t> head;                  // 消费者读取位置
+    std::atomic<uint64_t> dropped;               // 缓冲区满时丢弃的记录数
+    LogRecord records[RING_CAPACITY];
+
+    LogRing() : tail(0), head(0), dropped(0) {}
+};
+
+// 全局状态：环形缓冲区注册表和后台线程
+// 注：环形缓冲区在线程首次写日志时注册，进程退出前不释放，
+//     因此线程退出后后台线程仍可安全取出其残留记录
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<LogRing>> registry;
+std::atomic<bool> async_running(false);
+std::atomic<bool> stop_requested(false);
+std::thread drain_thread;
+
+thread_local LogRing* local_ring = nullptr;   // 当前线程的环形缓冲区
+
+// 获取当前线程的环形缓冲区（首次调用时注册）
+LogRing* thread_ring() {
+    if (local_ring == nullptr) {
+        std::unique_ptr<LogRing> ring(new LogRing());
+        local_ring = ring.get();
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::move(ring));
+    }
+    return local_ring;
+}
+
+// 级别前缀（保持原有"[INFO] "输出格式）
+const char* level_prefix(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG: return "[DEBUG] ";
+    case LogLevel::INFO:  return "[INFO] ";
+    case LogLevel::WARN:  return "[WARN] ";
+    case LogLevel::ERROR: return "[ERROR] ";
+    default:              return "";
+    }
+}
+
+// 把一条日志格式化为完整的一行
+// 参数：
+//   buf - 输出缓冲区（RECORD_SIZE字节）
+//   level - 日志级别
+//   fmt/args - 格式串和参数
+// 返回：有效长度（超长时截断并保留换行）
+uint32_t format_record(char* buf, LogLevel level, const char* fmt, va_list args) {
+    const char* prefix = level_prefix(level);
+    size_t prefix_len = strlen(prefix);
+    memcpy(buf, prefix, prefix_len);
+    int n = vsnprintf(buf + prefix_len, RECORD_SIZE - prefix_len - 1, fmt, args);
+    size_t len = prefix_len;
+    if (n > 0) {
+        len += static_cast<size_t>(n) < RECORD_SIZE - prefix_len - 1 ? static_cast<size_t>(n)
+                                                                     : RECORD_SIZE - prefix_len - 2;
+    }
+    buf[len++] = '\n';
+    return static_cast<uint32_t>(len);
+}
+
+// 单调时钟纳秒数
+uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// 批量输出缓冲区
+struct Batch
+{
+    char data[BATCH_SIZE];
+    size_t len = 0;
+
+    // 追加一段文本，空间不足时先写出已有内容
+    void append(const char* text, size_t n) {
+        if (len + n > BATCH_SIZE) flush();
+        memcpy(data + len, text, n);
+        len += n;
+    }
+
+    void flush() {
+        if (len == 0) return;
+        fwrite(data, 1, len, stdout);
+        len = 0;
+    }
+};
+
+// 取出所有环形缓冲区中的记录并批量写到stdout
+// 说明：各线程的记录在各自缓冲区内有序，按提交时间多路合并后输出，
+//       保证不同线程的日志大体按发生顺序排列
+// 返回：本次写出的记录数
+size_t drain_all() {
+    static Batch batch;
+
+    // 快照每个环形缓冲区当前的可读范围
+    struct Cursor { LogRing* ring; uint64_t head; uint64_t tail; };
+    std::vector<Cursor> cursors;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        cursors.reserve(registry.size());
+        for (auto& ring : registry) {
+            Cursor c;
+            c.ring = ring.get();
+            c.head = c.ring->head.load(std::memory_order_relaxed);
+            c.tail = c.ring->tail.load(std::memory_order_acquire);
+            cursors.push_back(c);
+        }
+    }
+
+    size_t total = 0;
+    while (true) {
+        Cursor* next = nullptr;
+        uint64_t next_ts = 0;
+        for (Cursor& c : cursors) {
+            if (c.head == c.tail) continue;
+            uint64_t ts = c.ring->records[c.head & (RING_CAPACITY - 1)].timestamp;
+            if (next == nullptr || ts < next_ts) {
+                next = &c;
+                next_ts = ts;
+            }
+        }
+        if (next == nullptr) break;
+        const LogRecord& rec = next->ring->records[next->head & (RING_CAPACITY - 1)];
+        batch.append(rec.text, rec.len);
+        ++next->head;
+        ++total;
+    }
+
+    for (Cursor& c : cursors) {
+        c.ring->head.store(c.head, std::memory_order_release);
+        uint64_t dropped = c.ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            char line[RECORD_SIZE];
+            int n = snprintf(line, sizeof(line), "[WARN] log buffer full, %llu records dropped\n",
+                             static_cast<unsigned long long>(dropped));
+            batch.append(line, static_cast<size_t>(n));
+        }
+    }
+
+    if (batch.len > 0) {
+        batch.flush();
+        fflush(stdout);
+    }
+    return total;
+}
+
+// 后台输出线程：周期性批量取出各线程的记录
+// 说明：生产者不做任何通知（避免热路径上的系统调用），空闲时短暂休眠后再检查
+void drain_loop() {
+    while (!stop_requested.load(std::memory_order_acquire)) {
+        if (drain_all() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    drain_all();
+}
+
+} // namespace
+
+// 解析日志级别名称
+bool Logger::parse_level(const char* name, LogLevel& level) {
+    static const struct { const char* name; LogLevel level; } levels[] = {
+        {"debug", LogLevel::DEBUG}, {"info", LogLevel::INFO}, {"warn", LogLevel::WARN},
+        {"error", LogLevel::ERROR}, {"off", LogLevel::OFF}
+    };
+    for (const auto& entry : levels) {
+        if (strcmp(name, entry.name) == 0) {
+            level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 启动后台输出线程
+void Logger::start() {
+    if (async_running.load()) return;
+    stop_requested.store(false);
+    drain_thread = std::thread(drain_loop);
+    async_running.store(true, std::memory_order_release);
+}
+
+// 停止后台输出线程并输出剩余记录
+void Logger::stop() {
+    if (!async_running.load()) return;
+    async_running.store(false, std::memory_order_release);
+    stop_requested.store(true, std::memory_order_release);
+    drain_thread.join();
+    fflush(stdout);
+}
+
+// 格式化并提交一条日志记录
+// 说明：异步模式下直接格式化到本线程环形缓冲区的空闲槽位，不分配内存；
+//       缓冲区满时丢弃本条记录并计数，由后台线程统一报告
+void Logger::write(LogLevel level, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    if (!async_running.load(std::memory_order_acquire)) {  // 同步模式：直接输出
+        char line[RECORD_SIZE];
+        uint32_t len = format_record(line, level, fmt, args);
+        fwrite(line, 1, len, stdout);
+        va_end(args);
+        return;
+    }
+
+    LogRing* ring = thread_ring();
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->head.load(std::memory_order_acquire) >= RING_CAPACITY) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        va_end(args);
+        return;
+    }
+    LogRecord& rec = ring->records[tail & (RING_CAPACITY - 1)];
+    rec.timestamp = now_ns();
+    rec.len = format_record(rec.text, level, fmt, args);
+    ring->tail.store(tail + 1, std::memory_order_release);
+    va_end(args);
+}
+
+// 判断本次是否允许输出
+// 说明：使用CLOCK_MONOTONIC_COARSE取秒数（vDSO读取，开销极低）划分时间窗口
+bool LogRateLimiter::allow(uint64_t& dropped) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    int64_t now = ts.tv_sec;
+    if (now != window) {  // 进入新窗口：交出上一窗口被抑制的条数
+        window = now;
+        count = 0;
+        dropped = suppressed;
+        suppressed = 0;
+    }
+    if (count < per_second) {
+        ++count;
+        return true;
+    }
+    ++suppressed;
+    return false;
+}
@@ -0,0 +1,131 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>                 // 用于运行时日志级别
+#include <cstdint>                // 用于固定宽度整数类型
+
+// 日志子系统：分级、异步、批量输出
+// 说明：日志调用通过宏进行，分两级过滤：
+//       1. 编译期：低于LOG_COMPILE_LEVEL的宏条件恒为假，整条调用（含参数求值）被编译器消除；
+//       2. 运行期：低于Logger::set_level设置级别的调用只做一次原子读，不格式化参数。
+//       通过过滤的记录用printf风格格式化后写入本线程的无锁环形缓冲区（单生产者单消费者），
+//       由后台线程批量取出并写到stdout；环形缓冲区满时丢弃记录并计数，不阻塞调用线程。
+//       Logger::start()之前（或未调用时）日志同步输出
+
+// 日志级别编号（供预处理器比较）
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF   4
+
+// 编译期日志级别：低于该级别的日志宏不生成代码（可在编译选项中用-DLOG_COMPILE_LEVEL=N覆盖）
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// 日志级别
+enum class LogLevel : int
+{
+    DEBUG = LOG_LEVEL_DEBUG,   // 调试：每条报文级别的细节（热路径）
+    INFO = LOG_LEVEL_INFO,     // 信息：连接建立/关闭、启动参数、统计
+    WARN = LOG_LEVEL_WARN,     // 警告：可恢复的异常情况
+    ERROR = LOG_LEVEL_ERROR,   // 错误：操作失败
+    OFF = LOG_LEVEL_OFF        // 关闭所有日志
+};
+
+// 日志管理：全局级别、后台输出线程和各线程的环形缓冲区
+class Logger
+{
+private:
+    static std::atomic<int> runtime_level;   // 运行时日志级别
+
+public:
+    // 判断某级别的日志是否需要输出（热路径：一次relaxed原子读）
+    static bool enabled(LogLevel level) {
+        return static_cast<int>(level) >= runtime_level.load(std::memory_order_relaxed);
+    }
+
+    // 设置运行时日志级别
+    static void set_level(LogLevel level) {
+        runtime_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    // 解析日志级别名称（debug/info/warn/error/off）
+    // 参数：
+    //   name - 级别名称
+    //   level - 输出参数，解析成功时写入
+    // 返回：true成功，false名称无效
+    static bool parse_level(const char* name, LogLevel& level);
+
+    // 启动后台输出线程，之后的日志改为异步输出
+    static void start();
+
+    // 停止后台输出线程并输出所有剩余记录（之后的日志恢复同步输出）
+    static void stop();
+
+    // 格式化并提交一条日志记录（由日志宏调用，调用前已做级别过滤）
+    // 参数：
+    //   level - 日志级别
+    //   fmt - printf风格格式串
+    static void write(LogLevel level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// 日志限速器：限制同一调用点每秒输出的记录数，超出部分只计数，
+// 下一个时间窗口第一次输出时附带被抑制的条数
+// 注：由LOG_RATELIMITED宏按调用点、按线程各建一个实例，无需加锁
+class LogRateLimiter
+{
+private:
+    uint32_t per_second;      // 每秒允许输出的记录数
+    uint32_t count;           // 当前窗口已输出的记录数
+    int64_t window;           // 当前窗口（单调时钟秒数）
+    uint64_t suppressed;      // 当前窗口被抑制的记录数
+
+public:
+    explicit LogRateLimiter(uint32_t per_second)
+        : per_second(per_second), count(0), window(-1), suppressed(0) {}
+
+    // 判断本次是否允许输出
+    // 参数：dropped - 输出参数，允许输出时写入上一窗口被抑制的条数
+    // 返回：true允许输出，false被抑制
+    bool allow(uint64_t& dropped);
+};
+
+// 按级别输出日志（编译期级别和运行时级别都满足时才格式化参数）
+#define LOG_AT(level_num, level, ...)                                              \
+    do {                                                                           \
+        if ((level_num) >= LOG_COMPILE_LEVEL && Logger::enabled(level)) {          \
+            Logger::write(level, __VA_ARGS__);                                     \
+        }                                                                          \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, LogLevel::ERROR, __VA_ARGS__)
+
+// 限速输出日志：同一调用点每个线程每秒最多输出per_second条
+// 用于逐连接重复出现的错误（读写失败、超时、非法报文等），避免异常流量下日志淹没输出
+#define LOG_RATELIMITED(level_num, level, per_second, ...)                         \
+    do {                                                                           \
+        if ((level_num) >= LOG_COMPILE_LEVEL && Logger::enabled(level)) {          \
+            static thread_local LogRateLimiter log_limiter_(per_second);           \
+            uint64_t log_dropped_ = 0;                                             \
+            if (log_limiter_.allow(log_dropped_)) {                                \
+                if (log_dropped_ > 0) {                                            \
+                    Logger::write(LogLevel::WARN, "%llu similar messages suppressed", \
+                                  static_cast<unsigned long long>(log_dropped_));  \
+                }                                                                  \
+                Logger::write(level, __VA_ARGS__);                                 \
+            }                                                                      \
+        }                                                                          \
+    } while (0)
+
+// 逐连接错误的限速输出（每个调用点每线程每秒最多10条）
+#define LOG_ERROR_RL(...) LOG_RATELIMITED(LOG_LEVEL_ERROR, LogLevel::ERROR, 10, __VA_ARGS__)
+
+// 过载时逐连接告警的限速输出（如准入控制拒绝连接）
+#define LOG_WARN_RL(...) LOG_RATELIMITED(LOG_LEVEL_WARN, LogLevel::WARN, 10, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,459 @@
+// 服务端热路径的微基准：在进程内测量报文头解析、流水线报文切分、缓冲池、连接表，
+// 以及经socketpair的投递/回射路径（真实的工作线程），不需要完整的网络压测
+// 说明：每项基准先按倍数增加迭代次数，直到单次测量不短于最短测量时间，
+//       输出每次操作的耗时（ns/op）和吞吐（ops/s）；--csv输出便于保存并比较不同版本的结果
+// 用法：make bench，或 ./echo_bench [-f 名称子串] [-t 最短测量毫秒数] [--csv]
+
+#include "common.h"               // 包含报文头结构、魔数和日志函数
+#include "protocol.h"             // 包含报文解析与切分
+#include "buffer_pool.h"          // 包含固定大小缓冲池
+#include "connection.h"           // 包含连接状态结构
+#include "connection_table.h"     // 包含按fd索引的连接表
+#include "crc32c.h"               // 用于生成v2报文头校验
+#include "worker.h"               // 包含epoll工作线程
+#include "uring_worker.h"         // 包含io_uring工作线程
+#include <sys/socket.h>           // 用于socketpair
+#include <arpa/inet.h>            // 用于字节序转换（htonl等）
+#include <unistd.h>               // 用于read/write/close
+#include <fcntl.h>                // 用于设置非阻塞
+#include <getopt.h>               // 用于解析命令行参数
+#include <errno.h>                // 用于错误码（errno）
+#include <chrono>                 // 用于计时
+#include <cstdio>                 // 用于printf
+#include <cstring>                // 用于memcpy/strstr
+#include <memory>                 // 用于std::unique_ptr
+#include <string>                 // 用于选项字符串
+#include <vector>                 // 用于报文缓冲区
+
+namespace {
+
+// 基准选项
+struct BenchOptions
+{
+    std::string filter;           // 只运行名称包含该子串的基准，为空表示全部运行
+    int min_time_ms = 200;        // 单项基准的最短测量时间（毫秒）
+    bool csv = false;             // 以CSV格式输出
+};
+
+BenchOptions options;
+
+// 阻止编译器优化掉基准中的计算结果
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// 运行一项基准并输出结果
+// 参数：
+//   name - 基准名称（"类别/项目"）
+//   ops_per_iter - 每次迭代包含的操作数（例如一次切分的报文数）
+//   body - 基准主体，参数为迭代次数；返回false表示环境不支持，跳过该项
+template <typename Body>
+void run_bench(const char* name, uint64_t ops_per_iter, Body body) {
+    if (!options.filter.empty() && strstr(name, options.filter.c_str()) == nullptr) return;
+
+    const std::chrono::nanoseconds min_time = std::chrono::milliseconds(options.min_time_ms);
+    uint64_t iterations = 1;
+    std::chrono::nanoseconds elapsed(0);
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        if (!body(iterations)) {
+            if (!options.csv) printf("%-36s %s\n", name, "skipped (unsupported)");
+            return;
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= min_time || iterations >= (1ull << 34)) break;
+        // 按已测得的速度估算需要的迭代次数（多估20%），每轮至少翻倍、最多扩大10倍
+        double scale = elapsed.count() > 0 ? 1.2 * min_time.count() / elapsed.count() : 10.0;
+        scale = scale < 2.0 ? 2.0 : scale > 10.0 ? 10.0 : scale;
+        iterations = static_cast<uint64_t>(iterations * scale);
+    }
+
+    double ops = static_cast<double>(iterations * ops_per_iter);
+    double ns_per_op = elapsed.count() / ops;
+    double ops_per_sec = ops * 1e9 / elapsed.count();
+    if (options.csv) {
+        printf("%s,%.2f,%.0f,%llu\n", name, ns_per_op, ops_per_sec, static_cast<unsigned long long>(ops));
+    } else {
+        printf("%-36s %12.2f %16.0f %14llu\n", name, ns_per_op, ops_per_sec, static_cast<unsigned long long>(ops));
+    }
+}
+
+// 生成一条v1报文（报文头+数据）
+// 参数：
+//   out - 报文追加到其末尾
+//   msg_id - 消息ID
+//   data_len - 数据长度
+void append_frame_v1(std::vector<char>& out, uint32_t msg_id, uint32_t data_len) {
+    MessageHeader header;
+    header.magic = htonl(MAGIC_NUMBER);
+    header.msg_id = htonl(msg_id);
+    header.data_len = htonl(data_len);
+    const char* p = reinterpret_cast<const char*>(&header);
+    out.insert(out.end(), p, p + sizeof(header));
+    out.insert(out.end(), data_len, 'x');
+}
+
+// 生成一条v2批量报文（报文头CRC32C有效）
+// 参数：
+//   out - 报文追加到其末尾
+//   msg_id - 第一条子消息的ID
+//   count - 子消息条数
+//   data_len - 数据总长度（必须能被count整除）
+void append_frame_v2(std::vector<char>& out, uint32_t msg_id, uint16_t count, uint32_t data_len) {
+    MessageHeaderV2 header;
+    memset(&header, 0, sizeof(header));
+    header.magic = htonl(MAGIC_NUMBER_V2);
+    header.msg_id = htonl(msg_id);
+    header.data_len = htonl(data_len);
+    header.count = htons(count);
+    header.flags = 0;
+    header.header_crc = htonl(crc32c(&header, HEADER_V2_CRC_BYTES));
+    const char* p = reinterpret_cast<const char*>(&header);
+    out.insert(out.end(), p, p + sizeof(header));
+    out.insert(out.end(), data_len, 'x');
+}
+
+// 生成一条本次构建接受的报文：启用v1时为v1报文，否则为只含一条子消息的v2报文
+// 参数：
+//   out - 报文追加到其末尾
+//   msg_id - 消息ID
+//   data_len - 数据长度
+void append_frame(std::vector<char>& out, uint32_t msg_id, uint32_t data_len) {
+    if constexpr (BuildProtocol::accept_v1) {
+        append_frame_v1(out, msg_id, data_len);
+    } else {
+        append_frame_v2(out, msg_id, 1, data_len);
+    }
+}
+
+// 对同一条报文反复调用parse_frame（只在切分出完整报文时读取长度，避免读取未填充的结果）
+// 模板参数：Features - 协议特性集
+// 参数：
+//   frame - 报文
+//   available - 可用字节数
+//   n - 迭代次数
+template <typename Features = BuildProtocol>
+void parse_repeatedly(const std::vector<char>& frame, size_t available, uint64_t n) {
+    FrameInfo info{};
+    for (uint64_t i = 0; i < n; ++i) {
+        FrameStatus status = parse_frame<Features>(frame.data(), available, DEFAULT_MAX_MESSAGE_SIZE, -1, info);
+        keep(status);
+        if (status == FrameStatus::COMPLETE) keep(info.frame_len);
+    }
+}
+
+// 报文头解析与校验：对同一条报文反复调用parse_frame
+// 说明：本次构建未启用的报文版本只会走非法报文路径，不运行对应基准
+void bench_parse() {
+    if constexpr (BuildProtocol::accept_v1) {
+        std::vector<char> v1;
+        append_frame_v1(v1, 1, 256);
+        run_bench("parse/v1_header", 1, [&](uint64_t n) {
+            parse_repeatedly(v1, v1.size(), n);
+            return true;
+        });
+    }
+
+    if constexpr (BuildProtocol::accept_v2) {
+        std::vector<char> v2;
+        append_frame_v2(v2, 1, 8, 256);
+        if constexpr (BuildProtocol::verify_header_crc) {
+            run_bench("parse/v2_header_crc", 1, [&](uint64_t n) {
+                parse_repeatedly(v2, v2.size(), n);
+                return true;
+            });
+        }
+
+        // 关闭报文头校验的特性集（编译期去掉CRC32C），与上一项对比校验的开销
+        run_bench("parse/v2_header_nocrc", 1, [&](uint64_t n) {
+            parse_repeatedly<ProtocolFeatures<BuildProtocol::accept_v1, true, false>>(v2, v2.size(), n);
+            return true;
+        });
+    }
+
+    std::vector<char> any;
+    append_frame(any, 1, 256);
+    run_bench("parse/partial_header", 1, [&](uint64_t n) {
+        parse_repeatedly(any, sizeof(MessageHeader) - 1, n);
+        return true;
+    });
+}
+
+// 流水线报文切分：接收缓冲区中装满报文后整体调用consume_frames（ops为报文数）
+// 参数：
+//   name - 基准名称
+//   frames - 填满的接收缓冲区内容
+//   count - 其中的报文数
+void bench_scan_buffer(const char* name, const std::vector<char>& frames, uint64_t count) {
+    std::unique_ptr<char[]> rx_buf(new char[RX_BUFFER_SIZE]);
+    memcpy(rx_buf.get(), frames.data(), frames.size());
+    Connection conn;
+    conn.reset(-1, rx_buf.get());
+    run_bench(name, count, [&](uint64_t n) {
+        size_t echoed = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            conn.rx_start = 0;
+            conn.rx_end = frames.size();
+            consume_frames(conn, DEFAULT_MAX_MESSAGE_SIZE, [&](const char*, const FrameInfo& info) {
+                echoed += info.frame_len;
+            });
+        }
+        keep(echoed);
+        return true;
+    });
+}
+
+void bench_scan() {
+    if constexpr (BuildProtocol::accept_v1) {
+        std::vector<char> small;
+        uint64_t small_count = 0;
+        while (small.size() + sizeof(MessageHeader) + 64 <= RX_BUFFER_SIZE) {
+            append_frame_v1(small, static_cast<uint32_t>(small_count++), 64);
+        }
+        bench_scan_buffer("scan/pipelined_v1_64B", small, small_count);
+
+        std::vector<char> large;
+        uint64_t large_count = 0;
+        while (large.size() + sizeof(MessageHeader) + 1024 <= RX_BUFFER_SIZE) {
+            append_frame_v1(large, static_cast<uint32_t>(large_count++), 1024);
+        }
+        bench_scan_buffer("scan/pipelined_v1_1KB", large, large_count);
+    }
+
+    if constexpr (BuildProtocol::accept_v2) {
+        std::vector<char> batch;
+        uint64_t batch_count = 0;
+        while (batch.size() + sizeof(MessageHeaderV2) + 512 <= RX_BUFFER_SIZE) {
+            append_frame_v2(batch, static_cast<uint32_t>(batch_count++ * 8), 8, 512);
+        }
+        bench_scan_buffer("scan/pipelined_v2_batch8", batch, batch_count);
+    }
+}
+
+// 缓冲池：单个缓冲区的取出/归还，以及成批取出后成批归还（ops为缓冲区数）
+void bench_pool() {
+    BufferPool pool(RX_BUFFER_SIZE, 64);
+    pool.reserve(64);
+    run_bench("pool/acquire_release", 1, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            char* buf = pool.acquire();
+            keep(buf);
+            pool.release(buf);
+        }
+        return true;
+    });
+
+    const int BURST = 64;
+    char* bufs[BURST];
+    run_bench("pool/burst_64", BURST, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            for (int j = 0; j < BURST; ++j) bufs[j] = pool.acquire();
+            keep(bufs);
+            for (int j = BURST - 1; j >= 0; --j) pool.release(bufs[j]);
+        }
+        return true;
+    });
+}
+
+// 连接表：按fd查找（槽位分散在多个块中，访问顺序伪随机），以及占用/释放槽位
+void bench_table() {
+    const int SLOTS = 10000;
+    ConnectionTable<Connection> table;
+    for (int fd = 0; fd < SLOTS; ++fd) table.open(fd, nullptr);
+
+    run_bench("table/lookup_10k", 1, [&](uint64_t n) {
+        uint32_t x = 12345;
+        for (uint64_t i = 0; i < n; ++i) {
+            x = x * 1664525u + 1013904223u;  // 线性同余生成伪随机fd
+            keep(table.get(static_cast<int>(x % SLOTS)));
+        }
+        return true;
+    });
+
+    run_bench("table/open_release", 1, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            Connection* conn = table.open(SLOTS, nullptr);
+            keep(conn);
+            table.release(conn);
+        }
+        return true;
+    });
+}
+
+// 阻塞读满len字节
+// 返回：true成功，false对端关闭或出错
+bool read_full(int fd, char* buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, buf + done, len - done);
+        if (n > 0) {
+            done += n;
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 阻塞写出len字节
+// 返回：true成功，false出错
+bool write_full(int fd, const char* buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = write(fd, buf + done, len - done);
+        if (n > 0) {
+            done += n;
+        } else if (n == -1 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 创建并启动一个工作线程（不监听，只接管投递的连接）
+// 参数：backend - IO后端
+// 返回：工作线程，初始化失败时为空
+std::unique_ptr<WorkerBase> start_worker(IoBackend backend) {
+    ServerConfig config;
+    std::unique_ptr<WorkerBase> worker;
+    if (backend == IoBackend::URING) {
+        worker.reset(new UringWorker(0, config));
+    } else {
+        worker.reset(new Worker(0, config));
+    }
+    if (!worker->init(-1)) return nullptr;
+    worker->start();
+    return worker;
+}
+
+// 把socketpair的一端投递给工作线程（与接收线程投递新连接的路径相同）
+// 参数：
+//   worker - 工作线程
+//   client_fd - 输出参数，留给基准线程的一端（阻塞）
+// 返回：true成功
+bool connect_worker(WorkerBase& worker, int& client_fd) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) return false;
+    int flags = fcntl(fds[1], F_GETFL, 0);
+    fcntl(fds[1], F_SETFL, flags | O_NONBLOCK);
+    worker.add_connections(std::vector<int>(1, fds[1]));
+    client_fd = fds[0];
+    return true;
+}
+
+// 投递/回射路径：经socketpair与真实的工作线程往返
+// 参数：
+//   prefix - 基准名称前缀（后端名）
+//   backend - IO后端
+void bench_echo(const char* prefix, IoBackend backend) {
+    std::string name_rtt = std::string("echo/") + prefix + "_roundtrip_256B";
+    std::string name_pipe = std::string("echo/") + prefix + "_pipelined_32x64B";
+    std::string name_adopt = std::string("dispatch/") + prefix + "_adopt_first_echo";
+    if (!options.filter.empty() && name_rtt.find(options.filter) == std::string::npos &&
+        name_pipe.find(options.filter) == std::string::npos &&
+        name_adopt.find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    std::unique_ptr<WorkerBase> worker = start_worker(backend);
+    std::vector<char> frame;
+    append_frame(frame, 1, 256);
+    std::vector<char> echo(frame.size());
+
+    // 单条报文往返：写入一条报文，读回完整回射（包含工作线程的唤醒、读取、切分和writev）
+    int client_fd = -1;
+    bool ready = worker && connect_worker(*worker, client_fd);
+    run_bench(name_rtt.c_str(), 1, [&](uint64_t n) {
+        if (!ready) return false;
+        for (uint64_t i = 0; i < n; ++i) {
+            if (!write_full(client_fd, frame.data(), frame.size()) ||
+                !read_full(client_fd, echo.data(), echo.size())) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    // 流水线：一次写入32条小报文，读回全部回射（ops为报文数）
+    const int PIPELINE = 32;
+    std::vector<char> burst;
+    for (int i = 0; i < PIPELINE; ++i) append_frame(burst, static_cast<uint32_t>(i), 64);
+    std::vector<char> burst_echo(burst.size());
+    run_bench(name_pipe.c_str(), PIPELINE, [&](uint64_t n) {
+        if (!ready) return false;
+        for (uint64_t i = 0; i < n; ++i) {
+            if (!write_full(client_fd, burst.data(), burst.size()) ||
+                !read_full(client_fd, burst_echo.data(), burst_echo.size())) {
+                return false;
+            }
+        }
+        return true;
+    });
+    if (client_fd != -1) close(client_fd);
+
+    // 投递新连接：投递、接管注册、首条报文回射，再关闭（工作线程读到EOF后释放槽位）
+    run_bench(name_adopt.c_str(), 1, [&](uint64_t n) {
+        if (!worker) return false;
+        for (uint64_t i = 0; i < n; ++i) {
+            int fd;
+            if (!connect_worker(*worker, fd)) return false;
+            bool ok = write_full(fd, frame.data(), frame.size()) && read_full(fd, echo.data(), echo.size());
+            close(fd);
+            if (!ok) return false;
+        }
+        return true;
+    });
+}
+
+// 输出用法提示
+void print_usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-f filter] [-t min_time_ms] [--csv]\n", prog);
+}
+
+} // namespace
+
+// 微基准入口：解析选项后依次运行各项基准
+int main(int argc, char* argv[]) {
+    static const struct option long_options[] = {
+        {"filter",   required_argument, nullptr, 'f'},
+        {"min-time", required_argument, nullptr, 't'},
+        {"csv",      no_argument,       nullptr, 'c'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:t:", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':  // 名称过滤
+                options.filter = optarg;
+                break;
+            case 't':  // 最短测量时间（毫秒）
+                options.min_time_ms = std::stoi(optarg);
+                break;
+            case 'c':  // CSV输出
+                options.csv = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    Logger::set_level(LogLevel::WARN);  // 工作线程每个连接的info日志会干扰计时
+
+    if (options.csv) {
+        printf("benchmark,ns_per_op,ops_per_sec,ops\n");
+    } else {
+        printf("%-36s %12s %16s %14s\n", "benchmark", "ns/op", "ops/s", "ops");
+    }
+    bench_parse();
+    bench_scan();
+    bench_pool();
+    bench_table();
+    bench_echo("epoll", IoBackend::EPOLL);
+    bench_echo("uring", IoBackend::URING);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "numa.h"
+#include "logger.h"           // 用于日志宏
+#include <sys/socket.h>       // 用于getsockopt/setsockopt
+#include <sys/syscall.h>      // 用于set_mempolicy系统调用号
+#include <linux/filter.h>     // 用于cBPF指令（sock_filter）
+#include <linux/mempolicy.h>  // 用于MPOL_PREFERRED
+#include <unistd.h>           // 用于syscall/sysconf
+#include <errno.h>            // 用于错误码（errno）
+#include <cstdio>             // 用于读取sysfs文件
+#include <cstdlib>            // 用于strtol
+#include <string>             // 用于sysfs路径
+
+namespace {
+
+// 读取sysfs中的单行文本
+// 参数：
+//   path - 文件路径
+//   line - 输出参数，文件内容（去掉末尾换行）
+// 返回：true成功，false文件不存在或读取失败
+bool read_line(const std::string& path, std::string& line) {
+    FILE* f = fopen(path.c_str(), "r");
+    if (f == nullptr) return false;
+    char buf[4096];
+    bool ok = fgets(buf, sizeof(buf), f) != nullptr;
+    fclose(f);
+    if (!ok) return false;
+    line = buf;
+    while (!line.empty() && (line.back() == '\n' || line.back() == ' ')) line.pop_back();
+    return true;
+}
+
+// 解析sysfs的列表格式（如"0-3,8-11"）
+// 参数：text - 列表文本
+// 返回：编号列表（升序，格式错误的部分被忽略）
+std::vector<int> parse_list(const std::string& text) {
+    std::vector<int> values;
+    const char* p = text.c_str();
+    while (*p != '\0') {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) break;
+        }
+        for (long v = first; v <= last && v < 65536; ++v) {
+            values.push_back(static_cast<int>(v));
+        }
+        if (*end != ',') break;
+        p = end + 1;
+    }
+    return values;
+}
+
+} // namespace
+
+// 从sysfs读取拓扑
+// 返回：true成功，false失败（退化为单节点）
+bool NumaTopology::load() {
+    node_cpus.clear();
+    cpu_nodes.clear();
+
+    std::string line;
+    bool ok = read_line("/sys/devices/system/node/online", line);
+    if (ok) {
+        for (int node : parse_list(line)) {
+            if (!read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", line)) continue;
+            if (node >= node_count()) node_cpus.resize(node + 1);
+            node_cpus[node] = parse_list(line);
+            for (int cpu : node_cpus[node]) {
+                if (cpu >= cpu_count()) cpu_nodes.resize(cpu + 1, -1);
+                cpu_nodes[cpu] = node;
+            }
+        }
+        ok = !cpu_nodes.empty();
+    }
+    if (!ok) {  // 没有NUMA信息（如未开启CONFIG_NUMA）：所有在线CPU视为节点0
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        node_cpus.assign(1, std::vector<int>());
+        cpu_nodes.assign(cpus > 0 ? cpus : 1, 0);
+        for (int cpu = 0; cpu < cpu_count(); ++cpu) node_cpus[0].push_back(cpu);
+    }
+    return ok;
+}
+
+// 有CPU的节点
+std::vector<int> NumaTopology::cpu_nodes_list() const {
+    std::vector<int> nodes;
+    for (int node = 0; node < node_count(); ++node) {
+        if (!node_cpus[node].empty()) nodes.push_back(node);
+    }
+    return nodes;
+}
+
+// 设置当前线程的内存策略：优先从指定节点分配
+// 参数：node - 节点编号
+// 返回：true成功，false失败
+bool numa_prefer_node(int node) {
+    const int BITS = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(node / BITS + 1, 0);
+    mask[node / BITS] |= 1ul << (node % BITS);
+    // maxnode按内核约定传位数+1（与libnuma一致）
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask.data(), mask.size() * BITS + 1) == 0;
+}
+
+// 读取套接字的SO_INCOMING_CPU
+// 参数：fd - 已连接的套接字
+// 返回：CPU编号，-1表示未知
+int incoming_cpu(int fd) {
+    int cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == -1) return -1;
+    return cpu;
+}
+
+// 挂载按接收CPU选择监听套接字的cBPF程序
+// 说明：程序为"取CPU编号，逐个比较，命中时返回下标"的线性序列，每个CPU两条指令，
+//       受cBPF指令数上限（4096）限制，最多支持2047个CPU
+// 参数：
+//   listen_fd - 组内任意一个监听套接字
+//   cpu_to_index - CPU编号 → 组内下标（负数表示不指定）
+// 返回：true成功，false失败
+bool attach_reuseport_cpu_steering(int listen_fd, const std::vector<int>& cpu_to_index) {
+    std::vector<struct sock_filter> program;
+    program.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)));
+    for (size_t cpu = 0; cpu < cpu_to_index.size(); ++cpu) {
+        if (cpu_to_index[cpu] < 0) continue;
+        program.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, static_cast<uint32_t>(cpu), 0, 1));
+        program.push_back(BPF_STMT(BPF_RET | BPF_K, static_cast<uint32_t>(cpu_to_index[cpu])));
+    }
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffffu));  // 越界下标：内核回退到哈希选择
+    if (program.size() > BPF_MAXINSNS) {
+        LOG_WARN("Too many CPUs for reuseport CPU steering (%zu instructions)", program.size());
+        return false;
+    }
+
+    struct sock_fprog prog;
+    prog.len = static_cast<unsigned short>(program.size());
+    prog.filter = program.data();
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) == -1) {
+        LOG_WARN("Attach reuseport CPU steering failed (errno: %d)", errno);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+// NUMA拓扑与就近放置：从sysfs读取节点和CPU的对应关系，设置线程的内存策略，
+// 并为SO_REUSEPORT监听组生成按接收CPU选择监听套接字的cBPF程序
+// 说明：直接使用系统调用和sysfs，不依赖libnuma；单节点或读取失败时退化为一个包含所有CPU的节点
+
+#include <vector>                 // 用于节点和CPU列表
+
+// NUMA拓扑：节点 → CPU列表，CPU → 节点
+class NumaTopology
+{
+private:
+    std::vector<std::vector<int>> node_cpus;  // 各节点的CPU（升序；下标为节点编号，不存在的节点为空）
+    std::vector<int> cpu_nodes;               // 各CPU所在节点（-1表示未知或离线）
+
+public:
+    // 从/sys/devices/system/node读取拓扑
+    // 返回：true读取成功，false读取失败（退化为单节点，节点0包含所有在线CPU）
+    bool load();
+
+    // 节点编号上界（最大节点编号+1）
+    int node_count() const { return static_cast<int>(node_cpus.size()); }
+
+    // CPU编号上界（最大CPU编号+1）
+    int cpu_count() const { return static_cast<int>(cpu_nodes.size()); }
+
+    // CPU所在节点
+    // 返回：节点编号，-1表示未知
+    int node_of_cpu(int cpu) const {
+        return cpu >= 0 && cpu < cpu_count() ? cpu_nodes[cpu] : -1;
+    }
+
+    // 节点上的CPU
+    const std::vector<int>& cpus_of(int node) const { return node_cpus[node]; }
+
+    // 有CPU的节点（按编号升序）
+    std::vector<int> cpu_nodes_list() const;
+};
+
+// 把当前线程的内存策略设为优先从指定节点分配（之后首次访问的页面落在该节点，节点内存不足时回退到其他节点）
+// 参数：node - 节点编号
+// 返回：true成功，false失败（errno由set_mempolicy设置）
+bool numa_prefer_node(int node);
+
+// 读取套接字最近一次接收数据时所在的CPU（SO_INCOMING_CPU）
+// 参数：fd - 已连接的套接字
+// 返回：CPU编号，-1表示未知（Unix域套接字或内核尚未记录）
+int incoming_cpu(int fd);
+
+// 为SO_REUSEPORT监听组挂载按接收CPU选择监听套接字的cBPF程序
+// 说明：程序读取处理该SYN的CPU编号，按表返回监听套接字在组内的下标（即加入组的顺序）；
+//       表外的CPU返回越界下标，内核回退到按四元组哈希选择
+// 参数：
+//   listen_fd - 组内任意一个监听套接字
+//   cpu_to_index - CPU编号 → 组内下标
+// 返回：true成功，false失败（错误已记录日志）
+bool attach_reuseport_cpu_steering(int listen_fd, const std::vector<int>& cpu_to_index);
+
+#endif // NUMA_H
@@ -0,0 +1,53 @@
+#ifndef PER_THREAD_COUNTERS_H
+#define PER_THREAD_COUNTERS_H
+
+#include <array>                  // 用于计数快照
+#include <atomic>                 // 用于允许其他线程读取的计数器
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint64_t
+
+// 单线程独占的统计计数块：只由所属线程写入，报告时由其他线程读取并汇总
+// 说明：计数器为64位，长时间压测不会溢出；写入用relaxed的load+store而不是fetch_add，
+//       热路径上没有带lock前缀的原子指令。计数块按缓存行对齐、
+//       大小补齐到缓存行的整数倍，计数器所在的缓存行不会与其他数据共享（避免伪共享）
+// 模板参数：N - 计数器个数（调用方用枚举值作下标）
+template <size_t N>
+class alignas(64) PerThreadCounters
+{
+public:
+    typedef std::array<uint64_t, N> Snapshot;   // 计数快照（可直接累加汇总）
+
+private:
+    std::atomic<uint64_t> values[N];
+
+public:
+    PerThreadCounters() {
+        for (auto& v : values) v.store(0, std::memory_order_relaxed);
+    }
+
+    PerThreadCounters(const PerThreadCounters&) = delete;
+    PerThreadCounters& operator=(const PerThreadCounters&) = delete;
+
+    // 累加计数（只能由所属线程调用）
+    // 参数：
+    //   index - 计数器下标
+    //   n - 增量
+    void add(size_t index, uint64_t n = 1) {
+        values[index].store(values[index].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // 读取单个计数（任意线程）
+    uint64_t get(size_t index) const {
+        return values[index].load(std::memory_order_relaxed);
+    }
+
+    // 把所有计数累加到快照（任意线程，用于汇总多个线程的计数）
+    // 参数：out - 输出参数，计数累加到其中
+    void accumulate(Snapshot& out) const {
+        for (size_t i = 0; i < N; ++i) {
+            out[i] += values[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // PER_THREAD_COUNTERS_H
@@ -0,0 +1,28 @@
+#include "protocol.h"
+
+// 本次构建的协议特性描述
+const char* build_protocol_name() {
+    if (!BuildProtocol::accept_v2) return "v1";
+    if (!BuildProtocol::accept_v1) return BuildProtocol::verify_header_crc ? "v2, header crc" : "v2, no header crc";
+    return BuildProtocol::verify_header_crc ? "v1+v2, header crc" : "v1+v2, no header crc";
+}
+
+// 魔数不匹配（非法消息，或本次构建未启用的报文版本）
+void log_bad_magic(int fd) {
+    LOG_ERROR_RL("Invalid magic number (fd: %d)", fd);
+}
+
+// 数据长度非法（为0或超过配置的最大报文长度）
+void log_bad_length(uint32_t data_len, int fd) {
+    LOG_ERROR_RL("Invalid data length (%u) (fd: %d)", data_len, fd);
+}
+
+// v2报文头CRC32C不匹配
+void log_bad_checksum(uint32_t expected, uint32_t actual, int fd) {
+    LOG_ERROR_RL("Header checksum mismatch (expected: 0x%08x, actual: 0x%08x) (fd: %d)", expected, actual, fd);
+}
+
+// v2报文头字段非法
+void log_bad_v2_header(uint32_t count, uint16_t flags, uint32_t data_len, int fd) {
+    LOG_ERROR_RL("Invalid v2 header (count: %u, flags: 0x%04x, data length: %u) (fd: %d)", count, flags, data_len, fd);
+}
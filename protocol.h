@@ -0,0 +1,229 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "common.h"               // 包含报文头结构、魔数和日志函数
+#include "connection.h"           // 包含连接状态结构
+#include "crc32c.h"               // 用于v2报文头校验
+#include <arpa/inet.h>            // 用于字节序转换（ntohl）
+#include <chrono>                 // 用于阶段计时
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于SIZE_MAX
+#include <cstring>                // 用于memcpy
+#include <type_traits>            // 用于判断on_frame是否返回bool
+
+// 协议处理：报文头校验与报文切分，供所有IO后端（epoll/io_uring/共享内存）共用，
+// 保证不同后端的校验规则、日志和统计口径一致。
+// 按魔数区分v1报文（12字节报文头，一条消息）和v2报文（20字节报文头，一批子消息，带报文头CRC32C），
+// 回射时两种报文都原样写回。
+// 解析和切分是以协议特性集为参数的模板：构建时关闭的特性（某个报文版本、报文头校验）
+// 由if constexpr在编译期去掉，热路径上不留运行时判断；报文非法时的日志在protocol.cpp中（冷路径）
+
+// 编译期协议特性（由构建配置以-D指定，见Makefile的PROTOCOL_V1/PROTOCOL_V2/HEADER_CRC）
+#ifndef ECHO_PROTOCOL_V1
+#define ECHO_PROTOCOL_V1 1        // 接受v1报文
+#endif
+#ifndef ECHO_PROTOCOL_V2
+#define ECHO_PROTOCOL_V2 1        // 接受v2报文
+#endif
+#ifndef ECHO_HEADER_CRC
+#define ECHO_HEADER_CRC 1         // 校验v2报文头的CRC32C（关闭时只适用于可信的同机/内网客户端）
+#endif
+
+// 协议特性集
+// 模板参数：
+//   V1 - 是否接受v1报文（关闭时v1魔数按BAD_MAGIC处理）
+//   V2 - 是否接受v2报文
+//   HeaderCrc - 是否校验v2报文头的CRC32C
+template <bool V1, bool V2, bool HeaderCrc>
+struct ProtocolFeatures
+{
+    static_assert(V1 || V2, "at least one frame version must be enabled");
+    static constexpr bool accept_v1 = V1;
+    static constexpr bool accept_v2 = V2;
+    static constexpr bool verify_header_crc = HeaderCrc;
+};
+
+// 本次构建的协议特性集（各IO后端的报文切分默认使用它）
+typedef ProtocolFeatures<ECHO_PROTOCOL_V1 != 0, ECHO_PROTOCOL_V2 != 0, ECHO_HEADER_CRC != 0> BuildProtocol;
+
+// 本次构建的协议特性描述（如"v1+v2, header crc"，用于启动日志）
+const char* build_protocol_name();
+
+// 单条报文的解析结果
+enum class FrameStatus
+{
+    COMPLETE,      // 报文完整（报文头+数据都已收全）
+    NEED_HEADER,   // 报文头不完整（v1不足12字节，v2不足20字节）
+    NEED_PAYLOAD,  // 报文头已收全并校验通过，数据部分不足
+    BAD_MAGIC,     // 魔数不匹配
+    BAD_LENGTH,    // 数据长度非法
+    BAD_CHECKSUM,  // v2报文头CRC32C不匹配
+    BAD_HEADER     // v2报文头字段非法（子消息条数为0、长度不能整除或有未定义的标志位）
+};
+
+// 报文元信息（主机字节序）
+struct FrameInfo
+{
+    uint32_t data_len;   // 数据部分长度
+    uint32_t msg_id;     // 消息ID（v2为第一条子消息的ID）
+    uint32_t count;      // 子消息条数（v1为1）
+    uint32_t header_len; // 报文头长度（v1为12，v2为20）
+    size_t frame_len;    // 报文总长度（报文头+数据）
+};
+
+// 判断解析结果是否为报文非法（调用方应关闭连接）
+inline bool is_frame_error(FrameStatus status) {
+    return status != FrameStatus::COMPLETE && status != FrameStatus::NEED_HEADER &&
+           status != FrameStatus::NEED_PAYLOAD;
+}
+
+// 报文非法时的日志（冷路径，不内联到切分循环中）
+void log_bad_magic(int fd) __attribute__((cold));
+void log_bad_length(uint32_t data_len, int fd) __attribute__((cold));
+void log_bad_checksum(uint32_t expected, uint32_t actual, int fd) __attribute__((cold));
+void log_bad_v2_header(uint32_t count, uint16_t flags, uint32_t data_len, int fd) __attribute__((cold));
+
+// 解析v1报文头（调用方已确认魔数且至少有12字节）
+inline FrameStatus parse_frame_v1(const char* data, uint32_t max_data_len, int fd, FrameInfo& info) {
+    MessageHeader header;
+    memcpy(&header, data, sizeof(header));  // 缓冲区内不保证对齐，拷贝出来再解析
+
+    // 解析数据长度和消息ID（网络字节序转主机字节序）
+    info.data_len = ntohl(header.data_len);  // 数据部分长度
+    info.msg_id = ntohl(header.msg_id);      // 消息ID
+    info.count = 1;
+    info.header_len = sizeof(MessageHeader);
+    info.frame_len = info.header_len + info.data_len;
+    // 校验数据长度合法性（必须为正数且不超过配置的最大报文长度）
+    if (info.data_len == 0 || info.data_len > max_data_len) {
+        log_bad_length(info.data_len, fd);
+        return FrameStatus::BAD_LENGTH;
+    }
+    return FrameStatus::COMPLETE;
+}
+
+// 解析v2报文头（调用方已确认魔数且至少有20字节）
+// 说明：先校验CRC32C，字段损坏的报文头不会以错误的长度继续切分后续数据
+// 模板参数：Features - 协议特性集（verify_header_crc为假时不计算CRC32C）
+template <typename Features>
+inline FrameStatus parse_frame_v2(const char* data, uint32_t max_data_len, int fd, FrameInfo& info) {
+    MessageHeaderV2 header;
+    memcpy(&header, data, sizeof(header));
+    if constexpr (Features::verify_header_crc) {
+        uint32_t expected = ntohl(header.header_crc);
+        uint32_t actual = crc32c(data, HEADER_V2_CRC_BYTES);
+        if (actual != expected) {
+            log_bad_checksum(expected, actual, fd);
+            return FrameStatus::BAD_CHECKSUM;
+        }
+    }
+
+    info.data_len = ntohl(header.data_len);
+    info.msg_id = ntohl(header.msg_id);
+    info.count = ntohs(header.count);
+    info.header_len = sizeof(MessageHeaderV2);
+    info.frame_len = info.header_len + info.data_len;
+    uint16_t flags = ntohs(header.flags);
+    if (flags != 0 || info.count == 0 || info.data_len % info.count != 0) {
+        log_bad_v2_header(info.count, flags, info.data_len, fd);
+        return FrameStatus::BAD_HEADER;
+    }
+    if (info.data_len == 0 || info.data_len > max_data_len) {
+        log_bad_length(info.data_len, fd);
+        return FrameStatus::BAD_LENGTH;
+    }
+    return FrameStatus::COMPLETE;
+}
+
+// 解析缓冲区开头的一条报文
+// 模板参数：Features - 协议特性集（默认为本次构建的特性集）
+// 参数：
+//   data - 缓冲区起始地址（不要求对齐）
+//   available - 缓冲区中的可用字节数
+//   max_data_len - 允许的最大数据长度（超出时返回BAD_LENGTH）
+//   fd - 所属连接（仅用于日志）
+//   info - 输出参数，报文头收全后填充
+// 返回：解析结果
+template <typename Features = BuildProtocol>
+inline FrameStatus parse_frame(const char* data, size_t available, uint32_t max_data_len, int fd, FrameInfo& info) {
+    if (available < sizeof(MessageHeader)) {
+        return FrameStatus::NEED_HEADER;
+    }
+
+    // 按魔数区分报文版本（网络字节序转主机字节序后对比）
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(magic));
+    uint32_t magic_host = ntohl(magic);
+    LOG_DEBUG("FD %d received magic: net=0x%08x, host=0x%08x", fd, magic, magic_host);
+
+    FrameStatus status;
+    if constexpr (Features::accept_v1) {
+        if (magic_host == MAGIC_NUMBER) {
+            status = parse_frame_v1(data, max_data_len, fd, info);
+            if (status != FrameStatus::COMPLETE) return status;
+            return available < info.frame_len ? FrameStatus::NEED_PAYLOAD : FrameStatus::COMPLETE;
+        }
+    }
+    if constexpr (Features::accept_v2) {
+        if (magic_host == MAGIC_NUMBER_V2) {
+            if (available < sizeof(MessageHeaderV2)) return FrameStatus::NEED_HEADER;
+            status = parse_frame_v2<Features>(data, max_data_len, fd, info);
+            if (status != FrameStatus::COMPLETE) return status;
+            return available < info.frame_len ? FrameStatus::NEED_PAYLOAD : FrameStatus::COMPLETE;
+        }
+    }
+    log_bad_magic(fd);  // 魔数不匹配（非法消息，或本次构建未启用的报文版本）
+    return FrameStatus::BAD_MAGIC;
+}
+
+// 切分连接接收缓冲区[rx_start, rx_end)中的所有完整报文，按顺序对每条报文调用on_frame
+// 作用：推进rx_start、更新解析状态和阶段计时；末尾不完整的报文留在原处
+// 模板参数：Features - 协议特性集（默认为本次构建的特性集）
+// 参数：
+//   conn - 客户端连接
+//   max_data_len - 允许的最大数据长度
+//   on_frame - 回调，参数为(const char* frame, const FrameInfo& info)，frame指向报文头；
+//              返回bool时false表示暂停切分（该报文不计为已处理，留在缓冲区下次继续）
+//   max_frames - 本次最多切分的报文数（其余完整报文留在缓冲区，下次继续）
+//   partial - 可选输出参数：末尾报文的报文头已收全、数据未收全时填充其元信息
+// 返回：最后一条报文的解析结果；is_frame_error为真表示报文非法
+//       （错误已记录日志，调用方应关闭连接），其余均为正常
+template <typename Features = BuildProtocol, typename OnFrame>
+FrameStatus consume_frames(Connection& conn, uint32_t max_data_len, OnFrame on_frame, size_t max_frames = SIZE_MAX,
+                    FrameInfo* partial = nullptr)
+{
+    for (size_t count = 0; count < max_frames; ++count) {
+        const char* frame = conn.rx_buf + conn.rx_start;
+        FrameInfo info;
+        FrameStatus status = parse_frame<Features>(frame, conn.rx_end - conn.rx_start, max_data_len, conn.fd, info);
+        if (is_frame_error(status) || status == FrameStatus::NEED_HEADER) {
+            return status;
+        }
+        if (status == FrameStatus::NEED_PAYLOAD) {
+            // 数据部分未收全：保留在缓冲区，等待下一次事件
+            if (partial != nullptr) *partial = info;
+            if (conn.state == ConnState::READ_HEADER) {  // 报文头刚收全，数据阶段开始计时
+                conn.state = ConnState::READ_PAYLOAD;
+                conn.stage_start = std::chrono::steady_clock::now();
+            }
+            return status;
+        }
+
+        // 完整报文
+        if constexpr (std::is_same<decltype(on_frame(frame, info)), bool>::value) {
+            if (!on_frame(frame, info)) return FrameStatus::COMPLETE;
+        } else {
+            on_frame(frame, info);
+        }
+        conn.rx_start += info.frame_len;
+        ++conn.frames;
+        LOG_DEBUG("Processed msg_id: %u, fd: %d", info.msg_id, conn.fd);
+
+        // 下一条报文从报文头阶段开始计时
+        conn.state = ConnState::READ_HEADER;
+        conn.stage_start = std::chrono::steady_clock::now();
+    }
+    return FrameStatus::COMPLETE;
+}
+
+#endif // PROTOCOL_H
@@ -1,17 +1,329 @@
 #include "echo_server.h"  // 包含EchoServer类定义
 #include "common.h"       // 包含公共常量和日志函数
+#include <getopt.h>       // 用于解析命令行参数
+#include <iostream>       // 用于标准输入输出
+#include <sstream>        // 用于拆分CPU列表字符串
+
+// 解析逗号分隔的CPU列表（如"0,2,4"）
+// 参数：arg - 命令行参数字符串
+// 返回：CPU编号列表
+static std::vector<int> parse_cpu_list(const std::string& arg)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) cpus.push_back(std::stoi(item));
+    }
+    return cpus;
+}
+
+// 仅有长格式的选项编号（从256开始，避免与短选项字符冲突）
+enum LongOnlyOption
+{
+    OPT_TCP_NODELAY = 256,  // --tcp-nodelay=0|1
+    OPT_SNDBUF,             // --sndbuf=bytes
+    OPT_RCVBUF,             // --rcvbuf=bytes
+    OPT_POOL_SLAB,          // --pool-slab=buffers
+    OPT_POOL_PREALLOC,      // --pool-prealloc=buffers
+    OPT_STATS_INTERVAL,     // --stats-interval=seconds
+    OPT_ZEROCOPY_THRESHOLD, // --zerocopy-threshold=bytes
+    OPT_LOG_LEVEL,          // --log-level=debug|info|warn|error|off
+    OPT_ADMIN_PORT,         // --admin-port=port
+    OPT_MAX_MESSAGE,        // --max-message=bytes
+    OPT_OUTPUT_HIGH_WATER,  // --output-high-water=bytes
+    OPT_WRITE_TIMEOUT,      // --write-timeout=seconds
+    OPT_IDLE_TIMEOUT,       // --idle-timeout=seconds
+    OPT_BACKLOG,            // --backlog=n
+    OPT_ACCEPT_BUDGET,      // --accept-budget=n
+    OPT_DEFER_ACCEPT,       // --defer-accept=seconds
+    OPT_DRAIN_TIMEOUT,      // --drain-timeout=seconds
+    OPT_HANDOFF,            // --handoff=path
+    OPT_UNIX,               // --unix=path
+    OPT_SHM,                // --shm=path
+    OPT_SHM_RING_SIZE,      // --shm-ring-size=bytes
+    OPT_POLL,               // --poll=block|spin|busy
+    OPT_POLL_SPIN,          // --poll-spin=microseconds
+    OPT_BUSY_POLL,          // --busy-poll=microseconds
+    OPT_PREFER_BUSY_POLL,   // --prefer-busy-poll
+    OPT_EVENT_BUDGET,       // --event-budget=bytes
+    OPT_EVENT_FRAMES,       // --event-frames=n
+    OPT_TCP_WEIGHT,         // --tcp-weight=n
+    OPT_UNIX_WEIGHT,        // --unix-weight=n
+    OPT_MAX_CONNECTIONS,    // --max-connections=n
+    OPT_MAX_PER_IP,         // --max-per-ip=n
+    OPT_MAX_INFLIGHT,       // --max-inflight=bytes
+    OPT_NUMA,               // --numa
+    OPT_TRACE_SAMPLE,       // --trace-sample=n
+    OPT_TRACE_CAPACITY,     // --trace-capacity=n
+    OPT_TRACE_FILE          // --trace-file=path
+};
+
+// 输出用法提示
+// 参数：prog - 程序名
+static void print_usage(const char* prog)
+{
+    std::cerr << "Usage: " << prog << " [-p port] [-w workers] [-r] [-a cpu,cpu,...] [-b epoll|uring]\n"
+              << "       [--tcp-nodelay=0|1] [--sndbuf=bytes] [--rcvbuf=bytes]\n"
+              << "       [--pool-slab=buffers] [--pool-prealloc=buffers] [--stats-interval=seconds]\n"
+              << "       [--zerocopy-threshold=bytes] [--log-level=debug|info|warn|error|off]\n"
+              << "       [--admin-port=port] [--max-message=bytes] [--output-high-water=bytes]\n"
+              << "       [--write-timeout=seconds] [--idle-timeout=seconds]\n"
+              << "       [--backlog=n] [--accept-budget=n] [--defer-accept=seconds]\n"
+              << "       [--drain-timeout=seconds] [--handoff=path]\n"
+              << "       [--unix=path] [--shm=path] [--shm-ring-size=bytes]\n"
+              << "       [--poll=block|spin|busy] [--poll-spin=microseconds] [--busy-poll=microseconds]\n"
+              << "       [--prefer-busy-poll] [--event-budget=bytes] [--event-frames=n]\n"
+              << "       [--tcp-weight=n] [--unix-weight=n]\n"
+              << "       [--max-connections=n] [--max-per-ip=n] [--max-inflight=bytes]\n"
+              << "       [--numa] [--trace-sample=n] [--trace-capacity=n] [--trace-file=path]\n";
+}
+
+// 解析命令行参数到服务端配置
+// 参数：
+//   argc - 命令行参数数量
+//   argv - 命令行参数数组
+//   config - 输出参数，存储解析后的配置
+void parse_args(int argc, char* argv[], ServerConfig& config)
+{
+    static const struct option long_options[] = {
+        {"port",        required_argument, nullptr, 'p'},
+        {"workers",     required_argument, nullptr, 'w'},
+        {"reuseport",   no_argument,       nullptr, 'r'},
+        {"affinity",    required_argument, nullptr, 'a'},
+        {"backend",     required_argument, nullptr, 'b'},
+        {"tcp-nodelay", required_argument, nullptr, OPT_TCP_NODELAY},
+        {"sndbuf",      required_argument, nullptr, OPT_SNDBUF},
+        {"rcvbuf",      required_argument, nullptr, OPT_RCVBUF},
+        {"pool-slab",   required_argument, nullptr, OPT_POOL_SLAB},
+        {"pool-prealloc", required_argument, nullptr, OPT_POOL_PREALLOC},
+        {"stats-interval", required_argument, nullptr, OPT_STATS_INTERVAL},
+        {"zerocopy-threshold", required_argument, nullptr, OPT_ZEROCOPY_THRESHOLD},
+        {"log-level",   required_argument, nullptr, OPT_LOG_LEVEL},
+        {"admin-port",  required_argument, nullptr, OPT_ADMIN_PORT},
+        {"max-message", required_argument, nullptr, OPT_MAX_MESSAGE},
+        {"output-high-water", required_argument, nullptr, OPT_OUTPUT_HIGH_WATER},
+        {"write-timeout", required_argument, nullptr, OPT_WRITE_TIMEOUT},
+        {"idle-timeout", required_argument, nullptr, OPT_IDLE_TIMEOUT},
+        {"backlog",     required_argument, nullptr, OPT_BACKLOG},
+        {"accept-budget", required_argument, nullptr, OPT_ACCEPT_BUDGET},
+        {"defer-accept", required_argument, nullptr, OPT_DEFER_ACCEPT},
+        {"drain-timeout", required_argument, nullptr, OPT_DRAIN_TIMEOUT},
+        {"handoff",     required_argument, nullptr, OPT_HANDOFF},
+        {"unix",        required_argument, nullptr, OPT_UNIX},
+        {"shm",         required_argument, nullptr, OPT_SHM},
+        {"shm-ring-size", required_argument, nullptr, OPT_SHM_RING_SIZE},
+        {"poll",        required_argument, nullptr, OPT_POLL},
+        {"poll-spin",   required_argument, nullptr, OPT_POLL_SPIN},
+        {"busy-poll",   required_argument, nullptr, OPT_BUSY_POLL},
+        {"prefer-busy-poll", no_argument,  nullptr, OPT_PREFER_BUSY_POLL},
+        {"event-budget", required_argument, nullptr, OPT_EVENT_BUDGET},
+        {"event-frames", required_argument, nullptr, OPT_EVENT_FRAMES},
+        {"tcp-weight",  required_argument, nullptr, OPT_TCP_WEIGHT},
+        {"unix-weight", required_argument, nullptr, OPT_UNIX_WEIGHT},
+        {"max-connections", required_argument, nullptr, OPT_MAX_CONNECTIONS},
+        {"max-per-ip",  required_argument, nullptr, OPT_MAX_PER_IP},
+        {"max-inflight", required_argument, nullptr, OPT_MAX_INFLIGHT},
+        {"numa",        no_argument,       nullptr, OPT_NUMA},
+        {"trace-sample", required_argument, nullptr, OPT_TRACE_SAMPLE},
+        {"trace-capacity", required_argument, nullptr, OPT_TRACE_CAPACITY},
+        {"trace-file",  required_argument, nullptr, OPT_TRACE_FILE},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;  // 存储getopt_long的返回值（解析到的选项）
+    while ((opt = getopt_long(argc, argv, "p:w:ra:b:", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p':  // 监听端口（-p）
+                config.port = std::stoi(optarg);
+                break;
+            case 'w':  // 工作线程数（-w，0表示按CPU核数）
+                config.worker_threads = std::stoi(optarg);
+                break;
+            case 'r':  // 多reactor模式（-r，每个线程独立epoll+SO_REUSEPORT监听）
+                config.reuseport = true;
+                break;
+            case 'a':  // CPU亲和性（-a 0,1,2,3，第i个线程绑定到第i个CPU）
+                config.cpu_list = parse_cpu_list(optarg);
+                break;
+            case 'b':  // IO后端（-b epoll|uring）
+                if (std::string(optarg) == "epoll") {
+                    config.backend = IoBackend::EPOLL;
+                } else if (std::string(optarg) == "uring" || std::string(optarg) == "io_uring") {
+                    config.backend = IoBackend::URING;
+                } else {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_TCP_NODELAY:  // 是否对已接受连接开启TCP_NODELAY
+                config.tcp_nodelay = std::stoi(optarg) != 0;
+                break;
+            case OPT_SNDBUF:  // 已接受连接的发送缓冲区大小
+                config.sndbuf = std::stoi(optarg);
+                break;
+            case OPT_RCVBUF:  // 已接受连接的接收缓冲区大小
+                config.rcvbuf = std::stoi(optarg);
+                break;
+            case OPT_POOL_SLAB:  // 缓冲池每个slab的缓冲区数
+                config.pool_slab_buffers = std::stoi(optarg);
+                break;
+            case OPT_POOL_PREALLOC:  // 每个工作线程预分配的缓冲区数
+                config.pool_prealloc = std::stoi(optarg);
+                break;
+            case OPT_STATS_INTERVAL:  // 统计日志输出间隔（秒）
+                config.stats_interval = std::stoi(optarg);
+                break;
+            case OPT_ZEROCOPY_THRESHOLD:  // 大报文零拷贝回射的数据长度阈值（0表示关闭）
+                config.zerocopy_threshold = std::stoi(optarg);
+                break;
+            case OPT_LOG_LEVEL: {  // 运行时日志级别（默认info，debug输出每条报文的细节）
+                LogLevel level;
+                if (!Logger::parse_level(optarg, level)) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                Logger::set_level(level);
+                break;
+            }
+            case OPT_ADMIN_PORT:  // 管理端口（GET /metrics，0表示关闭）
+                config.admin_port = std::stoi(optarg);
+                break;
+            case OPT_MAX_MESSAGE: {  // 允许的最大数据长度（超过BUFFER_SIZE的报文流式回射）
+                long long size = std::stoll(optarg);
+                if (size <= 0 || size > UINT32_MAX) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                config.max_message_size = static_cast<uint32_t>(size);
+                break;
+            }
+            case OPT_OUTPUT_HIGH_WATER:  // 待回射数据的高水位（达到后暂停读取）
+                config.output_high_water = std::stoi(optarg);
+                break;
+            case OPT_WRITE_TIMEOUT:  // 写阻塞超时（秒，0表示不限制）
+                config.write_timeout = std::stoi(optarg);
+                break;
+            case OPT_IDLE_TIMEOUT:  // 空闲超时（秒，0表示不限制）
+                config.idle_timeout = std::stoi(optarg);
+                break;
+            case OPT_BACKLOG:  // 监听队列长度
+                config.listen_backlog = std::stoi(optarg);
+                break;
+            case OPT_ACCEPT_BUDGET:  // 每轮事件循环最多接受的新连接数（0表示不限制）
+                config.accept_budget = std::stoi(optarg);
+                break;
+            case OPT_DEFER_ACCEPT:  // TCP_DEFER_ACCEPT秒数（0表示关闭）
+                config.defer_accept = std::stoi(optarg);
+                break;
+            case OPT_DRAIN_TIMEOUT:  // 优雅关闭的排空超时（秒）
+                config.drain_timeout = std::stoi(optarg);
+                break;
+            case OPT_HANDOFF:  // 热重启交接套接字路径（新旧进程使用同一路径）
+                config.handoff_path = optarg;
+                break;
+            case OPT_UNIX:  // 额外的Unix域监听套接字路径
+                config.unix_path = optarg;
+                break;
+            case OPT_SHM:  // 共享内存传输的套接字路径（客户端连接该路径建立通道）
+                config.shm_path = optarg;
+                break;
+            case OPT_SHM_RING_SIZE: {  // 共享内存通道单个环的大小（2的幂，至少一页）
+                long long size = std::stoll(optarg);
+                if (size < 4096 || size > (1ll << 30) || (size & (size - 1)) != 0) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                config.shm_ring_size = static_cast<size_t>(size);
+                break;
+            }
+            case OPT_POLL:  // 事件循环的轮询策略（阻塞、有事件后继续轮询一段时间、始终轮询）
+                if (std::string(optarg) == "block") {
+                    config.poll_mode = PollMode::BLOCK;
+                } else if (std::string(optarg) == "spin") {
+                    config.poll_mode = PollMode::SPIN;
+                } else if (std::string(optarg) == "busy") {
+                    config.poll_mode = PollMode::BUSY;
+                } else {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_POLL_SPIN:  // SPIN策略下有事件后继续轮询的时长（微秒）
+                config.poll_spin_us = std::stoi(optarg);
+                break;
+            case OPT_BUSY_POLL:  // 内核忙轮询时长（微秒，0表示关闭）
+                config.busy_poll_us = std::stoi(optarg);
+                break;
+            case OPT_PREFER_BUSY_POLL:  // 忙轮询期间抑制网卡软中断
+                config.prefer_busy_poll = true;
+                break;
+            case OPT_EVENT_BUDGET:  // 一个连接每轮最多读取的字节数（0表示不限制）
+                config.event_budget = std::stoi(optarg);
+                break;
+            case OPT_EVENT_FRAMES:  // 一个连接每轮最多回射的报文数（0表示不限制）
+                config.event_frame_budget = std::stoi(optarg);
+                break;
+            case OPT_TCP_WEIGHT:  // TCP连接的调度权重（每轮预算的倍数）
+            case OPT_UNIX_WEIGHT: {  // Unix域连接的调度权重
+                int weight = std::stoi(optarg);
+                if (weight < 1 || weight > 1000) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                (opt == OPT_TCP_WEIGHT ? config.tcp_weight : config.unix_weight) = weight;
+                break;
+            }
+            case OPT_MAX_CONNECTIONS:  // 总连接数上限（0表示不限制）
+                config.max_connections = std::stoi(optarg);
+                break;
+            case OPT_MAX_PER_IP:  // 单个来源IP的连接数上限（0表示不限制）
+                config.max_connections_per_ip = std::stoi(optarg);
+                break;
+            case OPT_MAX_INFLIGHT:  // 待回射字节数上限（0表示不限制）
+                config.max_inflight_bytes = std::stoll(optarg);
+                break;
+            case OPT_NUMA:  // 按NUMA节点放置工作线程并就近分配连接
+                config.numa = true;
+                break;
+            case OPT_TRACE_SAMPLE:  // 每N条报文抽样追踪一条（0表示关闭）
+                config.trace_sample = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case OPT_TRACE_CAPACITY:  // 每个工作线程保留的追踪记录数
+                config.trace_capacity = std::stoi(optarg);
+                if (config.trace_capacity <= 0) {
+                    print_usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            case OPT_TRACE_FILE:  // SIGUSR1导出追踪记录的文件
+                config.trace_file = optarg;
+                break;
+            default:  // 未知选项
+                print_usage(argv[0]);
+                exit(1);
+        }
+    }
+}
 
 // 服务器程序入口函数
-int main() {
+int main(int argc, char* argv[]) {
+    ServerConfig config;  // 服务端配置对象（使用默认值初始化）
+    parse_args(argc, argv, config);  // 解析命令行参数更新配置
+    EchoServer::block_signals();  // 关闭信号只由服务器的事件循环处理（先于创建任何线程）
+    Logger::start();  // 日志改由后台线程批量输出
+
     try {
-        // 初始化EchoServer对象，指定监听端口为默认端口（15000）
-        EchoServer server(DEFAULT_PORT);
+        // 初始化EchoServer对象，传入配置
+        EchoServer server(config);
         // 启动服务器（进入事件循环，开始监听和处理连接）
         server.start();
     } catch (const std::exception& e) {
         // 捕获并输出服务器运行过程中的异常
-        log_error("Server exception: " + std::string(e.what()));
+        LOG_ERROR("Server exception: %s", e.what());
+        Logger::stop();
         return 1;  // 异常退出，返回非0状态码
     }
+    Logger::stop();  // 输出剩余日志
     return 0;  // 正常退出
-}
\ No newline at end of file
+}
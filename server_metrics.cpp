@@ -0,0 +1,132 @@
+#include "server_metrics.h"
+#include <cstdarg>            // 用于可变参数
+#include <cstdio>             // 用于vsnprintf
+
+const int StageHistogram::BUCKETS;
+
+namespace {
+
+// 计数器的导出描述：同名指标的不同计数器以一个额外标签区分
+struct CounterDesc
+{
+    ServerCounter counter;    // 计数器下标
+    const char* name;         // 指标名
+    const char* help;         // 说明
+    const char* label;        // 额外标签（"op=\"read\""等），nullptr表示无
+};
+
+const CounterDesc COUNTERS[] = {
+    {SRV_ACCEPTS, "echo_accepted_connections_total", "Connections adopted by the worker.", nullptr},
+    {SRV_CLOSES, "echo_closed_connections_total", "Connections closed by the worker.", nullptr},
+    {SRV_FRAMES, "echo_frames_total", "Frames echoed.", nullptr},
+    {SRV_BYTES_IN, "echo_received_bytes_total", "Bytes received from clients.", nullptr},
+    {SRV_BYTES_OUT, "echo_sent_bytes_total", "Bytes written back to clients.", nullptr},
+    {SRV_READ_EAGAIN, "echo_eagain_total", "Reads and writes that returned EAGAIN.", "op=\"read\""},
+    {SRV_WRITE_EAGAIN, "echo_eagain_total", nullptr, "op=\"write\""},
+    {SRV_HEADER_TIMEOUTS, "echo_timeouts_total", "Connections closed by read or write timeouts.", "stage=\"header\""},
+    {SRV_DATA_TIMEOUTS, "echo_timeouts_total", nullptr, "stage=\"data\""},
+    {SRV_WRITE_TIMEOUTS, "echo_timeouts_total", nullptr, "stage=\"write\""},
+    {SRV_IDLE_TIMEOUTS, "echo_timeouts_total", nullptr, "stage=\"idle\""},
+    {SRV_DRAIN_TIMEOUTS, "echo_timeouts_total", nullptr, "stage=\"drain\""},
+    {SRV_DRAINED, "echo_drained_connections_total", "Connections closed cleanly at a frame boundary while draining.", nullptr},
+    {SRV_BAD_MAGIC, "echo_rejected_frames_total", "Frames rejected by header validation.", "reason=\"magic\""},
+    {SRV_BAD_LENGTH, "echo_rejected_frames_total", nullptr, "reason=\"length\""},
+    {SRV_BAD_CHECKSUM, "echo_rejected_frames_total", nullptr, "reason=\"checksum\""},
+    {SRV_BAD_HEADER, "echo_rejected_frames_total", nullptr, "reason=\"header\""},
+    {SRV_POLL_BLOCKING, "echo_poll_waits_total", "Event loop waits by whether they were allowed to block.", "mode=\"blocking\""},
+    {SRV_POLL_SPINS, "echo_poll_waits_total", nullptr, "mode=\"spin\""},
+    {SRV_POLL_EMPTY_SPINS, "echo_poll_empty_spins_total", "Non-blocking polls that found no events.", nullptr},
+    {SRV_BUDGET_YIELDS, "echo_budget_yields_total", "Times a connection used up its per-turn budget and was requeued.", nullptr},
+    {SRV_READ_THROTTLED, "echo_read_throttled_total", "Times reading a connection was paused because the worker held too many unsent bytes.", nullptr},
+    {SRV_NUMA_LOCAL, "echo_numa_connections_total", "New connections by whether their receive CPU is on the worker's NUMA node.", "locality=\"local\""},
+    {SRV_NUMA_REMOTE, "echo_numa_connections_total", nullptr, "locality=\"remote\""},
+};
+
+const char* const STAGE_NAMES[STAGE_COUNT] = {"read", "parse", "write", "write_blocked"};
+
+// 追加一行格式化文本
+void appendf(std::string& out, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+void appendf(std::string& out, const char* fmt, ...) {
+    char line[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n > 0) out.append(line, static_cast<size_t>(n) < sizeof(line) ? n : sizeof(line) - 1);
+}
+
+} // namespace
+
+// 渲染Prometheus文本格式
+// 说明：计数器逐个读取（relaxed），同一次抓取中各计数器之间不保证是同一时刻的快照
+void render_prometheus(const std::vector<const ServerMetrics*>& workers,
+                       const std::vector<BufferPoolStats>& pools, std::string& out) {
+    for (const CounterDesc& desc : COUNTERS) {
+        if (desc.help != nullptr) {  // 同名指标只输出一次HELP/TYPE
+            appendf(out, "# HELP %s %s\n# TYPE %s counter\n", desc.name, desc.help, desc.name);
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            appendf(out, "%s{worker=\"%zu\"%s%s} %llu\n", desc.name, i, desc.label ? "," : "",
+                    desc.label ? desc.label : "",
+                    static_cast<unsigned long long>(workers[i]->counters.get(desc.counter)));
+        }
+    }
+
+    appendf(out, "# HELP echo_active_connections Connections currently open.\n"
+                 "# TYPE echo_active_connections gauge\n");
+    for (size_t i = 0; i < workers.size(); ++i) {
+        uint64_t accepts = workers[i]->counters.get(SRV_ACCEPTS);
+        uint64_t closes = workers[i]->counters.get(SRV_CLOSES);
+        appendf(out, "echo_active_connections{worker=\"%zu\"} %llu\n", i,
+                static_cast<unsigned long long>(accepts > closes ? accepts - closes : 0));
+    }
+
+    appendf(out, "# HELP echo_worker_numa_node NUMA node the worker and its buffers are placed on (-1 = not placed).\n"
+                 "# TYPE echo_worker_numa_node gauge\n");
+    for (size_t i = 0; i < workers.size(); ++i) {
+        appendf(out, "echo_worker_numa_node{worker=\"%zu\"} %d\n", i, workers[i]->numa_node);
+    }
+
+    appendf(out, "# HELP echo_buffer_pool_acquires_total Buffer pool acquires by whether the free list had a buffer.\n"
+                 "# TYPE echo_buffer_pool_acquires_total counter\n");
+    for (size_t i = 0; i < pools.size(); ++i) {
+        appendf(out, "echo_buffer_pool_acquires_total{worker=\"%zu\",result=\"hit\"} %llu\n", i,
+                static_cast<unsigned long long>(pools[i].hits));
+        appendf(out, "echo_buffer_pool_acquires_total{worker=\"%zu\",result=\"miss\"} %llu\n", i,
+                static_cast<unsigned long long>(pools[i].misses));
+    }
+    appendf(out, "# HELP echo_buffer_pool_buffers_in_use Buffers currently held by connections.\n"
+                 "# TYPE echo_buffer_pool_buffers_in_use gauge\n");
+    for (size_t i = 0; i < pools.size(); ++i) {
+        appendf(out, "echo_buffer_pool_buffers_in_use{worker=\"%zu\"} %llu\n", i,
+                static_cast<unsigned long long>(pools[i].in_use));
+    }
+    appendf(out, "# HELP echo_buffer_pool_buffers_capacity Buffers allocated by the pool (in use or free).\n"
+                 "# TYPE echo_buffer_pool_buffers_capacity gauge\n");
+    for (size_t i = 0; i < pools.size(); ++i) {
+        appendf(out, "echo_buffer_pool_buffers_capacity{worker=\"%zu\"} %llu\n", i,
+                static_cast<unsigned long long>(pools[i].capacity));
+    }
+
+    appendf(out, "# HELP echo_stage_duration_seconds Time spent per stage of client data handling.\n"
+                 "# TYPE echo_stage_duration_seconds histogram\n");
+    for (size_t i = 0; i < workers.size(); ++i) {
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            const StageHistogram& h = workers[i]->stages[stage];
+            uint64_t cumulative = 0;
+            for (int b = 0; b < StageHistogram::BUCKETS; ++b) {
+                cumulative += h.bucket(b);
+                appendf(out, "echo_stage_duration_seconds_bucket{worker=\"%zu\",stage=\"%s\",le=\"%g\"} %llu\n",
+                        i, STAGE_NAMES[stage], 1e-6 * (1u << b), static_cast<unsigned long long>(cumulative));
+            }
+            cumulative += h.bucket(StageHistogram::BUCKETS);
+            appendf(out, "echo_stage_duration_seconds_bucket{worker=\"%zu\",stage=\"%s\",le=\"+Inf\"} %llu\n",
+                    i, STAGE_NAMES[stage], static_cast<unsigned long long>(cumulative));
+            appendf(out, "echo_stage_duration_seconds_sum{worker=\"%zu\",stage=\"%s\"} %.9f\n",
+                    i, STAGE_NAMES[stage], h.sum_ns() / 1e9);
+            appendf(out, "echo_stage_duration_seconds_count{worker=\"%zu\",stage=\"%s\"} %llu\n",
+                    i, STAGE_NAMES[stage], static_cast<unsigned long long>(cumulative));
+        }
+    }
+}
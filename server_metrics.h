@@ -0,0 +1,100 @@
+#ifndef SERVER_METRICS_H
+#define SERVER_METRICS_H
+
+#include "buffer_pool.h"          // 包含缓冲池统计
+#include "per_thread_counters.h"  // 包含单线程统计计数块
+#include <chrono>                 // 用于阶段计时
+#include <string>                 // 用于指标文本
+#include <vector>                 // 用于汇总各工作线程
+
+// 服务端计数器下标
+enum ServerCounter
+{
+    SRV_ACCEPTS,          // 接管的连接数
+    SRV_CLOSES,           // 关闭的连接数（活跃连接数 = 接管数 - 关闭数）
+    SRV_FRAMES,           // 回射的报文数
+    SRV_BYTES_IN,         // 接收字节数
+    SRV_BYTES_OUT,        // 写出字节数
+    SRV_READ_EAGAIN,      // read返回EAGAIN的次数
+    SRV_WRITE_EAGAIN,     // 写返回EAGAIN（写被阻塞）的次数
+    SRV_HEADER_TIMEOUTS,  // 报文头读取超时关闭的连接数
+    SRV_DATA_TIMEOUTS,    // 数据读取超时关闭的连接数
+    SRV_WRITE_TIMEOUTS,   // 写阻塞超时关闭的连接数（慢消费者）
+    SRV_IDLE_TIMEOUTS,    // 空闲超时关闭的连接数
+    SRV_DRAINED,          // 排空时在报文边界处关闭的连接数
+    SRV_DRAIN_TIMEOUTS,   // 排空超时强制关闭的连接数（可能丢弃未完成的报文）
+    SRV_BAD_MAGIC,        // 魔数错误的报文数
+    SRV_BAD_LENGTH,       // 长度非法的报文数
+    SRV_BAD_CHECKSUM,     // 报文头CRC32C不匹配的v2报文数
+    SRV_BAD_HEADER,       // 报文头字段非法的v2报文数
+    SRV_POLL_BLOCKING,    // 允许阻塞的等待次数（epoll_wait超时不为0，或io_uring等待完成事件）
+    SRV_POLL_SPINS,       // 轮询策略（SPIN/BUSY）选择不阻塞的等待次数
+    SRV_POLL_EMPTY_SPINS, // 没有等到任何事件的轮询次数（空转）
+    SRV_BUDGET_YIELDS,    // 连接用完一轮预算、让出后进入就绪队列的次数
+    SRV_READ_THROTTLED,   // 本线程待回射字节数达到上限、暂停读取连接的次数
+    SRV_NUMA_LOCAL,       // 接收CPU与本线程位于同一NUMA节点的新连接数（仅--numa）
+    SRV_NUMA_REMOTE,      // 接收CPU位于其他NUMA节点的新连接数（跨节点访问）
+    SRV_COUNTER_COUNT
+};
+
+// handle_client_data各阶段（io_uring后端的对应关系见UringWorker）
+enum ServerStage
+{
+    STAGE_READ,           // read系统调用
+    STAGE_PARSE,          // 校验切分报文并生成回射列表
+    STAGE_WRITE,          // writev系统调用（io_uring：链式send从提交到全部完成）
+    STAGE_WRITE_BLOCKED,  // 写被阻塞到回射全部写出的等待时间（写回背压）
+    STAGE_COUNT
+};
+
+// 阶段耗时直方图：按2的幂划分的固定桶（1us到约1s），与Prometheus的histogram类型一一对应
+// 说明：计数存放在单线程统计块中，只由所属工作线程写入，指标线程随时读取
+class StageHistogram
+{
+public:
+    static const int BUCKETS = 21;            // 有限桶数：上界为 1us * 2^i（i = 0..20）
+
+private:
+    // 下标0..BUCKETS-1为有限桶，BUCKETS为+Inf桶，BUCKETS+1为耗时之和（纳秒）
+    PerThreadCounters<BUCKETS + 2> values;
+
+public:
+    // 记录一次耗时
+    // 参数：ns - 耗时（纳秒）
+    void record(uint64_t ns) {
+        int index = ns <= 1000 ? 0 : 64 - __builtin_clzll((ns - 1) / 1000);
+        values.add(index < BUCKETS ? index : BUCKETS);
+        values.add(BUCKETS + 1, ns);
+    }
+
+    // 记录从start到现在的耗时
+    void record_since(std::chrono::steady_clock::time_point start) {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+
+    // 读取桶计数（非累计；index == BUCKETS为+Inf桶）
+    uint64_t bucket(int index) const { return values.get(index); }
+
+    // 读取耗时之和（纳秒）
+    uint64_t sum_ns() const { return values.get(BUCKETS + 1); }
+};
+
+// 单个工作线程的指标：计数器和各阶段耗时直方图
+// 注：由所属工作线程更新（relaxed写入，无锁、无共享缓存行），指标线程只读
+struct ServerMetrics
+{
+    PerThreadCounters<SRV_COUNTER_COUNT> counters;
+    StageHistogram stages[STAGE_COUNT];
+    int numa_node = -1;       // 工作线程所属的NUMA节点（启动前设置，之后不变；-1表示不按节点放置）
+};
+
+// 把各工作线程的指标渲染为Prometheus文本格式（text/plain; version=0.0.4）
+// 参数：
+//   workers - 各工作线程的指标（下标即worker标签）
+//   pools - 各工作线程的缓冲池统计（与workers一一对应）
+//   out - 输出参数，指标文本追加到其中
+void render_prometheus(const std::vector<const ServerMetrics*>& workers,
+                       const std::vector<BufferPoolStats>& pools, std::string& out);
+
+#endif // SERVER_METRICS_H
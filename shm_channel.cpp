@@ -0,0 +1,256 @@
+#include "shm_channel.h"
+#include "common.h"           // 用于日志宏
+#include <sys/mman.h>         // 用于memfd_create/mmap
+#include <sys/socket.h>       // 用于sendmsg/recvmsg和SCM_RIGHTS
+#include <sys/eventfd.h>      // 用于唤醒对端
+#include <sys/time.h>         // 用于SO_RCVTIMEO超时
+#include <sys/stat.h>         // 用于fstat校验memfd大小
+#include <sys/un.h>           // 用于Unix域地址结构（sockaddr_un）
+#include <fcntl.h>            // 用于memfd封印
+#include <unistd.h>           // 用于close/ftruncate
+#include <errno.h>            // 用于错误码
+#include <cstring>            // 用于memset/memcpy
+
+namespace {
+
+const int SETUP_FDS = 3;               // 建立通道时传递的fd：memfd、服务端eventfd、客户端eventfd
+const int RECEIVE_TIMEOUT_SEC = 5;     // 客户端等待服务端建立通道的超时
+
+// 建立通道的消息（数据部分，fd放在SCM_RIGHTS控制消息中）
+struct ShmSetup
+{
+    uint32_t magic;                    // SHM_MAGIC
+    uint32_t version;                  // SHM_VERSION
+    uint64_t ring_size;                // 单个环的大小
+};
+
+// 控制区占用的长度（按页对齐，数据区从页边界开始，才能映射两次）
+size_t control_length() {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (sizeof(ShmControl) + page - 1) / page * page;
+}
+
+// 环大小是否合法：2的幂且为页大小的整数倍
+bool valid_ring_size(uint64_t ring_size) {
+    uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return ring_size >= page && (ring_size & (ring_size - 1)) == 0;
+}
+
+} // namespace
+
+// 构造函数：未映射的通道
+ShmChannel::ShmChannel()
+    : side(SHM_SERVER), control(nullptr), mapping_len(0), wait_fd(-1), peer_fd(-1) {}
+
+// 析构函数：解除映射并关闭eventfd
+ShmChannel::~ShmChannel() {
+    close();
+}
+
+// 解除映射并关闭持有的eventfd
+void ShmChannel::close() {
+    if (control != nullptr) {
+        munmap(control, mapping_len);
+        control = nullptr;
+    }
+    if (wait_fd != -1) {
+        ::close(wait_fd);
+        wait_fd = -1;
+    }
+    if (peer_fd != -1) {
+        ::close(peer_fd);
+        peer_fd = -1;
+    }
+}
+
+// 映射memfd：先预留整段地址空间，再把控制区和两个数据区（各两次）映射到固定位置
+// 参数：
+//   memfd - 通道的memfd
+//   ring_size - 单个环的大小
+// 返回：true成功，false失败
+bool ShmChannel::map(int memfd, size_t ring_size) {
+    size_t ctl_len = control_length();
+    size_t total = ctl_len + 4 * ring_size;  // 每个环的数据区占两倍地址空间
+    void* base = mmap(nullptr, total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR_RL("Shm reserve %zu bytes failed (errno: %d)", total, errno);
+        return false;
+    }
+    char* addr = static_cast<char*>(base);
+    bool ok = mmap(addr, ctl_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memfd, 0) != MAP_FAILED;
+    for (int r = 0; ok && r < 2; ++r) {
+        char* ring_base = addr + ctl_len + 2 * ring_size * r;
+        off_t offset = static_cast<off_t>(ctl_len + ring_size * r);
+        ok = mmap(ring_base, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memfd, offset) != MAP_FAILED &&
+             mmap(ring_base + ring_size, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memfd,
+                  offset) != MAP_FAILED;
+    }
+    if (!ok) {
+        LOG_ERROR_RL("Shm map failed (errno: %d)", errno);
+        munmap(base, total);
+        return false;
+    }
+
+    control = static_cast<ShmControl*>(base);
+    mapping_len = total;
+    ShmRing& request = side == SHM_SERVER ? rx : tx;
+    ShmRing& response = side == SHM_SERVER ? tx : rx;
+    request.bind(&control->rings[0], addr + ctl_len, ring_size);
+    response.bind(&control->rings[1], addr + ctl_len + 2 * ring_size, ring_size);
+    return true;
+}
+
+// 服务端：创建通道并发给客户端
+// 参数：
+//   sock_fd - 与客户端的Unix域连接
+//   ring_size - 单个环的大小
+//   server_wait_fd - 服务端等待的eventfd
+// 返回：true成功，false失败
+bool ShmChannel::offer(int sock_fd, size_t ring_size, int server_wait_fd) {
+    side = SHM_SERVER;
+    int memfd = memfd_create("echo-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd == -1) {
+        LOG_ERROR_RL("Shm memfd_create failed (errno: %d)", errno);
+        return false;
+    }
+    // 固定文件大小：客户端持有同一个memfd，缩小文件会让服务端访问映射时收到SIGBUS
+    if (ftruncate(memfd, static_cast<off_t>(control_length() + 2 * ring_size)) == -1 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1 || !map(memfd, ring_size)) {
+        LOG_ERROR_RL("Shm channel setup failed (errno: %d)", errno);
+        ::close(memfd);
+        return false;
+    }
+    control->magic = SHM_MAGIC;
+    control->version = SHM_VERSION;
+    control->ring_size = ring_size;
+
+    peer_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (peer_fd == -1) {
+        LOG_ERROR_RL("Shm eventfd create failed (errno: %d)", errno);
+        ::close(memfd);
+        return false;
+    }
+
+    // 发送建立通道的消息：刚接受的连接发送缓冲区为空，非阻塞sendmsg不会返回EAGAIN
+    ShmSetup setup;
+    setup.magic = SHM_MAGIC;
+    setup.version = SHM_VERSION;
+    setup.ring_size = ring_size;
+    struct iovec iov;
+    iov.iov_base = &setup;
+    iov.iov_len = sizeof(setup);
+    int fds[SETUP_FDS] = {memfd, server_wait_fd, peer_fd};
+    char control_buf[CMSG_SPACE(sizeof(fds))];
+    memset(control_buf, 0, sizeof(control_buf));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control_buf;
+    msg.msg_controllen = sizeof(control_buf);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t n;
+    while ((n = sendmsg(sock_fd, &msg, MSG_NOSIGNAL)) == -1 && errno == EINTR) {}
+    int err = errno;
+    ::close(memfd);  // 映射和客户端持有的副本使共享内存继续存在
+    if (n != static_cast<ssize_t>(sizeof(setup))) {
+        LOG_ERROR_RL("Shm setup send failed (fd: %d, errno: %d)", sock_fd, n == -1 ? err : 0);
+        return false;
+    }
+    return true;
+}
+
+// 客户端：连接服务端并接收通道
+// 参数：
+//   path - 共享内存套接字路径
+//   sock_fd - 输出参数，与服务端的Unix域连接
+// 返回：true成功，false失败
+bool ShmChannel::connect(const std::string& path, int& sock_fd) {
+    side = SHM_CLIENT;
+    sock_fd = -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Shm path too long: %s", path.c_str());
+        return false;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR_RL("Shm socket creation failed (errno: %d)", errno);
+        return false;
+    }
+    struct timeval tv;
+    tv.tv_sec = RECEIVE_TIMEOUT_SEC;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+        LOG_ERROR_RL("Shm connect to %s failed (errno: %d)", path.c_str(), errno);
+        ::close(fd);
+        return false;
+    }
+
+    ShmSetup setup;
+    struct iovec iov;
+    iov.iov_base = &setup;
+    iov.iov_len = sizeof(setup);
+    char control_buf[CMSG_SPACE(sizeof(int) * SETUP_FDS)];
+    memset(control_buf, 0, sizeof(control_buf));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control_buf;
+    msg.msg_controllen = sizeof(control_buf);
+
+    ssize_t n;
+    while ((n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL)) == -1 && errno == EINTR) {}
+    int err = errno;
+    int fds[SETUP_FDS] = {-1, -1, -1};
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (n > 0 && cmsg != nullptr && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(fds))) {
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+    bool ok = n == static_cast<ssize_t>(sizeof(setup)) && fds[0] != -1 && setup.magic == SHM_MAGIC &&
+              setup.version == SHM_VERSION && valid_ring_size(setup.ring_size);
+    struct stat st;
+    if (ok) {  // 文件大小必须与声明的环大小一致，否则映射越界
+        ok = fstat(fds[0], &st) == 0 &&
+             static_cast<uint64_t>(st.st_size) == control_length() + 2 * setup.ring_size &&
+             map(fds[0], static_cast<size_t>(setup.ring_size));
+    }
+    if (fds[0] != -1) ::close(fds[0]);
+    if (!ok) {
+        LOG_ERROR_RL("Shm setup from %s failed (errno: %d)", path.c_str(), n == -1 ? err : 0);
+        if (fds[1] != -1) ::close(fds[1]);
+        if (fds[2] != -1) ::close(fds[2]);
+        ::close(fd);
+        return false;
+    }
+    peer_fd = fds[1];
+    wait_fd = fds[2];
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    sock_fd = fd;
+    return true;
+}
+
+// 唤醒对端：与prepare_wait构成Dekker式的先写后读，
+// 保证"本端推进位置"与"对端置位标志后重新检查"至少有一方看到另一方的写入，唤醒不会丢失
+void ShmChannel::notify_peer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::atomic<uint32_t>& flag = control->waiting[side == SHM_SERVER ? SHM_CLIENT : SHM_SERVER].value;
+    if (flag.load(std::memory_order_relaxed) == 0 || flag.exchange(0, std::memory_order_relaxed) == 0) return;
+    uint64_t one = 1;
+    if (write(peer_fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        LOG_ERROR_RL("Shm wakeup failed (errno: %d)", errno);
+    }
+}
@@ -0,0 +1,177 @@
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+// 同机共享内存传输：每个客户端一对单生产者/单消费者字节环（请求环：客户端→服务端；
+// 回射环：服务端→客户端），位于同一个memfd中。服务端在共享内存套接字（Unix域）上接受连接后
+// 创建memfd，连同两个eventfd经SCM_RIGHTS交给客户端；之后数据只经共享内存传递，
+// 该Unix域连接只用于发现对端退出。环中传输的字节流与TCP连接完全相同（v1/v2报文），
+// 服务端用同一套报文切分逻辑处理（见protocol.h）
+// 说明：每个环的数据区在虚拟地址上连续映射两次，跨越环尾的数据也是一段连续内存，
+//       报文可以直接在环中解析、整段拷贝，无需处理回绕。
+//       一端没有可处理的数据、准备睡眠时先置位本端的等待标志并重新检查环，对端每次推进环的位置后
+//       检查该标志，置位时才写eventfd唤醒；双方都在忙时收发不产生任何系统调用
+
+#include <atomic>                 // 用于跨进程的环位置和等待标志
+#include <string>                 // 用于套接字路径
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于固定宽度整数类型
+
+// 控制区魔数（"SHME"），与通道版本一起放在控制区开头和建立通道的消息中
+const uint32_t SHM_MAGIC = 0x53484D45;
+
+// 通道版本：控制区布局变化时递增，客户端拒绝不认识的版本
+const uint32_t SHM_VERSION = 1;
+
+// 通道的两端（下标用于等待标志）
+enum ShmSide
+{
+    SHM_CLIENT = 0,
+    SHM_SERVER = 1
+};
+
+// 单个环的读写位置：只增不减的字节计数，对环大小取模即为数据区偏移
+// 注：生产者只写tail、消费者只写head，两者位于不同的缓存行
+struct ShmRingControl
+{
+    alignas(64) std::atomic<uint64_t> head;   // 消费者已读出的字节数
+    alignas(64) std::atomic<uint64_t> tail;   // 生产者已写入的字节数
+};
+
+// 一端的等待标志（独占缓存行）
+struct alignas(64) ShmWaitFlag
+{
+    std::atomic<uint32_t> value;              // 非0表示该端已经或即将睡眠，推进环后需要唤醒它
+};
+
+// 控制区：位于memfd开头的第一页，之后依次是请求环和回射环的数据区
+struct ShmControl
+{
+    uint32_t magic;                           // SHM_MAGIC
+    uint32_t version;                         // SHM_VERSION
+    uint64_t ring_size;                       // 单个环的大小
+    ShmRingControl rings[2];                  // [0]请求环，[1]回射环
+    ShmWaitFlag waiting[2];                   // 各端的等待标志（下标为ShmSide）
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "shared memory rings require address-free lock-free atomics");
+
+// 字节环的单端视图：消费端使用readable/read_ptr/consume，生产端使用writable/write_ptr/produce
+// 说明：对端可以任意改写共享的位置计数，readable/writable都限制在环大小以内，
+//       错误的计数只会让该通道停滞或被报文校验拒绝，不会越界访问
+class ShmRing
+{
+private:
+    ShmRingControl* ctl;                      // 读写位置（位于共享内存）
+    char* data;                               // 数据区（连续映射两次）
+    size_t size;                              // 环大小（2的幂）
+
+public:
+    ShmRing() : ctl(nullptr), data(nullptr), size(0) {}
+
+    // 绑定到映射好的控制区和数据区
+    void bind(ShmRingControl* ctl, char* data, size_t size) {
+        this->ctl = ctl;
+        this->data = data;
+        this->size = size;
+    }
+
+    // 可读字节数（消费端）
+    size_t readable() const {
+        uint64_t used = ctl->tail.load(std::memory_order_acquire) - ctl->head.load(std::memory_order_relaxed);
+        return used <= size ? static_cast<size_t>(used) : size;
+    }
+
+    // 可读数据的起始地址，之后readable()字节连续可读（消费端）
+    const char* read_ptr() const {
+        return data + (ctl->head.load(std::memory_order_relaxed) & (size - 1));
+    }
+
+    // 读出n字节，腾出的空间交还生产端（消费端）
+    void consume(size_t n) {
+        ctl->head.store(ctl->head.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // 可写字节数（生产端）
+    size_t writable() const {
+        uint64_t used = ctl->tail.load(std::memory_order_relaxed) - ctl->head.load(std::memory_order_acquire);
+        return used <= size ? size - static_cast<size_t>(used) : 0;
+    }
+
+    // 可写空间的起始地址，之后writable()字节连续可写（生产端）
+    char* write_ptr() const {
+        return data + (ctl->tail.load(std::memory_order_relaxed) & (size - 1));
+    }
+
+    // 提交已写入的n字节（生产端）
+    void produce(size_t n) {
+        ctl->tail.store(ctl->tail.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    // 环大小
+    size_t capacity() const { return size; }
+};
+
+// 共享内存通道的一端：映射memfd，提供本端的接收环（rx）和发送环（tx），负责唤醒对端
+// 注：只被所属线程访问；对象不可复制，close()或析构时解除映射并关闭持有的eventfd
+class ShmChannel
+{
+private:
+    ShmSide side;                             // 本端
+    ShmControl* control;                      // 控制区（映射区的开头），未映射时为nullptr
+    size_t mapping_len;                       // 映射区总长度
+    ShmRing rx;                               // 本端消费的环
+    ShmRing tx;                               // 本端生产的环
+    int wait_fd;                              // 本端等待的eventfd（客户端持有；服务端为-1，由工作线程共用一个）
+    int peer_fd;                              // 唤醒对端的eventfd
+
+    // 按环大小映射memfd（控制区一次，两个数据区各连续两次）
+    // 返回：true成功，false失败（错误已记录日志）
+    bool map(int memfd, size_t ring_size);
+
+public:
+    ShmChannel();
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    // 服务端：创建通道并把memfd和两个eventfd发给刚接受的客户端
+    // 说明：memfd加了大小封印，客户端无法缩小文件让服务端访问映射时收到SIGBUS
+    // 参数：
+    //   sock_fd - 与客户端的Unix域连接
+    //   ring_size - 单个环的大小（2的幂，页大小的整数倍）
+    //   server_wait_fd - 服务端等待的eventfd（客户端写入以唤醒服务端）
+    // 返回：true成功，false失败（错误已记录日志，调用方应关闭连接）
+    bool offer(int sock_fd, size_t ring_size, int server_wait_fd);
+
+    // 客户端：连接服务端的共享内存套接字并接收通道
+    // 参数：
+    //   path - 服务端的共享内存套接字路径
+    //   sock_fd - 输出参数，与服务端的Unix域连接（非阻塞；服务端关闭通道后可读到EOF）
+    // 返回：true成功，false失败（错误已记录日志）
+    bool connect(const std::string& path, int& sock_fd);
+
+    // 解除映射并关闭持有的eventfd（未映射时无操作）
+    void close();
+
+    // 本端消费的环（服务端为请求环，客户端为回射环）
+    ShmRing& rx_ring() { return rx; }
+
+    // 本端生产的环（服务端为回射环，客户端为请求环）
+    ShmRing& tx_ring() { return tx; }
+
+    // 本端等待的eventfd（仅客户端）
+    int wait_event_fd() const { return wait_fd; }
+
+    // 准备睡眠：置位本端的等待标志；之后调用方必须重新检查环，确认无事可做后才能睡眠
+    void prepare_wait() {
+        control->waiting[side].value.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // 推进环的位置后调用：对端正在等待时清除其标志并写eventfd唤醒
+    void notify_peer();
+};
+
+#endif // SHM_CHANNEL_H
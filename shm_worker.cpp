@@ -0,0 +1,284 @@
+#include "shm_worker.h"
+#include "protocol.h"         // 用于报文切分
+#include <sys/epoll.h>        // 用于epoll事件驱动机制
+#include <sys/eventfd.h>      // 用于客户端唤醒本线程
+#include <sys/socket.h>       // 用于recv
+#include <unistd.h>           // 用于read/close等系统调用
+#include <errno.h>            // 用于错误码（errno）
+#include <algorithm>          // 用于std::min
+#include <cstring>            // 用于memcpy
+
+// 构造函数：初始化工作线程状态
+// 参数：
+//   id - 工作线程编号
+//   cfg - 服务端配置
+ShmWorker::ShmWorker(int id, const ServerConfig& cfg)
+    : WorkerBase(id, cfg), epoll_fd(-1), notify_fd(-1) {}
+
+// 析构函数：停止工作线程并关闭所有会话
+ShmWorker::~ShmWorker() {
+    stop();  // 先让事件循环退出，再清理会话
+    for (ShmSession* session : sessions) {
+        session->channel.close();
+        close_client_fd(session->fd);
+        table.release(session);
+    }
+    sessions.clear();
+    if (notify_fd != -1) close(notify_fd);
+    if (epoll_fd != -1) close(epoll_fd);
+}
+
+// 初始化epoll实例、唤醒用的eventfd和客户端共用的eventfd
+// 参数：listen_fd - 不使用
+// 返回：true成功，false失败
+bool ShmWorker::init(int listen_fd) {
+    this->listen_fd = listen_fd;
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        LOG_ERROR("Worker %d epoll create failed (errno: %d)", id, errno);
+        return false;
+    }
+    if (!create_wakeup_fd()) {
+        return false;
+    }
+    notify_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (notify_fd == -1) {
+        LOG_ERROR("Worker %d shm eventfd create failed (errno: %d)", id, errno);
+        return false;
+    }
+
+    // 会话的Unix域连接用data.ptr指向会话槽位，两个eventfd用成员变量地址作为标记
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &wakeup_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event) == -1) {
+        LOG_ERROR("Worker %d epoll add wakeup_fd failed", id);
+        return false;
+    }
+    event.data.ptr = &notify_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, notify_fd, &event) == -1) {
+        LOG_ERROR("Worker %d epoll add notify_fd failed", id);
+        return false;
+    }
+    return true;
+}
+
+// 接管新连接：为每个连接建立共享内存通道
+void ShmWorker::adopt_pending() {
+    for (int sock_fd : take_pending()) {
+        open_session(sock_fd);
+    }
+}
+
+// 为新连接创建通道并发给客户端
+// 参数：sock_fd - 与客户端的Unix域连接
+void ShmWorker::open_session(int sock_fd) {
+    ShmSession* session = table.open(sock_fd, nullptr);
+    if (session == nullptr) {
+        LOG_ERROR_RL("Connection table full (fd: %d)", sock_fd);
+        close_client_fd(sock_fd);
+        return;
+    }
+    if (!session->channel.offer(sock_fd, config.shm_ring_size, notify_fd)) {
+        table.release(session);
+        close_client_fd(sock_fd);
+        return;
+    }
+    metrics.counters.add(SRV_ACCEPTS);  // 之后的失败路径经close_session计入关闭数
+    session->index = sessions.size();
+    sessions.push_back(session);
+
+    // 只关注Unix域连接的可读事件：客户端退出时可读到EOF
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = session;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock_fd, &event) == -1) {
+        LOG_ERROR_RL("Epoll add shm session failed (fd: %d)", sock_fd);
+        close_session(*session);
+        return;
+    }
+    schedule_timeout(*session, false);  // 空闲超时从通道建立起计时
+    LOG_INFO("Worker %d shm session opened (fd: %d, ring: %zu bytes)", id, sock_fd, config.shm_ring_size);
+}
+
+// 开始排空：按排空规则重新设置所有会话的超时（已到报文边界的会话在下一个刻度关闭）
+void ShmWorker::start_drain() {
+    for (ShmSession* session : sessions) {
+        schedule_timeout(*session, session->blocked);
+    }
+}
+
+// 关闭会话并释放通道
+// 说明：关闭Unix域连接后客户端读到EOF；客户端仍持有的映射不受影响，由其自行解除
+// 参数：session - 会话
+void ShmWorker::close_session(ShmSession& session) {
+    LOG_INFO("Closed shm session for fd: %d", session.fd);
+    metrics.counters.add(SRV_CLOSES);
+    timers.cancel(session.timer);
+    session.channel.close();
+    close_client_fd(session.fd);  // 内核会自动将其从epoll中移除
+
+    // 从活跃列表中移除（与末尾交换）
+    ShmSession* last = sessions.back();
+    last->index = session.index;
+    sessions[session.index] = last;
+    sessions.pop_back();
+    table.release(&session);
+}
+
+// 切分请求环中的完整报文并整段拷贝到回射环
+// 说明：回射与请求逐字节相同，只切分不超过回射环可写空间的部分，切分出的报文一定放得下；
+//       放不下的报文留在请求环中，客户端取走回射腾出空间后唤醒本线程继续处理
+// 参数：session - 会话
+// 返回：true取得进展，false无事可做或会话已关闭
+bool ShmWorker::pump(ShmSession& session) {
+    ShmRing& rx = session.channel.rx_ring();
+    ShmRing& tx = session.channel.tx_ring();
+    size_t available = rx.readable();
+    if (available == 0) return false;
+
+    // 新到达的数据：缓冲区从空变为非空时未完成报文开始计时
+    size_t fresh = available > session.rx_end ? available - session.rx_end : 0;
+    if (fresh > 0) {
+        if (session.rx_end == 0) session.stage_start = std::chrono::steady_clock::now();
+        session.bytes_in += fresh;
+        metrics.counters.add(SRV_BYTES_IN, fresh);
+        ECHO_PROBE2(recv, session.fd, fresh);
+    }
+
+    size_t space = tx.writable();
+    session.rx_buf = const_cast<char*>(rx.read_ptr());
+    session.rx_start = 0;
+    session.rx_end = std::min(available, space);
+    char* out = tx.write_ptr();
+    size_t produced = 0;
+
+    // 单个报文不能超过环大小，否则永远收不全（同时受服务端最大数据长度限制）
+    uint32_t max_data_len = static_cast<uint32_t>(
+        std::min<size_t>(config.max_message_size, rx.capacity() - sizeof(MessageHeaderV2)));
+    auto start = std::chrono::steady_clock::now();
+    FrameStatus status = consume_frames(session, max_data_len, [&](const char* frame, const FrameInfo& info) {
+        memcpy(out + produced, frame, info.frame_len);
+        produced += info.frame_len;
+        metrics.counters.add(SRV_FRAMES);
+        ECHO_PROBE3(frame, session.fd, info.msg_id, info.frame_len);
+    });
+    metrics.stages[STAGE_PARSE].record_since(start);
+    if (is_frame_error(status)) {  // 报文非法（魔数、长度或报文头校验错误）
+        count_frame_error(status);
+        close_session(session);
+        return false;
+    }
+
+    size_t consumed = session.rx_start;
+    if (consumed > 0) {
+        tx.produce(produced);
+        rx.consume(consumed);
+        session.channel.notify_peer();  // 客户端可能在等待回射，或在等待请求环的空间
+        session.bytes_out += produced;
+        metrics.counters.add(SRV_BYTES_OUT, produced);
+        ECHO_PROBE2(write_done, session.fd, session.bytes_out);
+    }
+
+    // 回射环空间不足：按写阻塞计时（慢消费者）
+    bool blocked = space < available;
+    if (blocked && !session.blocked) session.write_start = std::chrono::steady_clock::now();
+    bool changed = fresh > 0 || consumed > 0 || blocked != session.blocked;
+    session.blocked = blocked;
+    session.rx_start = 0;
+    session.rx_end = available - consumed;  // 尚未切分的字节（下次从环的新读位置开始）
+    if (changed) schedule_timeout(session, session.blocked);
+    return consumed > 0;
+}
+
+// 处理一遍所有通道
+// 说明：倒序遍历，处理中关闭的会话与末尾交换，不影响尚未遍历的部分
+// 返回：true有通道取得进展
+bool ShmWorker::poll_sessions() {
+    bool progress = false;
+    for (size_t i = sessions.size(); i > 0; --i) {
+        progress = pump(*sessions[i - 1]) || progress;
+    }
+    return progress;
+}
+
+// 处理Unix域连接上的事件
+// 参数：session - 会话
+void ShmWorker::handle_control(ShmSession& session) {
+    char byte;
+    ssize_t n = recv(session.fd, &byte, sizeof(byte), MSG_DONTWAIT);
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return;
+    if (n == 0) {
+        LOG_INFO("Shm client disconnected (fd: %d)", session.fd);
+    } else {
+        LOG_ERROR_RL("Unexpected data on shm control socket (fd: %d)", session.fd);
+    }
+    close_session(session);
+}
+
+// 事件循环：轮询各通道，处理投递的新连接、客户端退出和超时
+void ShmWorker::run() {
+    place_thread();  // 可选的CPU亲和性和NUMA放置
+
+    const int MAX_EVENTS = 256;  // 一次最多处理的事件数
+    struct epoll_event events[MAX_EVENTS];
+    const int MAX_WAIT_MS = 1000;  // 没有定时器时的最长等待时间（毫秒）
+    auto now = std::chrono::steady_clock::now();
+
+    while (running) {
+        // 有进展或轮询策略要求继续轮询时不睡眠；准备睡眠前置位各通道的等待标志再处理一遍，
+        // 期间客户端写入的数据要么在这一遍中被处理，要么会写eventfd唤醒本线程
+        int wait_ms = 0;
+        bool progress = poll_sessions();
+        bool may_block = poll_may_block(now);
+        if (!progress && may_block) {
+            for (ShmSession* session : sessions) {
+                session->channel.prepare_wait();
+            }
+            progress = poll_sessions();
+            if (!progress) {
+                wait_ms = timers.empty() ? MAX_WAIT_MS : timers.ms_until_next_tick(now);
+            }
+        }
+
+        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, wait_ms);
+        if (num_events == -1) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Worker %d epoll wait failed", id);
+            break;
+        }
+        record_poll(wait_ms != 0, may_block, progress || num_events > 0, now);
+        for (int i = 0; i < num_events; ++i) {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &wakeup_fd) {  // 有新连接投递到本线程（或排空请求）
+                adopt_pending();
+                if (enter_drain()) start_drain();
+            } else if (ptr == &notify_fd) {  // 客户端推进了环：清空计数，下一轮处理
+                uint64_t count;
+                ssize_t ret = read(notify_fd, &count, sizeof(count));
+                (void)ret;
+            } else {
+                ShmSession* session = static_cast<ShmSession*>(ptr);
+                if (session->in_use) handle_control(*session);
+            }
+        }
+
+        now = std::chrono::steady_clock::now();
+        check_timeouts(now);
+        if (draining && sessions.empty()) {  // 排空完成
+            LOG_INFO("Worker %d drained", id);
+            break;
+        }
+    }
+}
+
+// 推进超时时间轮，关闭超时的会话
+// 参数：now - 当前时间
+void ShmWorker::check_timeouts(std::chrono::steady_clock::time_point now) {
+    timers.advance(now, [&](TimerNode& node) {
+        ShmSession& session = *static_cast<ShmSession*>(static_cast<Connection*>(node.owner));
+        if (timeout_expired(session, session.blocked, now)) {
+            close_session(session);
+        }
+    });
+}
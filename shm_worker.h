@@ -0,0 +1,98 @@
+#ifndef SHM_WORKER_H
+#define SHM_WORKER_H
+
+#include "worker_base.h"          // 包含工作线程基类
+#include "connection.h"           // 包含连接状态结构
+#include "connection_table.h"     // 包含按fd索引的连接表
+#include "shm_channel.h"          // 包含共享内存通道
+#include <vector>                 // 用于活跃通道列表
+#include <chrono>                 // 用于超时计时
+
+// 共享内存会话：一个客户端的通道及其解析状态
+// 说明：沿用通用连接状态（解析阶段、阶段计时、超时定时器和统计），fd为与客户端的Unix域连接；
+//       rx_buf每次处理时指向请求环的可读数据，[rx_start, rx_end)为尚未切分的字节（末尾不完整的报文）
+struct ShmSession : public Connection
+{
+    ShmChannel channel;                   // 共享内存通道（服务端一侧）
+    bool blocked;                         // 回射环空间不足，请求环中还有报文等待回射
+    size_t index;                         // 在活跃会话列表中的下标
+
+    ShmSession() : blocked(false), index(0) {}
+
+    // 为新会话复位槽位
+    // 参数：
+    //   fd - 与客户端的Unix域连接
+    //   rx_buf - 未使用（会话的数据位于共享内存中）
+    void reset(int fd, char* rx_buf) {
+        Connection::reset(fd, rx_buf);
+        channel.close();
+        blocked = false;
+        index = 0;
+    }
+};
+
+// 共享内存工作线程：服务所有同机客户端的共享内存通道
+// 说明：报文切分与TCP连接共用consume_frames（校验规则、计数和超时规则一致），
+//       完整报文直接从请求环整段拷贝到回射环，不经过内核。
+//       轮询策略（--poll）允许阻塞且一轮处理没有进展时，置位各通道的等待标志后睡眠在epoll上，
+//       由客户端经共用的eventfd唤醒；否则继续轮询各通道（忙轮询，用一个核换取唤醒延迟）
+class ShmWorker : public WorkerBase
+{
+private:
+    int epoll_fd;                                 // 本线程的epoll句柄
+    int notify_fd;                                // 客户端推进环后唤醒本线程的eventfd（所有通道共用）
+    ConnectionTable<ShmSession> table;            // 按Unix域连接fd索引的会话槽位
+    std::vector<ShmSession*> sessions;            // 活跃会话（轮询顺序）
+
+    // 事件循环：轮询各通道、处理客户端退出和超时
+    void run() override;
+
+    // 接管接收线程投递的新连接：为每个连接建立共享内存通道
+    void adopt_pending();
+
+    // 为新连接创建通道并发给客户端
+    // 参数：sock_fd - 与客户端的Unix域连接
+    void open_session(int sock_fd);
+
+    // 开始排空：按排空规则重新设置所有会话的超时
+    void start_drain();
+
+    // 处理一遍所有通道
+    // 返回：true有通道取得进展（切分出报文）
+    bool poll_sessions();
+
+    // 切分请求环中的完整报文并拷贝到回射环
+    // 参数：session - 会话
+    // 返回：true取得进展，false无事可做或会话因报文非法已关闭
+    bool pump(ShmSession& session);
+
+    // 处理Unix域连接上的事件：客户端退出（EOF）或违反协议（发送了数据）时关闭会话
+    void handle_control(ShmSession& session);
+
+    // 推进超时时间轮，关闭超时的会话
+    // 参数：now - 当前时间
+    void check_timeouts(std::chrono::steady_clock::time_point now);
+
+    // 关闭会话并释放通道
+    void close_session(ShmSession& session);
+
+public:
+    // 构造函数：初始化工作线程编号和配置
+    // 参数：
+    //   id - 工作线程编号（指标中的worker标签）
+    //   cfg - 服务端配置
+    ShmWorker(int id, const ServerConfig& cfg);
+
+    // 析构函数：停止工作线程并关闭所有会话
+    ~ShmWorker() override;
+
+    // 初始化epoll实例和eventfd
+    // 参数：listen_fd - 不使用（共享内存套接字由接收线程accept），应为-1
+    // 返回：true成功，false失败
+    bool init(int listen_fd) override;
+
+    // 后端名称
+    const char* backend_name() const override { return "shm"; }
+};
+
+#endif // SHM_WORKER_H
@@ -0,0 +1,186 @@
+#include "socket_utils.h"
+#include <sys/socket.h>       // 用于socket相关系统调用
+#include <netinet/in.h>       // 用于网络地址结构（sockaddr_in）
+#include <netinet/tcp.h>      // 用于TCP_NODELAY
+#include <sys/un.h>           // 用于Unix域地址结构（sockaddr_un）
+#include <unistd.h>           // 用于close等系统调用
+#include <fcntl.h>            // 用于fcntl（设置非阻塞）
+#include <errno.h>            // 用于错误码（errno）
+#include <cstring>            // 用于内存操作（memset等）
+
+// 设置文件描述符为非阻塞模式
+// 作用：避免IO操作（read/write）阻塞进程，提高并发处理能力
+// 参数：fd - 目标文件描述符
+// 返回：0成功，-1失败
+int set_nonblocking(int fd) {
+    // 获取当前文件描述符的标志
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) return -1;  // 获取失败
+    // 设置非阻塞标志（O_NONBLOCK）
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// 创建非阻塞的TCP监听套接字
+// 参数：
+//   port - 监听端口
+//   reuseport - 是否设置SO_REUSEPORT
+//   backlog - 监听队列长度
+//   defer_accept - TCP_DEFER_ACCEPT秒数，0表示不设置
+// 返回：监听套接字fd，失败返回-1
+int create_listen_socket(int port, bool reuseport, int backlog, int defer_accept) {
+    // 创建监听套接字（IPv4，TCP）
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd == -1) {  // 创建失败
+        LOG_ERROR("Socket creation failed (errno: %d)", errno);
+        return -1;
+    }
+
+    // 设置端口复用（避免服务器重启时端口被占用的TIME_WAIT状态阻塞）
+    int opt = 1;
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) == -1) {
+        LOG_ERROR("Setsockopt failed (errno: %d)", errno);
+        close(listen_fd);  // 清理资源
+        return -1;
+    }
+
+    // 多个套接字绑定同一端口（内核按四元组哈希把新连接分散到各监听套接字）
+    if (reuseport && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+        LOG_ERROR("Setsockopt SO_REUSEPORT failed (errno: %d)", errno);
+        close(listen_fd);
+        return -1;
+    }
+
+    // 延迟accept：三次握手完成后等到首个数据到达（或超过指定秒数）才放入accept队列
+    if (defer_accept > 0 &&
+        setsockopt(listen_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_accept, sizeof(defer_accept)) == -1) {
+        LOG_ERROR("Setsockopt TCP_DEFER_ACCEPT failed (errno: %d)", errno);
+        close(listen_fd);
+        return -1;
+    }
+
+    // 绑定套接字到指定端口
+    struct sockaddr_in server_addr;  // 服务器地址结构
+    memset(&server_addr, 0, sizeof(server_addr));  // 清零
+    server_addr.sin_family = AF_INET;  // IPv4
+    server_addr.sin_addr.s_addr = INADDR_ANY;  // 监听所有网络接口
+    server_addr.sin_port = htons(port);  // 端口（主机字节序转网络字节序）
+    if (bind(listen_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == -1) {
+        LOG_ERROR("Bind failed (errno: %d)", errno);
+        close(listen_fd);
+        return -1;
+    }
+
+    // 开始监听
+    if (listen(listen_fd, backlog) == -1) {
+        LOG_ERROR("Listen failed (errno: %d)", errno);
+        close(listen_fd);
+        return -1;
+    }
+
+    // 设置监听套接字为非阻塞模式
+    if (set_nonblocking(listen_fd) == -1) {
+        LOG_ERROR("Set nonblocking failed for listen_fd");
+        close(listen_fd);
+        return -1;
+    }
+    return listen_fd;
+}
+
+// 创建非阻塞的Unix域流式监听套接字
+// 说明：同机客户端经Unix域套接字连接时不经过TCP/IP协议栈（没有校验和、分段和确认），
+//       已接受的连接与TCP连接一样交给工作线程，处理逻辑完全相同
+// 参数：
+//   path - 套接字路径
+//   backlog - 监听队列长度
+// 返回：监听套接字fd，失败返回-1
+int create_unix_listen_socket(const std::string& path, int backlog) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("Unix socket path too long: %s", path.c_str());
+        return -1;
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd == -1) {
+        LOG_ERROR("Unix socket creation failed (errno: %d)", errno);
+        return -1;
+    }
+    unlink(path.c_str());  // 删除上次运行留下的路径
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(listen_fd, backlog) == -1) {
+        LOG_ERROR("Listen on %s failed (errno: %d)", path.c_str(), errno);
+        close(listen_fd);
+        return -1;
+    }
+    return listen_fd;
+}
+
+// 查询监听套接字绑定的Unix域路径（热重启时据此认出交接得到的Unix域监听套接字）
+// 参数：
+//   fd - 套接字
+//   path - 输出参数，绑定的路径
+// 返回：true为Unix域套接字，false为其他地址族或查询失败
+bool unix_socket_path(int fd, std::string& path) {
+    struct sockaddr_un addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    if (getsockname(fd, (struct sockaddr*)&addr, &len) == -1 || addr.sun_family != AF_UNIX) {
+        return false;
+    }
+    path.assign(addr.sun_path, strnlen(addr.sun_path, sizeof(addr.sun_path)));
+    return true;
+}
+
+// 接受一个新连接
+// 参数：
+//   listen_fd - 非阻塞监听套接字
+//   client_addr - 输出参数，客户端地址
+// 返回：客户端fd，-1表示没有更多连接或出错
+int accept_client(int listen_fd, struct sockaddr_in& client_addr) {
+    while (true) {
+        socklen_t client_len = sizeof(client_addr);
+        int client_fd = accept4(listen_fd, (struct sockaddr*)&client_addr, &client_len,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd != -1 || errno != EINTR) return client_fd;
+    }
+}
+
+// 设置已接受连接的套接字选项
+// 作用：回射以一次writev写出整批报文，开启TCP_NODELAY可避免Nagle与延迟确认叠加造成的等待
+// 说明：Unix域连接设置TCP_NODELAY返回EOPNOTSUPP，直接跳过（省去先查询地址族的系统调用）；
+//       配置了内核忙轮询时设置SO_BUSY_POLL/SO_PREFER_BUSY_POLL，失败不影响连接
+// 参数：
+//   fd - 客户端套接字
+//   config - 服务端配置
+// 返回：0成功，-1失败
+int apply_client_socket_options(int fd, const ServerConfig& config) {
+    int opt = config.tcp_nodelay ? 1 : 0;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt)) == -1 && errno != EOPNOTSUPP) {
+        LOG_ERROR_RL("Setsockopt TCP_NODELAY failed (fd: %d, errno: %d)", fd, errno);
+        return -1;
+    }
+    if (config.sndbuf > 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &config.sndbuf, sizeof(config.sndbuf)) == -1) {
+        LOG_ERROR_RL("Setsockopt SO_SNDBUF failed (fd: %d, errno: %d)", fd, errno);
+        return -1;
+    }
+    if (config.rcvbuf > 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config.rcvbuf, sizeof(config.rcvbuf)) == -1) {
+        LOG_ERROR_RL("Setsockopt SO_RCVBUF failed (fd: %d, errno: %d)", fd, errno);
+        return -1;
+    }
+    // 内核忙轮询只是降低延迟的手段：超过net.core.busy_read又没有CAP_NET_ADMIN时返回EPERM，
+    // 只记录日志，连接照常服务
+    if (config.busy_poll_us > 0 &&
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &config.busy_poll_us, sizeof(config.busy_poll_us)) == -1) {
+        LOG_ERROR_RL("Setsockopt SO_BUSY_POLL failed (fd: %d, errno: %d)", fd, errno);
+    }
+    opt = 1;
+    if (config.prefer_busy_poll &&
+        setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &opt, sizeof(opt)) == -1) {
+        LOG_ERROR_RL("Setsockopt SO_PREFER_BUSY_POLL failed (fd: %d, errno: %d)", fd, errno);
+    }
+    return 0;
+}
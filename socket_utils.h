@@ -0,0 +1,53 @@
+#ifndef SOCKET_UTILS_H
+#define SOCKET_UTILS_H
+
+// 套接字工具函数：供接收线程和各工作线程（reactor）共用
+
+#include "common.h"               // 包含服务端配置结构体
+#include <netinet/in.h>           // 用于客户端地址结构（sockaddr_in）
+
+// 设置文件描述符为非阻塞模式
+// 参数：fd - 目标文件描述符
+// 返回：0成功，-1失败
+int set_nonblocking(int fd);
+
+// 创建非阻塞的TCP监听套接字（IPv4，监听所有网络接口）
+// 参数：
+//   port - 监听端口
+//   reuseport - 是否设置SO_REUSEPORT（多reactor模式下每个线程各自绑定同一端口，
+//               由内核在这些监听套接字之间分摊新连接）
+//   backlog - 监听队列长度
+//   defer_accept - TCP_DEFER_ACCEPT秒数（只建立连接不发数据的客户端不会唤醒accept），0表示不设置
+// 返回：监听套接字fd，失败返回-1（错误已记录日志）
+int create_listen_socket(int port, bool reuseport, int backlog = DEFAULT_LISTEN_BACKLOG,
+                         int defer_accept = 0);
+
+// 创建非阻塞的Unix域流式监听套接字（路径已存在时先删除）
+// 参数：
+//   path - 套接字路径
+//   backlog - 监听队列长度
+// 返回：监听套接字fd，失败返回-1（错误已记录日志）
+int create_unix_listen_socket(const std::string& path, int backlog = DEFAULT_LISTEN_BACKLOG);
+
+// 查询监听套接字绑定的Unix域路径
+// 参数：
+//   fd - 套接字
+//   path - 输出参数，绑定的路径
+// 返回：true为Unix域套接字，false为其他地址族（TCP）或查询失败
+bool unix_socket_path(int fd, std::string& path);
+
+// 接受一个新连接，直接得到非阻塞、close-on-exec的套接字（accept4，省去两次fcntl）
+// 参数：
+//   listen_fd - 非阻塞监听套接字
+//   client_addr - 输出参数，客户端地址
+// 返回：客户端fd；-1表示没有更多连接或出错（errno保留，EINTR已重试）
+int accept_client(int listen_fd, struct sockaddr_in& client_addr);
+
+// 按服务端配置设置已接受连接的套接字选项（TCP_NODELAY、收发缓冲区大小、内核忙轮询；Unix域连接没有TCP选项）
+// 参数：
+//   fd - 客户端套接字
+//   config - 服务端配置
+// 返回：0成功，-1失败（错误已记录日志）
+int apply_client_socket_options(int fd, const ServerConfig& config);
+
+#endif // SOCKET_UTILS_H
@@ -0,0 +1,59 @@
+#include "timer_wheel.h"
+
+// 构造函数：时间槽数向上取整为2的幂，刻度从当前时间开始计数
+// 参数：
+//   resolution - 刻度长度
+//   slot_count - 时间槽数
+TimerWheel::TimerWheel(std::chrono::milliseconds resolution, size_t slot_count)
+    : resolution(resolution), origin(Clock::now()), current(0), count(0) {
+    size_t size = 1;
+    while (size < slot_count) size <<= 1;
+    slots.resize(size);
+    mask = size - 1;
+    for (TimerNode& head : slots) {  // 空时间槽：哨兵节点自成环
+        head.prev = head.next = &head;
+    }
+}
+
+// 把节点挂入其tick对应的时间槽（追加到链表尾部）
+void TimerWheel::link(TimerNode& node) {
+    TimerNode& head = slots[node.tick & mask];
+    node.prev = head.prev;
+    node.next = &head;
+    head.prev->next = &node;
+    head.prev = &node;
+    ++count;
+}
+
+// 把节点从所在时间槽摘除
+void TimerWheel::unlink(TimerNode& node) {
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = node.next = nullptr;
+    --count;
+}
+
+// 设置（或提前）定时器
+// 参数：
+//   node - 定时器节点
+//   deadline - 截止时间
+void TimerWheel::arm(TimerNode& node, Clock::time_point deadline) {
+    uint64_t tick = tick_of(deadline) + 1;  // 截止时间所在刻度结束后才到期，不会提前触发
+    if (tick <= current) tick = current + 1;
+    if (node.linked()) {
+        if (node.tick <= tick) return;  // 惰性推迟：到期时由调用方重新计算
+        unlink(node);
+    }
+    node.tick = tick;
+    link(node);
+}
+
+// 距离下一个刻度的毫秒数
+// 参数：now - 当前时间
+// 返回：毫秒数（至少为1）
+int TimerWheel::ms_until_next_tick(Clock::time_point now) const {
+    Clock::time_point next = origin + resolution * static_cast<Clock::rep>(current + 1);
+    if (next <= now) return 1;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+    return ms < 1 ? 1 : static_cast<int>(ms);
+}
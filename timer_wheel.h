@@ -0,0 +1,117 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>                 // 用于截止时间
+#include <vector>                 // 用于存储时间槽
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于uint64_t
+
+// 定时器节点：嵌入在被计时的对象中（侵入式双向链表），挂入和摘除都不分配内存
+struct TimerNode
+{
+    TimerNode* prev;      // 所在时间槽链表的前一个节点（未挂入时为nullptr）
+    TimerNode* next;      // 所在时间槽链表的后一个节点
+    uint64_t tick;        // 计划到期的刻度
+    void* owner;          // 所属对象（到期回调据此找回对象）
+
+    TimerNode() : prev(nullptr), next(nullptr), tick(0), owner(nullptr) {}
+
+    // 是否已挂入时间轮
+    bool linked() const { return prev != nullptr; }
+};
+
+// 哈希时间轮：按固定刻度把定时器散列到环形时间槽中，挂入和取消都是O(1)
+// 说明：截止时间超过一圈的定时器留在槽中，每转一圈检查一次，直到到期。
+//       arm采用惰性推迟：新的截止时间晚于已计划的刻度时不移动节点，
+//       到期时由调用方重新计算截止时间，未到期则再次arm。连接每次收发都会刷新截止时间，
+//       惰性推迟使这类刷新只是一次比较，大量空闲连接也只在各自到期时被访问一次
+// 注：只由所属工作线程访问，不加锁
+class TimerWheel
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+private:
+    std::vector<TimerNode> slots;     // 各时间槽的哨兵节点（环形链表）
+    size_t mask;                      // 时间槽数 - 1（时间槽数为2的幂）
+    Clock::duration resolution;       // 刻度长度
+    Clock::time_point origin;         // 刻度0对应的时间
+    uint64_t current;                 // 已处理到的刻度
+    size_t count;                     // 已挂入的定时器数
+
+    // 时间点对应的刻度（向下取整）
+    uint64_t tick_of(Clock::time_point t) const {
+        return t <= origin ? 0 : static_cast<uint64_t>((t - origin) / resolution);
+    }
+
+    // 把节点挂入其tick对应的时间槽
+    void link(TimerNode& node);
+
+    // 把节点从所在时间槽摘除
+    void unlink(TimerNode& node);
+
+public:
+    // 构造函数
+    // 参数：
+    //   resolution - 刻度长度（到期时间的精度）
+    //   slot_count - 时间槽数（向上取整为2的幂；刻度长度 * 时间槽数 为一圈的时长）
+    TimerWheel(std::chrono::milliseconds resolution, size_t slot_count);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 设置（或提前）定时器：截止时间所在刻度结束后到期
+    // 说明：节点已挂入且计划刻度不晚于新的截止时间时保持不动（惰性推迟）
+    // 参数：
+    //   node - 定时器节点
+    //   deadline - 截止时间
+    void arm(TimerNode& node, Clock::time_point deadline);
+
+    // 取消定时器（未挂入时无操作）
+    // 参数：node - 定时器节点
+    void cancel(TimerNode& node) {
+        if (node.linked()) unlink(node);
+    }
+
+    // 是否没有挂入的定时器
+    bool empty() const { return count == 0; }
+
+    // 距离下一个刻度的毫秒数（用作epoll_wait等的超时，至少为1）
+    int ms_until_next_tick(Clock::time_point now) const;
+
+    // 推进时间轮到now，对每个到期的定时器调用on_expire
+    // 说明：回调前节点已摘除，回调中可以重新arm或取消该节点（不能操作同批到期的其他节点）
+    // 参数：
+    //   now - 当前时间
+    //   on_expire - 回调，参数为(TimerNode& node)
+    template <typename OnExpire>
+    void advance(Clock::time_point now, OnExpire on_expire) {
+        uint64_t target = tick_of(now);
+        if (target <= current) return;
+        // 落后超过一圈时每个时间槽只需检查一次
+        uint64_t first = target - current > mask ? target - mask : current + 1;
+        current = target;
+        for (uint64_t t = first; t <= target; ++t) {
+            TimerNode& head = slots[t & mask];
+            if (head.next == &head) continue;
+
+            // 先摘下整个时间槽，回调中新挂入的节点不会在本轮被处理
+            TimerNode* node = head.next;
+            head.prev->next = nullptr;
+            head.prev = head.next = &head;
+            while (node != nullptr) {
+                TimerNode* next = node->next;
+                node->prev = node->next = nullptr;
+                --count;
+                if (node->tick <= target) {
+                    on_expire(*node);
+                } else {  // 还要再转若干圈
+                    link(*node);
+                }
+                node = next;
+            }
+        }
+    }
+};
+
+#endif // TIMER_WHEEL_H
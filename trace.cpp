@@ -0,0 +1,107 @@
+#include "trace.h"
+#include <algorithm>          // 用于std::min
+#include <cstdio>             // 用于snprintf
+
+// 构造函数：环形缓冲区一次分配，之后不再分配内存
+// 参数：
+//   sample_every - 抽样间隔N
+//   capacity - 槽位数
+FrameTracer::FrameTracer(uint32_t sample_every, size_t capacity)
+    : sample_every(capacity > 0 ? sample_every : 0),  // 没有槽位：等同于关闭
+      countdown(this->sample_every), capacity(this->sample_every > 0 ? capacity : 0),
+      slots(this->capacity > 0 ? new Slot[this->capacity] : nullptr), written(0) {}
+
+// 记录一条写出完成的报文
+// 说明：先把序号改为奇数（正在写入），写完字段后改为偶数；读取方据此跳过写了一半的槽位
+// 参数：trace - 追踪记录
+void FrameTracer::record(const FrameTrace& trace) {
+    uint64_t n = written.load(std::memory_order_relaxed);
+    Slot& slot = slots[n % capacity];
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.id_fd.store(static_cast<uint64_t>(trace.msg_id) << 32 | static_cast<uint32_t>(trace.fd),
+                     std::memory_order_relaxed);
+    for (int i = 0; i < TRACE_POINT_COUNT; ++i) {
+        slot.ns[i].store(trace.ns[i], std::memory_order_relaxed);
+    }
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    written.store(n + 1, std::memory_order_release);
+}
+
+// 读取环形缓冲区中的记录
+// 参数：out - 输出参数，记录追加到其中
+void FrameTracer::snapshot(std::vector<FrameTrace>& out) const {
+    uint64_t end = written.load(std::memory_order_acquire);
+    uint64_t begin = end > capacity ? end - capacity : 0;
+    for (uint64_t n = begin; n < end; ++n) {
+        const Slot& slot = slots[n % capacity];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq != 2 * n + 2) continue;  // 已被更新的记录覆盖或正在覆盖
+        FrameTrace trace;
+        uint64_t id_fd = slot.id_fd.load(std::memory_order_relaxed);
+        trace.msg_id = static_cast<uint32_t>(id_fd >> 32);
+        trace.fd = static_cast<int>(static_cast<uint32_t>(id_fd));
+        for (int i = 0; i < TRACE_POINT_COUNT; ++i) {
+            trace.ns[i] = slot.ns[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq) continue;  // 读取期间被覆盖
+        out.push_back(trace);
+    }
+}
+
+namespace {
+
+// 按printf格式追加文本
+template <typename... Args>
+void appendf(std::string& out, const char* fmt, Args... args) {
+    char line[256];
+    int n = snprintf(line, sizeof(line), fmt, args...);
+    if (n > 0) out.append(line, std::min(static_cast<size_t>(n), sizeof(line) - 1));
+}
+
+// 区间名称：第i段为时间点i到i+1
+const char* const SPAN_NAMES[TRACE_POINT_COUNT - 1] = {"parse", "queue", "wait_write", "write"};
+
+} // namespace
+
+// 渲染Chrome trace事件格式
+// 参数：
+//   workers - 各工作线程的追踪器
+//   out - 输出参数
+void render_chrome_trace(const std::vector<const FrameTracer*>& workers, std::string& out) {
+    std::vector<std::vector<FrameTrace>> traces(workers.size());
+    uint64_t origin = UINT64_MAX;
+    for (size_t w = 0; w < workers.size(); ++w) {
+        workers[w]->snapshot(traces[w]);
+        for (const FrameTrace& t : traces[w]) origin = std::min(origin, t.ns[TRACE_RECV]);
+    }
+
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto event = [&](const char* ph, const char* name, uint64_t id, size_t pid, uint64_t ns) {
+        appendf(out, "%s{\"ph\":\"%s\",\"cat\":\"echo\",\"name\":\"%s\",\"id\":\"0x%llx\",\"pid\":%zu,\"tid\":%zu,\"ts\":%.3f",
+                first ? "" : ",\n", ph, name, static_cast<unsigned long long>(id), pid, pid, (ns - origin) / 1e3);
+        first = false;
+    };
+    for (size_t w = 0; w < workers.size(); ++w) {
+        appendf(out, "%s{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%zu,\"args\":{\"name\":\"worker %zu\"}}",
+                first ? "" : ",\n", w, w);
+        first = false;
+        for (size_t i = 0; i < traces[w].size(); ++i) {
+            const FrameTrace& t = traces[w][i];
+            uint64_t id = static_cast<uint64_t>(w) << 40 | i;  // 同一报文的嵌套区间共用一个id
+            event("b", "frame", id, w, t.ns[TRACE_RECV]);
+            appendf(out, ",\"args\":{\"msg_id\":%u,\"fd\":%d}}", t.msg_id, t.fd);
+            for (int p = 0; p + 1 < TRACE_POINT_COUNT; ++p) {
+                event("b", SPAN_NAMES[p], id, w, t.ns[p]);
+                out += "}";
+                event("e", SPAN_NAMES[p], id, w, t.ns[p + 1]);
+                out += "}";
+            }
+            event("e", "frame", id, w, t.ns[TRACE_WRITE_DONE]);
+            out += "}";
+        }
+    }
+    out += "\n]}\n";
+}
@@ -0,0 +1,133 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// 热路径追踪：按1/N抽样记录报文经过各阶段的时间点（见FrameTracer），
+// 以及供perf/bpftrace挂接的USDT静态探针（见ECHO_PROBE*）
+
+#include <atomic>                 // 用于环形缓冲区槽位的序号（单写多读）
+#include <chrono>                 // 用于时间戳
+#include <cstdint>                // 用于固定宽度整数类型
+#include <memory>                 // 用于环形缓冲区存储
+#include <string>                 // 用于Chrome trace文本
+#include <vector>                 // 用于汇总各工作线程
+
+// USDT静态探针：提供者为echo_server，编译为一条nop和一段ELF note，未挂接时几乎没有开销
+// 说明：系统没有<sys/sdt.h>（systemtap-sdt-dev）或以-DECHO_NO_USDT编译时为空操作
+//       （参数照常求值，只应传入没有副作用的表达式）。
+//       探针点与参数：
+//         recv(fd, bytes)            读到数据（io_uring：recv完成）
+//         frame(fd, msg_id, len)     切分出一条完整报文
+//         queue(fd, bytes)           本批回射加入回射列表（io_uring：send链已准备），bytes为待写字节数
+//         write_start(fd, bytes)     开始写出回射（writev/send链提交），bytes为待写字节数
+//         write_done(fd, bytes_out)  写出完成（writev返回/send链全部完成），bytes_out为该连接累计写出的字节数
+//       共享内存后端只有recv、frame和write_done（回射写入应答环即为写出）
+// 例：bpftrace -e 'usdt:./echo_server:echo_server:frame { @[arg0] = count(); }'
+#if !defined(ECHO_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ECHO_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef ECHO_HAVE_USDT
+#define ECHO_PROBE2(name, a1, a2) DTRACE_PROBE2(echo_server, name, a1, a2)
+#define ECHO_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(echo_server, name, a1, a2, a3)
+#else
+#define ECHO_PROBE2(name, a1, a2) do { (void)(a1); (void)(a2); } while (0)
+#define ECHO_PROBE3(name, a1, a2, a3) do { (void)(a1); (void)(a2); (void)(a3); } while (0)
+#endif
+
+// 本次构建是否带USDT探针（用于启动日志）
+#ifdef ECHO_HAVE_USDT
+constexpr bool BUILD_HAS_USDT = true;
+#else
+constexpr bool BUILD_HAS_USDT = false;
+#endif
+
+// 抽样报文经过的时间点（按发生顺序）
+enum TracePoint
+{
+    TRACE_RECV,           // 读到报文最后一段数据（read返回/recv完成）
+    TRACE_PARSE,          // 切分出该报文
+    TRACE_QUEUE,          // 该报文所在的一批回射已加入回射列表
+    TRACE_WRITE_START,    // 开始写出包含该报文的回射
+    TRACE_WRITE_DONE,     // 该报文的回射全部写出
+    TRACE_POINT_COUNT
+};
+
+// 一条抽样报文的追踪记录
+// 注：时间戳为steady_clock纳秒，0表示该时间点尚未到达
+struct FrameTrace
+{
+    uint32_t msg_id = 0;                     // 报文ID
+    int fd = -1;                             // 客户端文件描述符
+    uint64_t ns[TRACE_POINT_COUNT] = {};     // 各时间点
+};
+
+// 当前时间（steady_clock纳秒，与FrameTrace的时间戳同一时基）
+inline uint64_t trace_now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// 工作线程的报文追踪：按1/N抽样，写出完成的记录放入本线程的环形缓冲区，按需导出
+// 说明：环形缓冲区单写多读：只由所属工作线程写入（覆盖最旧的记录），管理线程或接收线程
+//       随时读取快照。每个槽位带序号（seqlock），读到写了一半的槽位时跳过，写入方无需等待。
+//       关闭抽样（N为0）时热路径上只有一次判断
+// 注：同一连接同时只追踪一条报文（上一条的回射写出之前不再抽样该连接）
+class FrameTracer
+{
+private:
+    // 环形缓冲区的一个槽位（字段都是relaxed原子量，由seq的奇偶判断是否写完）
+    struct Slot
+    {
+        std::atomic<uint64_t> seq{0};        // 0表示空；奇数表示正在写入；偶数表示写完
+        std::atomic<uint64_t> id_fd{0};      // 高32位报文ID，低32位fd
+        std::atomic<uint64_t> ns[TRACE_POINT_COUNT];
+    };
+
+    uint32_t sample_every;                   // 抽样间隔N（0表示关闭）
+    uint32_t countdown;                      // 距离下一次抽样还有多少条报文
+    size_t capacity;                         // 槽位数
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> written;           // 已写入的记录数（下一条记录的序号）
+
+public:
+    // 构造函数
+    // 参数：
+    //   sample_every - 每N条报文抽样一条，0表示关闭
+    //   capacity - 环形缓冲区槽位数（保留最近的capacity条记录）
+    FrameTracer(uint32_t sample_every, size_t capacity);
+
+    FrameTracer(const FrameTracer&) = delete;
+    FrameTracer& operator=(const FrameTracer&) = delete;
+
+    // 是否开启抽样
+    bool enabled() const { return sample_every > 0; }
+
+    // 是否抽样当前这条报文（每条切分出的报文调用一次，只在开启时调用）
+    bool sample() {
+        if (--countdown != 0) return false;
+        countdown = sample_every;
+        return true;
+    }
+
+    // 记录一条写出完成的报文（仅所属工作线程调用）
+    // 参数：trace - 追踪记录
+    void record(const FrameTrace& trace);
+
+    // 读取环形缓冲区中的记录（任意线程调用，与写入并发时跳过正在覆盖的槽位）
+    // 参数：out - 输出参数，记录追加到其中（按写入顺序）
+    void snapshot(std::vector<FrameTrace>& out) const;
+};
+
+// 把各工作线程的追踪记录渲染为Chrome trace事件格式（JSON，可用chrome://tracing或Perfetto打开）
+// 说明：每条报文渲染为一组嵌套的异步区间（同一工作线程上的报文可能交叠）：覆盖整个生命周期的frame，
+//       其下依次为parse（读到→切分）、queue（切分→加入回射列表）、wait_write（→开始写出）、
+//       write（→写出完成）；pid为工作线程编号，args中带msg_id和fd；时间从最早一条记录起算（微秒）
+// 参数：
+//   workers - 各工作线程的追踪器（下标即pid）
+//   out - 输出参数，JSON文本追加到其中
+void render_chrome_trace(const std::vector<const FrameTracer*>& workers, std::string& out);
+
+#endif // TRACE_H
@@ -0,0 +1,241 @@
+#include "uring.h"
+#include <sys/mman.h>         // 用于mmap/munmap
+#include <sys/syscall.h>      // 用于io_uring系统调用号
+#include <unistd.h>           // 用于syscall/close
+#include <errno.h>            // 用于错误码（errno）
+#include <cstring>            // 用于memset
+
+namespace {
+
+// io_uring_setup系统调用
+int sys_io_uring_setup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+// io_uring_enter系统调用
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// io_uring_register系统调用
+int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+const unsigned REGISTER_NAPI = 27;    // IORING_REGISTER_NAPI（旧版头文件没有该定义）
+
+// NAPI忙轮询的注册参数（与内核struct io_uring_napi布局一致）
+struct NapiRegistration
+{
+    uint32_t busy_poll_to;             // 忙轮询的微秒数
+    uint8_t prefer_busy_poll;          // 忙轮询期间抑制网卡软中断
+    uint8_t pad[3];                    // 必须为0
+    uint64_t resv;                     // 保留，必须为0
+};
+
+} // namespace
+
+IoUring::IoUring()
+    : ring_fd(-1), sq_head(nullptr), sq_tail(nullptr), sq_flags(nullptr), sq_mask(0), sq_entries(0), sqes(nullptr),
+      sqe_tail(0), sqe_head(0), cq_head(nullptr), cq_tail(nullptr), cq_mask(0), cqes(nullptr),
+      sq_ring_ptr(MAP_FAILED), sq_ring_size(0), cq_ring_ptr(MAP_FAILED), cq_ring_size(0),
+      sqes_size(0) {}
+
+// 析构函数：解除映射并关闭实例（内核会取消所有未完成的操作）
+IoUring::~IoUring() {
+    if (sqes != nullptr) munmap(sqes, sqes_size);
+    if (cq_ring_ptr != MAP_FAILED && cq_ring_ptr != sq_ring_ptr) munmap(cq_ring_ptr, cq_ring_size);
+    if (sq_ring_ptr != MAP_FAILED) munmap(sq_ring_ptr, sq_ring_size);
+    if (ring_fd != -1) close(ring_fd);
+}
+
+// 创建io_uring实例并映射队列
+// 参数：
+//   entries - SQ容量
+//   flags - IORING_SETUP_*标志
+// 返回：0成功，负数为-errno
+int IoUring::init(unsigned entries, unsigned flags) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = flags | IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4;  // CQ放大，多路操作会产生大量完成事件
+    ring_fd = sys_io_uring_setup(entries, &params);
+    if (ring_fd < 0 && errno == EINVAL && flags != 0) {  // 旧内核不支持部分标志，去掉后重试
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        ring_fd = sys_io_uring_setup(entries, &params);
+    }
+    if (ring_fd < 0) {
+        ring_fd = -1;
+        return -errno;
+    }
+
+    // 映射SQ环和CQ环（支持SINGLE_MMAP的内核上两者共用一块映射）
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && cq_ring_size > sq_ring_size) {
+        sq_ring_size = cq_ring_size;
+    }
+    sq_ring_ptr = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring_ptr == MAP_FAILED) return -errno;
+    if (single_mmap) {
+        cq_ring_ptr = sq_ring_ptr;
+    } else {
+        cq_ring_ptr = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring_ptr == MAP_FAILED) return -errno;
+    }
+
+    // 映射SQE数组
+    sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes_ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd, IORING_OFF_SQES);
+    if (sqes_ptr == MAP_FAILED) return -errno;
+    sqes = static_cast<struct io_uring_sqe*>(sqes_ptr);
+
+    char* sq = static_cast<char*>(sq_ring_ptr);
+    sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_flags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+    sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    // SQ下标数组固定为恒等映射：第i个槽位总是指向第i个SQE
+    unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries; ++i) {
+        sq_array[i] = i;
+    }
+    sqe_head = sqe_tail = *sq_tail;
+
+    char* cq = static_cast<char*>(cq_ring_ptr);
+    cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return 0;
+}
+
+// 获取一个空闲SQE
+// 返回：SQE指针，队列已满时返回nullptr
+struct io_uring_sqe* IoUring::get_sqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sqe_tail - head >= sq_entries) return nullptr;
+    struct io_uring_sqe* sqe = &sqes[sqe_tail & sq_mask];
+    ++sqe_tail;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+// SQ中尚可填写的SQE数
+unsigned IoUring::sq_space() const {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    return sq_entries - (sqe_tail - head);
+}
+
+// 把本地已填写的SQE发布给内核
+// 返回：本次发布的SQE数
+unsigned IoUring::flush_sq() {
+    unsigned count = sqe_tail - sqe_head;
+    if (count > 0) {
+        __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+        sqe_head = sqe_tail;
+    }
+    return count;
+}
+
+// 提交已填写的SQE，并按需等待完成事件
+// 参数：wait_nr - 至少等待的完成事件数
+// 返回：提交的SQE数，负数为-errno
+int IoUring::submit(unsigned wait_nr) {
+    unsigned to_submit = flush_sq();
+    bool taskrun = (__atomic_load_n(sq_flags, __ATOMIC_RELAXED) & IORING_SQ_TASKRUN) != 0;
+    if (to_submit == 0 && wait_nr == 0 && !taskrun) return 0;
+    // 有待运行的任务时带GETEVENTS进入内核：COOP_TASKRUN下完成事件由该任务产生
+    unsigned flags = wait_nr > 0 || taskrun ? IORING_ENTER_GETEVENTS : 0;
+    int ret = sys_io_uring_enter(ring_fd, to_submit, wait_nr, flags);
+    return ret < 0 ? -errno : ret;
+}
+
+// 注册提供缓冲区环
+// 返回：0成功，负数为-errno
+int IoUring::register_buf_ring(void* ring_addr, unsigned entries, unsigned group_id) {
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring_addr);
+    reg.ring_entries = entries;
+    reg.bgid = static_cast<uint16_t>(group_id);
+    int ret = sys_io_uring_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1);
+    return ret < 0 ? -errno : 0;
+}
+
+// 注册NAPI忙轮询
+// 返回：0成功，负数为-errno
+int IoUring::register_napi(unsigned busy_poll_us, bool prefer_busy_poll) {
+    NapiRegistration napi;
+    memset(&napi, 0, sizeof(napi));
+    napi.busy_poll_to = busy_poll_us;
+    napi.prefer_busy_poll = prefer_busy_poll ? 1 : 0;
+    int ret = sys_io_uring_register(ring_fd, REGISTER_NAPI, &napi, 1);
+    return ret < 0 ? -errno : 0;
+}
+
+ProvidedBufferRing::ProvidedBufferRing()
+    : ring(nullptr), ring_size(0), buffers(nullptr), buffers_size(0), entries(0), buffer_size(0),
+      group_id(0), tail(0) {}
+
+// 析构函数：释放缓冲区环和缓冲区内存（需在io_uring实例关闭后进行）
+ProvidedBufferRing::~ProvidedBufferRing() {
+    if (buffers != nullptr) munmap(buffers, buffers_size);
+    if (ring != nullptr) munmap(ring, ring_size);
+}
+
+// 分配缓冲区并注册到io_uring
+// 返回：0成功，负数为-errno
+int ProvidedBufferRing::init(IoUring& uring, unsigned entries, unsigned buffer_size, unsigned group_id) {
+    this->entries = entries;
+    this->buffer_size = buffer_size;
+    this->group_id = group_id;
+
+    // 缓冲区环和缓冲区都用匿名映射分配（按页对齐）
+    ring_size = entries * sizeof(struct io_uring_buf);
+    void* ring_ptr = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring_ptr == MAP_FAILED) return -errno;
+    ring = static_cast<struct io_uring_buf_ring*>(ring_ptr);
+
+    buffers_size = static_cast<size_t>(entries) * buffer_size;
+    void* buf_ptr = mmap(nullptr, buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ptr == MAP_FAILED) {
+        buffers = nullptr;
+        return -errno;
+    }
+    buffers = static_cast<char*>(buf_ptr);
+
+    int ret = uring.register_buf_ring(ring, entries, group_id);
+    if (ret < 0) return ret;
+
+    // 初始时所有缓冲区都交给内核
+    for (unsigned bid = 0; bid < entries; ++bid) {
+        recycle(bid);
+    }
+    publish();
+    return 0;
+}
+
+// 归还缓冲区
+// 参数：bid - 缓冲区编号
+// 注：C++下内核头文件的柔性数组声明（__DECLARE_FLEX_ARRAY）会让bufs偏移8字节，
+//     因此直接按环起始地址计算槽位，与内核布局保持一致
+void ProvidedBufferRing::recycle(unsigned bid) {
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(ring) + (tail & (entries - 1));
+    buf->addr = reinterpret_cast<uint64_t>(buffer(bid));
+    buf->len = buffer_size;
+    buf->bid = static_cast<uint16_t>(bid);
+    ++tail;
+}
+
+// 把本地归还的缓冲区发布给内核
+void ProvidedBufferRing::publish() {
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,154 @@
+#ifndef URING_H
+#define URING_H
+
+#include <linux/io_uring.h>       // 用于io_uring内核接口定义
+#include <cstddef>                // 用于size_t
+#include <cstdint>                // 用于固定宽度整数类型
+
+// io_uring最小封装：直接通过系统调用创建环形队列，不依赖liburing
+// 说明：只被所属工作线程使用，不支持多线程并发提交
+class IoUring
+{
+private:
+    int ring_fd;                          // io_uring实例的文件描述符
+
+    // 提交队列（SQ）
+    unsigned* sq_head;                    // 内核已消费的位置
+    unsigned* sq_tail;                    // 用户已提交的位置
+    unsigned* sq_flags;                   // 内核设置的状态标志（IORING_SQ_TASKRUN等）
+    unsigned sq_mask;                     // 环形下标掩码
+    unsigned sq_entries;                  // SQ容量
+    struct io_uring_sqe* sqes;            // SQE数组
+    unsigned sqe_tail;                    // 本地已填写但尚未发布的位置
+    unsigned sqe_head;                    // 本地已发布给内核的位置
+
+    // 完成队列（CQ）
+    unsigned* cq_head;                    // 用户已消费的位置
+    unsigned* cq_tail;                    // 内核已产生的位置
+    unsigned cq_mask;                     // 环形下标掩码
+    struct io_uring_cqe* cqes;            // CQE数组
+
+    // mmap映射区域（用于析构时解除映射）
+    void* sq_ring_ptr;
+    size_t sq_ring_size;
+    void* cq_ring_ptr;
+    size_t cq_ring_size;
+    size_t sqes_size;
+
+    // 把本地已填写的SQE发布给内核（更新sq_tail）
+    // 返回：本次发布的SQE数
+    unsigned flush_sq();
+
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // 创建io_uring实例并映射队列
+    // 参数：
+    //   entries - SQ容量（CQ容量为其4倍）
+    //   flags - IORING_SETUP_*标志（内核不支持时自动去掉后重试）
+    // 返回：0成功，负数为-errno
+    int init(unsigned entries, unsigned flags);
+
+    // 获取一个空闲SQE（已清零）
+    // 返回：SQE指针，队列已满时返回nullptr（调用方应先submit）
+    struct io_uring_sqe* get_sqe();
+
+    // SQ中尚可填写的SQE数
+    unsigned sq_space() const;
+
+    // 提交已填写的SQE，并按需等待完成事件
+    // 说明：不等待且没有SQE要提交时，只在内核标记有待运行的任务（IORING_SQ_TASKRUN）时进入内核，
+    //       忙轮询完成队列时大多数轮次不产生系统调用
+    // 参数：wait_nr - 至少等待的完成事件数（0表示不等待）
+    // 返回：提交的SQE数，负数为-errno
+    int submit(unsigned wait_nr = 0);
+
+    // 遍历并消费当前所有完成事件
+    // 参数：func - 回调，参数为const io_uring_cqe&
+    // 返回：处理的完成事件数
+    template <typename Func>
+    unsigned for_each_cqe(Func func) {
+        unsigned head = *cq_head;
+        unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        while (head != tail) {
+            func(cqes[head & cq_mask]);
+            ++head;
+            ++count;
+            if (head == tail) {  // 回调中可能产生了新的完成事件，继续处理
+                tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+            }
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // 注册提供缓冲区环（IORING_REGISTER_PBUF_RING）
+    // 参数：
+    //   ring_addr - 缓冲区环内存（按页对齐）
+    //   entries - 环容量（2的幂）
+    //   group_id - 缓冲区组编号
+    // 返回：0成功，负数为-errno
+    int register_buf_ring(void* ring_addr, unsigned entries, unsigned group_id);
+
+    // 注册NAPI忙轮询（IORING_REGISTER_NAPI，6.9起支持）：等待完成事件时先轮询网卡队列
+    // 参数：
+    //   busy_poll_us - 睡眠前忙轮询的微秒数
+    //   prefer_busy_poll - 忙轮询期间抑制网卡软中断
+    // 返回：0成功，负数为-errno
+    int register_napi(unsigned busy_poll_us, bool prefer_busy_poll);
+
+    // io_uring实例的文件描述符
+    int fd() const { return ring_fd; }
+};
+
+// 提供缓冲区环：预先交给内核一组固定大小的接收缓冲区，
+// 多路recv时由内核为每次接收挑选缓冲区，完成事件中携带缓冲区编号
+class ProvidedBufferRing
+{
+private:
+    struct io_uring_buf_ring* ring;   // 缓冲区环（与内核共享）
+    size_t ring_size;                 // 缓冲区环内存大小
+    char* buffers;                    // 缓冲区内存（entries * buffer_size）
+    size_t buffers_size;              // 缓冲区内存大小
+    unsigned entries;                 // 缓冲区数（2的幂）
+    unsigned buffer_size;             // 单个缓冲区大小
+    unsigned group_id;                // 缓冲区组编号
+    uint16_t tail;                    // 本地尾指针（批量发布）
+
+public:
+    ProvidedBufferRing();
+    ~ProvidedBufferRing();
+
+    ProvidedBufferRing(const ProvidedBufferRing&) = delete;
+    ProvidedBufferRing& operator=(const ProvidedBufferRing&) = delete;
+
+    // 分配缓冲区并注册到io_uring，所有缓冲区初始即交给内核
+    // 参数：
+    //   uring - 所属io_uring实例
+    //   entries - 缓冲区数（2的幂）
+    //   buffer_size - 单个缓冲区大小
+    //   group_id - 缓冲区组编号
+    // 返回：0成功，负数为-errno
+    int init(IoUring& uring, unsigned entries, unsigned buffer_size, unsigned group_id);
+
+    // 获取缓冲区地址
+    // 参数：bid - 缓冲区编号
+    char* buffer(unsigned bid) const { return buffers + static_cast<size_t>(bid) * buffer_size; }
+
+    // 归还缓冲区（需调用publish后内核才可见）
+    // 参数：bid - 缓冲区编号
+    void recycle(unsigned bid);
+
+    // 把本地归还的缓冲区发布给内核
+    void publish();
+
+    // 缓冲区组编号
+    unsigned group() const { return group_id; }
+};
+
+#endif // URING_H
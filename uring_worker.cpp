@@ -0,0 +1,673 @@
+#include "uring_worker.h"
+#include "protocol.h"         // 用于报文校验与切分
+#include <sys/socket.h>       // 用于shutdown/getpeername及MSG_*标志
+#include <netinet/in.h>       // 用于网络地址结构（sockaddr_in）
+#include <arpa/inet.h>        // 用于IP地址转换
+#include <poll.h>             // 用于POLLIN
+#include <unistd.h>           // 用于close
+#include <errno.h>            // 用于错误码（errno）
+#include <chrono>             // 用于时间相关操作（超时控制）
+#include <algorithm>          // 用于std::min
+#include <cstring>            // 用于内存操作（memcpy/memmove）
+
+namespace {
+
+const unsigned URING_ENTRIES = 4096;        // SQ容量
+const unsigned PROVIDED_BUFFERS = 1024;     // 提供缓冲区数（2的幂）
+const unsigned PROVIDED_BUFFER_SIZE = 4096; // 单个提供缓冲区大小
+const unsigned BUFFER_GROUP = 0;            // 提供缓冲区组编号
+const size_t MAX_BATCH_FRAMES = 512;        // 一次链式send最多包含的报文数（需不超过SQ容量）
+
+// user_data低位记录操作类型，高位为连接槽位指针（槽位按64字节对齐，低6位恒为0）
+enum UringOp : uint64_t
+{
+    OP_RECV = 1,      // 客户端多路recv
+    OP_SEND = 2,      // 客户端回射send
+    OP_ACCEPT = 3,    // 监听套接字多路accept
+    OP_WAKEUP = 4,    // eventfd多路poll
+    OP_TICK = 5,      // 周期定时器
+    OP_CANCEL = 6     // 取消请求本身的完成事件（忽略）
+};
+const uint64_t OP_MASK = 0x3f;
+
+inline uint64_t make_user_data(const void* ptr, UringOp op) {
+    return reinterpret_cast<uint64_t>(ptr) | op;
+}
+
+} // namespace
+
+// 构造函数：初始化工作线程状态
+// 参数：
+//   id - 工作线程编号
+//   cfg - 服务端配置
+UringWorker::UringWorker(int id, const ServerConfig& cfg)
+    : WorkerBase(id, cfg), buffers_recycled(false) {
+    memset(&tick_interval, 0, sizeof(tick_interval));
+    tick_interval.tv_nsec = TIMER_RESOLUTION_MS * 1000000LL;  // 每个时间轮刻度推进一次
+}
+
+// 析构函数：停止工作线程并释放资源
+// 注：io_uring实例（ring成员）先于提供缓冲区环销毁，内核不会再写入已释放的缓冲区
+UringWorker::~UringWorker() {
+    stop();  // 先让事件循环退出，再清理连接
+    for (int client_fd : accepted) {
+        close_client_fd(client_fd);
+    }
+    connections.for_each([this](UringConnection& conn) {
+        close_client_fd(conn.fd);
+        buffer_pool.release(conn.rx_buf);
+        connections.release(&conn);
+    });
+}
+
+// 初始化io_uring实例、提供缓冲区环和eventfd
+// 参数：listen_fd - 本线程独占的监听套接字（多reactor模式），-1表示不监听
+// 返回：true成功，false失败（失败时不接管listen_fd，调用方可以把它交给epoll后端）
+bool UringWorker::init(int listen_fd) {
+    // COOP_TASKRUN：完成事件在本线程进入内核时产生，不打断用户态；
+    // TASKRUN_FLAG：有待产生的完成事件时内核置位IORING_SQ_TASKRUN，轮询时据此决定是否进入内核
+    int ret = ring.init(URING_ENTRIES,
+                        IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG);
+    if (ret < 0) {
+        LOG_ERROR("Worker %d io_uring setup failed (errno: %d)", id, -ret);
+        return false;
+    }
+    if (config.busy_poll_us > 0) {  // 内核不支持（EINVAL）或权限不足时退化为普通的阻塞等待
+        ret = ring.register_napi(static_cast<unsigned>(config.busy_poll_us), config.prefer_busy_poll);
+        if (ret < 0) {
+            LOG_WARN("Worker %d io_uring NAPI busy poll not enabled (errno: %d)", id, -ret);
+        }
+    }
+
+    // 提供缓冲区环需要5.19及以上内核，多路recv/accept需要6.0及以上内核
+    ret = buf_ring.init(ring, PROVIDED_BUFFERS, PROVIDED_BUFFER_SIZE, BUFFER_GROUP);
+    if (ret < 0) {
+        LOG_ERROR("Worker %d io_uring buffer ring register failed (errno: %d)", id, -ret);
+        return false;
+    }
+
+    if (!create_wakeup_fd()) {
+        return false;
+    }
+    this->listen_fd = listen_fd;  // 初始化成功后才接管所有权
+    if (config.zerocopy_threshold > 0) {
+        LOG_INFO("Worker %d io_uring backend ignores --zerocopy-threshold (epoll only)", id);
+    }
+    return true;
+}
+
+// 获取一个SQE，队列满时先提交已填写的SQE
+// 参数：may_submit - 是否允许提交
+// 返回：SQE指针，提交后仍无空闲SQE（或不允许提交）时返回nullptr
+struct io_uring_sqe* UringWorker::get_sqe(bool may_submit) {
+    struct io_uring_sqe* sqe = ring.get_sqe();
+    if (sqe == nullptr && may_submit) {
+        submit_pending();
+        sqe = ring.get_sqe();
+    }
+    return sqe;
+}
+
+// 提交已填写的SQE
+// 说明：-EBUSY（CQ溢出，需先处理完成事件）和-EINTR时SQ头不前进，SQ保持已满，
+//       由调用方在拿不到SQE时推迟，下一轮事件循环处理完完成事件后重试
+// 返回：io_uring_enter的返回值
+int UringWorker::submit_pending() {
+    int ret = ring.submit();
+    if (ret < 0 && ret != -EBUSY && ret != -EINTR) {
+        LOG_ERROR_RL("Worker %d io_uring submit failed (errno: %d)", id, -ret);
+    }
+    return ret;
+}
+
+// 提交多路accept：一次提交持续接受新连接，每个新连接产生一个完成事件
+void UringWorker::arm_accept() {
+    struct io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = make_user_data(nullptr, OP_ACCEPT);
+}
+
+// 提交eventfd的多路poll：接收线程投递新连接或停止时产生完成事件
+void UringWorker::arm_wakeup() {
+    struct io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeup_fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = make_user_data(nullptr, OP_WAKEUP);
+}
+
+// 提交周期定时器：每秒产生一个完成事件，驱动超时检查和统计日志
+void UringWorker::arm_tick() {
+    struct io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick_interval);
+    sqe->len = 1;
+    sqe->user_data = make_user_data(nullptr, OP_TICK);
+}
+
+// 提交连接的多路recv：由内核从提供缓冲区环中挑选缓冲区，每次接收产生一个完成事件
+// 参数：conn - 客户端连接
+void UringWorker::arm_recv(UringConnection& conn) {
+    struct io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr) {  // 提交后仍无空闲SQE（不应发生），稍后随缓冲区归还重试
+        conn.recv_starved = true;
+        starved.push_back(&conn);
+        return;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = static_cast<uint16_t>(buf_ring.group());
+    sqe->user_data = make_user_data(&conn, OP_RECV);
+    conn.recv_armed = true;
+    conn.recv_starved = false;
+    ++conn.inflight;
+}
+
+// 为新连接创建连接状态并提交多路recv
+// 参数：client_fd - 客户端文件描述符
+void UringWorker::register_connection(int client_fd) {
+    // 设置套接字选项（TCP_NODELAY等），失败时放弃该连接
+    if (!prepare_client_socket(client_fd)) {
+        close_client_fd(client_fd);
+        return;
+    }
+
+    // 从缓冲池取出接收缓冲区（报文在此拼接，回射直接引用该缓冲区）
+    char* rx_buf = buffer_pool.acquire();
+    if (rx_buf == nullptr) {
+        LOG_ERROR_RL("Buffer pool exhausted (fd: %d)", client_fd);
+        close_client_fd(client_fd);
+        return;
+    }
+    UringConnection* conn = connections.open(client_fd, rx_buf);
+    if (conn == nullptr) {
+        LOG_ERROR_RL("Connection table full (fd: %d)", client_fd);
+        buffer_pool.release(rx_buf);
+        close_client_fd(client_fd);
+        return;
+    }
+    metrics.counters.add(SRV_ACCEPTS);
+    note_locality(client_fd);
+    arm_recv(*conn);
+    schedule_timeout(*conn, false);  // 空闲超时从连接建立起计时
+}
+
+// 开始排空：取消多路accept并关闭本线程的监听套接字，按排空规则重新设置所有连接的超时
+// 说明：在途的多路accept持有监听套接字的引用，只关闭fd不会使其停止，必须先取消
+void UringWorker::start_drain() {
+    if (listen_fd != -1) {
+        struct io_uring_sqe* sqe = get_sqe();
+        if (sqe != nullptr) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = make_user_data(nullptr, OP_ACCEPT);
+            sqe->user_data = make_user_data(nullptr, OP_CANCEL);
+        }
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    connections.for_each([this](UringConnection& conn) {
+        if (!conn.closing) schedule_timeout(conn, conn.sends_inflight > 0);
+    });
+}
+
+// 接管多路accept得到的新连接，每轮最多accept_budget个
+// 说明：多路accept在内核中持续接受连接，无法按轮限流；这里限制的是每轮事件循环中
+//       初始化连接（套接字选项、缓冲区和recv提交）的数量，剩余连接留到下一轮，
+//       连接风暴期间已有连接的完成事件不会被长时间阻塞
+void UringWorker::adopt_accepted() {
+    size_t count = accepted.size();
+    if (config.accept_budget > 0 && count > static_cast<size_t>(config.accept_budget)) {
+        count = static_cast<size_t>(config.accept_budget);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        register_connection(accepted[i]);
+    }
+    accepted.erase(accepted.begin(), accepted.begin() + count);
+}
+
+// 开始关闭连接：取消多路recv并关闭套接字的收发方向，在途send随之失败返回
+// 说明：在途操作的完成事件仍会引用连接槽位，因此等它们全部返回后才由finish_close释放
+// 参数：conn - 客户端连接
+void UringWorker::close_client(UringConnection& conn) {
+    if (conn.closing) return;
+    conn.closing = true;
+    LOG_INFO("Closed connection for fd: %d", conn.fd);
+    metrics.counters.add(SRV_CLOSES);
+    timers.cancel(conn.timer);
+
+    // 暂存的提供缓冲区不再需要，立即归还
+    for (const UringConnection::PendingBuffer& buf : conn.pending) {
+        buf_ring.recycle(buf.bid);
+        buffers_recycled = true;
+    }
+    conn.pending.clear();
+    conn.pending_bytes = 0;
+
+    if (conn.recv_armed) {
+        cancel_recv(conn);
+    }
+    shutdown(conn.fd, SHUT_RDWR);
+
+    if (conn.inflight == 0) {
+        finish_close(conn);
+    }
+}
+
+// 取消连接的多路recv：完成事件以-ECANCELED（或不带IORING_CQE_F_MORE）返回
+// 参数：conn - 客户端连接
+void UringWorker::cancel_recv(UringConnection& conn) {
+    struct io_uring_sqe* sqe = get_sqe();
+    if (sqe == nullptr) return;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = make_user_data(&conn, OP_RECV);
+    sqe->user_data = make_user_data(nullptr, OP_CANCEL);
+}
+
+// 在途操作全部结束后释放连接资源
+// 参数：conn - 客户端连接
+void UringWorker::finish_close(UringConnection& conn) {
+    close_client_fd(conn.fd);
+    buffer_pool.release(conn.rx_buf);  // 归还缓冲区供后续连接复用
+    connections.release(&conn);
+}
+
+// 推进连接：整理接收缓冲区、拷入暂存数据、切分完整报文并以链式send回射
+// 说明：在途send引用接收缓冲区，因此只在没有在途send时推进；
+//       send全部完成后由on_send再次调用，继续处理剩余数据。
+//       阶段耗时：整个推进过程计入parse，send链从提交到全部完成计入write；
+//       recv为内核异步完成，没有对应的read阶段，写阻塞由MSG_WAITALL在内核中等待，
+//       也不单独计时
+// 参数：conn - 客户端连接
+void UringWorker::pump(UringConnection& conn) {
+    if (conn.closing || conn.sends_inflight > 0) return;
+    auto start = std::chrono::steady_clock::now();
+
+    // 整理接收缓冲区：末尾不完整的报文移到开头
+    size_t remaining = conn.rx_end - conn.rx_start;
+    if (remaining > 0 && conn.rx_start > 0) {
+        memmove(conn.rx_buf, conn.rx_buf + conn.rx_start, remaining);
+    }
+    conn.rx_start = 0;
+    conn.rx_end = remaining;
+
+    // 按接收顺序把暂存的提供缓冲区拷入接收缓冲区，拷完的缓冲区立即归还内核
+    size_t consumed = 0;
+    for (UringConnection::PendingBuffer& buf : conn.pending) {
+        size_t space = RX_BUFFER_SIZE - conn.rx_end;
+        if (space == 0) break;
+        size_t chunk = buf.len - buf.offset;
+        if (chunk > space) chunk = space;
+        if (conn.rx_start == conn.rx_end) {  // 缓冲区从空变为非空：未完成报文开始计时
+            conn.stage_start = std::chrono::steady_clock::now();
+        }
+        memcpy(conn.rx_buf + conn.rx_end, buf_ring.buffer(buf.bid) + buf.offset, chunk);
+        conn.rx_end += chunk;
+        conn.pending_bytes -= chunk;
+        buf.offset += static_cast<uint32_t>(chunk);
+        if (buf.offset < buf.len) break;
+        buf_ring.recycle(buf.bid);
+        buffers_recycled = true;
+        ++consumed;
+    }
+    conn.pending.erase(conn.pending.begin(), conn.pending.begin() + consumed);
+
+    // 暂存数据已回落到高水位以下：恢复接收（取消尚未完成时由其完成事件再次推进）
+    if (conn.recv_paused && !conn.recv_armed &&
+        conn.pending_bytes < static_cast<size_t>(config.output_high_water)) {
+        conn.recv_paused = false;
+        if (!conn.peer_closed) arm_recv(conn);
+    }
+
+    // 一整条send链须在同一次提交中（链被拆到两次提交中会失去顺序保证）：
+    // 空间不足一整批时先提交已填写的SQE，仍不足时按剩余空间缩小本批
+    // （另留两个位置给流式报文的前后两段）
+    if (ring.sq_space() < MAX_BATCH_FRAMES + 2) {
+        submit_pending();
+    }
+    unsigned space = ring.sq_space();
+    size_t max_frames = space > 2 ? std::min<size_t>(MAX_BATCH_FRAMES, space - 2) : 0;
+
+    // 每段回射数据作为一个send，前一个send设置IOSQE_IO_LINK，按顺序依次执行；
+    // MSG_WAITALL让内核在套接字可写后续传，直到整段写完。
+    // 拿不到SQE（SQ已满且提交失败）时停止本批：数据留在接收缓冲区，连接进入sq_starved，
+    // 下一轮事件循环提交并处理完完成事件后重新推进
+    struct io_uring_sqe* prev = nullptr;
+    bool sq_full = false;
+    auto submit_send = [&](const char* data, size_t len) {
+        struct io_uring_sqe* sqe = sq_full ? nullptr : get_sqe(prev == nullptr);
+        if (sqe == nullptr) {
+            sq_full = true;
+            return false;
+        }
+        if (prev != nullptr) prev->flags |= IOSQE_IO_LINK;
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = static_cast<uint32_t>(len);
+        sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+        sqe->user_data = make_user_data(&conn, OP_SEND);
+        prev = sqe;
+        ++conn.inflight;
+        ++conn.sends_inflight;
+        conn.send_bytes_pending += len;
+        return true;
+    };
+
+    // 流式回射中的大报文：先转发接收缓冲区中属于它的数据，转发完后其余数据按普通报文切分
+    if (conn.state == ConnState::STREAM_PAYLOAD) {
+        size_t chunk = conn.rx_end - conn.rx_start;
+        if (chunk > conn.payload_remaining) chunk = conn.payload_remaining;
+        if (chunk > 0 && submit_send(conn.rx_buf + conn.rx_start, chunk)) {
+            conn.rx_start += chunk;
+            conn.payload_remaining -= chunk;
+            conn.stage_start = std::chrono::steady_clock::now();
+        }
+        if (conn.payload_remaining == 0) {  // 整条报文转发完成：回到报文头阶段
+            ++conn.frames;
+            metrics.counters.add(SRV_FRAMES);
+            LOG_DEBUG("Processed msg_id: %u, fd: %d (streamed)", conn.payload_msg_id, conn.fd);
+            conn.state = ConnState::READ_HEADER;
+        }
+    }
+
+    // 每条完整报文（报文头与数据在接收缓冲区中连续）作为一个send
+    FrameStatus status = FrameStatus::NEED_HEADER;
+    FrameInfo partial = FrameInfo();  // frame_len为0表示末尾没有未收全的报文
+    if (conn.state != ConnState::STREAM_PAYLOAD && !sq_full) {
+        status = consume_frames(conn, config.max_message_size, [&](const char* frame, const FrameInfo& info) {
+            if (!submit_send(frame, info.frame_len)) return false;
+            metrics.counters.add(SRV_FRAMES);
+            ECHO_PROBE3(frame, conn.fd, info.msg_id, info.frame_len);
+            begin_trace(conn, info.msg_id, conn.bytes_out + conn.send_bytes_pending);
+            return true;
+        }, max_frames, &partial);
+    }
+    metrics.stages[STAGE_PARSE].record_since(start);
+    ECHO_PROBE2(queue, conn.fd, conn.send_bytes_pending);
+    mark_trace(conn, TRACE_QUEUE);
+    if (is_frame_error(status)) {  // 报文非法（魔数、长度或报文头校验错误）
+        count_frame_error(status);
+        close_client(conn);
+        return;
+    }
+
+    // 末尾是放不进缓冲区整条缓存的大报文：已收到的部分随本批send立即回射，之后改为流式回射
+    // （在途send引用接收缓冲区，每段数据写完后才接收下一段，内存占用与报文大小无关）
+    if (partial.frame_len > 0 && partial.data_len > static_cast<uint32_t>(BUFFER_SIZE) &&
+        submit_send(conn.rx_buf + conn.rx_start, conn.rx_end - conn.rx_start)) {
+        size_t buffered = conn.rx_end - conn.rx_start;
+        conn.rx_start = conn.rx_end;
+        conn.payload_remaining = partial.frame_len - buffered;
+        conn.payload_msg_id = partial.msg_id;
+        conn.state = ConnState::STREAM_PAYLOAD;
+        conn.stage_start = std::chrono::steady_clock::now();
+    }
+    bool deferred = sq_full || (max_frames == 0 && conn.rx_end > conn.rx_start);
+    if (deferred && !conn.send_starved) {  // 本轮未能切分完：等待SQ空间
+        conn.send_starved = true;
+        sq_starved.push_back(&conn);
+    }
+    if (conn.sends_inflight > 0) {  // 本批send链随下一次提交发出
+        conn.write_start = std::chrono::steady_clock::now();
+        ECHO_PROBE2(write_start, conn.fd, conn.send_bytes_pending);
+        mark_trace(conn, TRACE_WRITE_START);
+    }
+
+    // 对端已关闭且没有可回射的数据：结束连接（末尾不完整的报文丢弃）
+    if (conn.peer_closed && conn.sends_inflight == 0 && !deferred) {
+        LOG_INFO("Client disconnected (fd: %d) while %s", conn.fd,
+                 conn.state == ConnState::READ_HEADER ? "reading header" : "reading data");
+        close_client(conn);
+    }
+}
+
+// 处理recv完成事件
+// 参数：
+//   conn - 客户端连接
+//   cqe - 完成事件
+void UringWorker::on_recv(UringConnection& conn, const struct io_uring_cqe& cqe) {
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+    if (!more) {  // 多路recv已结束
+        conn.recv_armed = false;
+        --conn.inflight;
+    }
+
+    if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER) != 0) {
+        unsigned bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        if (conn.closing) {
+            buf_ring.recycle(bid);
+            buffers_recycled = true;
+        } else {
+            UringConnection::PendingBuffer buf;
+            buf.bid = static_cast<uint16_t>(bid);
+            buf.offset = 0;
+            buf.len = static_cast<uint32_t>(cqe.res);
+            conn.pending.push_back(buf);
+            conn.pending_bytes += buf.len;
+            conn.bytes_in += cqe.res;
+            metrics.counters.add(SRV_BYTES_IN, cqe.res);
+            ECHO_PROBE2(recv, conn.fd, cqe.res);
+            if (tracer.enabled()) rx_ns = trace_now_ns();
+            LOG_DEBUG("FD %d read %d bytes (buffered: %zu)", conn.fd, cqe.res, conn.rx_end - conn.rx_start);
+        }
+    } else if (cqe.res == 0) {  // 客户端主动断开连接：回射完已收到的报文后关闭
+        conn.peer_closed = true;
+    } else if (cqe.res == -ENOBUFS) {  // 提供缓冲区耗尽：等其他连接归还缓冲区后重新提交
+        if (!more && !conn.closing && !conn.recv_starved) {
+            conn.recv_starved = true;
+            starved.push_back(&conn);
+        }
+    } else if (cqe.res == -ECANCELED && conn.recv_paused) {  // 暂停读取而取消的多路recv
+    } else if (cqe.res < 0 && !conn.closing) {
+        LOG_ERROR_RL("Read failed (fd: %d, errno: %d)", conn.fd, -cqe.res);
+        close_client(conn);
+    }
+
+    if (conn.closing) {
+        if (conn.inflight == 0) finish_close(conn);
+        return;
+    }
+    // 回射跟不上接收（对端读得慢）：暂存数据达到高水位时取消多路recv，
+    // 不再占用共享的提供缓冲区，背压经TCP窗口传回客户端
+    if (!conn.recv_paused && conn.pending_bytes >= static_cast<size_t>(config.output_high_water)) {
+        conn.recv_paused = true;
+        if (conn.recv_armed) cancel_recv(conn);
+    }
+    // 多路recv意外结束（如内核主动终止）：未断开且未暂停时重新提交
+    if (!more && !conn.peer_closed && !conn.recv_starved && !conn.recv_paused) {
+        arm_recv(conn);
+    }
+    pump(conn);
+}
+
+// 处理send完成事件：同一批send全部完成后检查是否完整写出，并继续处理剩余数据
+// 参数：
+//   conn - 客户端连接
+//   cqe - 完成事件
+void UringWorker::on_send(UringConnection& conn, const struct io_uring_cqe& cqe) {
+    --conn.inflight;
+    --conn.sends_inflight;
+    if (cqe.res > 0) {
+        conn.bytes_out += cqe.res;
+        metrics.counters.add(SRV_BYTES_OUT, cqe.res);
+        conn.send_bytes_pending -= static_cast<size_t>(cqe.res);
+    } else if (!conn.closing) {  // 写入失败（链中后续send以-ECANCELED返回）
+        LOG_ERROR_RL("Write response failed (fd: %d, errno: %d)", conn.fd, -cqe.res);
+        close_client(conn);
+    }
+
+    if (conn.closing) {
+        if (conn.inflight == 0) finish_close(conn);
+        return;
+    }
+    if (conn.sends_inflight > 0) return;
+    metrics.stages[STAGE_WRITE].record_since(conn.write_start);
+
+    if (conn.send_bytes_pending != 0) {  // MSG_WAITALL下仍出现短写：视为写入失败
+        LOG_ERROR_RL("Write response failed (fd: %d, short send)", conn.fd);
+        close_client(conn);
+        return;
+    }
+    ECHO_PROBE2(write_done, conn.fd, conn.bytes_out);
+    finish_trace(conn);
+    pump(conn);
+}
+
+// 处理一个完成事件
+// 参数：cqe - 完成事件
+void UringWorker::handle_cqe(const struct io_uring_cqe& cqe) {
+    uint64_t op = cqe.user_data & OP_MASK;
+    UringConnection* conn = reinterpret_cast<UringConnection*>(cqe.user_data & ~OP_MASK);
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    switch (op) {
+    case OP_RECV:
+        on_recv(*conn, cqe);
+        // 按处理后的状态刷新超时（多数情况下只是一次比较）
+        if (conn->in_use && !conn->closing) schedule_timeout(*conn, conn->sends_inflight > 0);
+        break;
+    case OP_SEND:
+        on_send(*conn, cqe);
+        if (conn->in_use && !conn->closing) schedule_timeout(*conn, conn->sends_inflight > 0);
+        break;
+    case OP_ACCEPT:
+        if (cqe.res >= 0) {
+            struct sockaddr_in client_addr;
+            socklen_t client_len = sizeof(client_addr);
+            memset(&client_addr, 0, sizeof(client_addr));
+            getpeername(cqe.res, (struct sockaddr*)&client_addr, &client_len);
+            if (!admit_connection(cqe.res, &client_addr)) {  // 超出准入上限：已拒绝
+                if (!more && running && listen_fd != -1) arm_accept();
+                break;
+            }
+            LOG_INFO("Worker %d new connection from %s:%d (fd: %d)",
+                     id, inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), cqe.res);
+            accepted.push_back(cqe.res);  // 由adopt_accepted按接受预算分批接管
+        } else {
+            LOG_ERROR_RL("Worker %d accept failed (errno: %d)", id, -cqe.res);
+        }
+        if (!more && running && listen_fd != -1) arm_accept();
+        break;
+    case OP_WAKEUP:  // 有新连接投递到本线程（或停止通知、排空请求）
+        for (int client_fd : take_pending()) {
+            register_connection(client_fd);
+        }
+        if (enter_drain()) start_drain();
+        if (!more && running) arm_wakeup();
+        break;
+    case OP_TICK: {
+        auto now = std::chrono::steady_clock::now();
+        check_timeouts(now);
+        if (config.stats_interval > 0 && now - last_stats >= std::chrono::seconds(config.stats_interval)) {
+            log_stats();
+            last_stats = now;
+        }
+        if (running) arm_tick();
+        break;
+    }
+    default:  // 取消请求的完成事件
+        break;
+    }
+}
+
+// 事件循环：提交已填写的SQE并等待完成事件，一次系统调用同时完成提交和等待
+void UringWorker::run() {
+    place_thread();  // 可选的CPU亲和性和NUMA放置
+
+    arm_wakeup();
+    arm_tick();
+    if (listen_fd != -1) {
+        arm_accept();
+    }
+    last_stats = std::chrono::steady_clock::now();
+
+    while (running) {
+        // 还有待接管的新连接时，或轮询策略要求继续轮询时只提交不等待
+        auto now = std::chrono::steady_clock::now();
+        bool may_block = poll_may_block(now);
+        bool wait = accepted.empty() && sq_starved.empty() && may_block;
+        int ret = ring.submit(wait ? 1 : 0);
+        if (ret < 0 && ret != -EINTR && ret != -EBUSY) {
+            LOG_ERROR("Worker %d io_uring enter failed (errno: %d)", id, -ret);
+            break;
+        }
+
+        buffers_recycled = false;
+        unsigned completions = ring.for_each_cqe([this](const struct io_uring_cqe& cqe) {
+            handle_cqe(cqe);
+        });
+        record_poll(wait, may_block, completions > 0, now);
+        if (!accepted.empty()) {
+            adopt_accepted();
+        }
+        // 上一轮因SQ已满未能提交send链的连接：本轮已提交并处理完完成事件，重新推进
+        if (!sq_starved.empty()) {
+            std::vector<UringConnection*> waiting;
+            waiting.swap(sq_starved);
+            for (UringConnection* conn : waiting) {
+                // 等待期间连接可能已关闭（槽位复用时send_starved会被复位）
+                if (conn->in_use && conn->send_starved && !conn->closing) {
+                    conn->send_starved = false;
+                    pump(*conn);
+                }
+            }
+        }
+        if (draining && connections.size() == 0 && accepted.empty()) {  // 排空完成（关闭中的连接也已释放）
+            LOG_INFO("Worker %d drained", id);
+            break;
+        }
+
+        // 有缓冲区归还：发布给内核，并为因缓冲区耗尽而停止接收的连接重新提交多路recv
+        if (buffers_recycled) {
+            buf_ring.publish();
+            std::vector<UringConnection*> waiting;
+            waiting.swap(starved);
+            for (UringConnection* conn : waiting) {
+                // 等待期间连接可能已关闭（槽位复用时recv_starved会被复位）
+                if (conn->in_use && conn->recv_starved && !conn->closing) {
+                    if (conn->recv_paused) {  // 已因高水位暂停：由pump在回射跟上后重新提交
+                        conn->recv_starved = false;
+                    } else {
+                        arm_recv(*conn);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 处理到期的超时定时器：关闭报文头读取超过3秒、数据读取超过5秒仍未完成、
+// 空闲超过空闲超时或send链持续未完成超过写超时（慢消费者）的连接
+// 说明：由周期定时器每个时间轮刻度调用一次，只访问到期的定时器
+// 参数：now - 当前时间
+void UringWorker::check_timeouts(std::chrono::steady_clock::time_point now) {
+    timers.advance(now, [&](TimerNode& node) {
+        UringConnection& conn = *static_cast<UringConnection*>(static_cast<Connection*>(node.owner));
+        if (conn.closing) return;
+        if (timeout_expired(conn, conn.sends_inflight > 0, now)) {
+            close_client(conn);
+        }
+    });
+}
+
+// 输出本线程的统计日志
+void UringWorker::log_stats() {
+    BufferPoolStats s = buffer_pool.stats();
+    LOG_INFO("Worker %d (io_uring) buffer pool: hits=%llu, misses=%llu, in_use=%llu, capacity=%llu, slabs=%llu, connections=%zu",
+             id, static_cast<unsigned long long>(s.hits), static_cast<unsigned long long>(s.misses),
+             static_cast<unsigned long long>(s.in_use), static_cast<unsigned long long>(s.capacity),
+             static_cast<unsigned long long>(s.slabs), connections.size());
+    LOG_INFO("Worker %d polls: blocking=%llu, spin=%llu, empty_spin=%llu", id,
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_BLOCKING)),
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_SPINS)),
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_EMPTY_SPINS)));
+}
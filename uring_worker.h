@@ -0,0 +1,158 @@
+#ifndef URING_WORKER_H
+#define URING_WORKER_H
+
+#include "worker_base.h"          // 包含工作线程基类
+#include "connection.h"           // 包含连接状态结构
+#include "connection_table.h"     // 包含按fd索引的连接表
+#include "uring.h"                // 包含io_uring封装
+#include <vector>                 // 用于暂存待处理的接收缓冲区
+#include <chrono>                 // 用于统计日志计时
+
+// io_uring连接状态：在通用连接状态之上记录在途操作，保证操作全部完成前不释放槽位
+struct UringConnection : public Connection
+{
+    // 已收到但尚未拷入接收缓冲区的提供缓冲区（接收缓冲区被在途发送占用时暂存）
+    struct PendingBuffer
+    {
+        uint16_t bid;       // 缓冲区编号
+        uint32_t offset;    // 已拷贝的字节数
+        uint32_t len;       // 有效数据长度
+    };
+
+    std::vector<PendingBuffer> pending;   // 暂存的提供缓冲区（按接收顺序）
+    size_t pending_bytes;                 // 暂存缓冲区中尚未拷入接收缓冲区的字节数
+    uint32_t inflight;                    // 在途操作数（recv + send）
+    uint32_t sends_inflight;              // 在途send数
+    size_t send_bytes_pending;            // 在途send尚未确认写出的字节数（用于发现短写）
+    bool recv_armed;                      // 多路recv是否仍在生效
+    bool recv_starved;                    // 多路recv因提供缓冲区耗尽而结束，等待缓冲区归还后重新提交
+    bool send_starved;                    // SQ已满、本轮未能提交send链，等待下一轮提交后重新推进
+    bool recv_paused;                     // 暂存数据达到高水位，多路recv已取消，回射跟上后重新提交
+    bool peer_closed;                     // 对端已关闭（回射完已收到的报文后关闭连接）
+    bool closing;                         // 正在关闭（等待在途操作结束）
+
+    UringConnection()
+        : pending_bytes(0), inflight(0), sends_inflight(0), send_bytes_pending(0), recv_armed(false),
+          recv_starved(false), send_starved(false), recv_paused(false), peer_closed(false), closing(false) {}
+
+    // 为新连接复位槽位
+    // 参数：
+    //   fd - 客户端文件描述符
+    //   rx_buf - 接收缓冲区
+    void reset(int fd, char* rx_buf) {
+        Connection::reset(fd, rx_buf);
+        pending.clear();
+        pending_bytes = 0;
+        inflight = 0;
+        sends_inflight = 0;
+        send_bytes_pending = 0;
+        recv_armed = false;
+        recv_starved = false;
+        send_starved = false;
+        recv_paused = false;
+        peer_closed = false;
+        closing = false;
+    }
+};
+
+// io_uring工作线程：用多路accept、基于提供缓冲区环的多路recv和链式send处理连接
+// 说明：报文校验与切分与epoll后端共用（见protocol.h），两种后端的结果可以直接对比。
+//       一批完整报文的报文头和数据依次作为链式send（IOSQE_IO_LINK + MSG_WAITALL）提交，
+//       保证顺序；在途send引用接收缓冲区，全部完成后才整理接收缓冲区并继续处理
+class UringWorker : public WorkerBase
+{
+private:
+    // 注：buf_ring声明在ring之前，析构时先关闭io_uring实例再释放缓冲区
+    ProvidedBufferRing buf_ring;                // 多路recv使用的提供缓冲区环
+    IoUring ring;                               // io_uring实例
+    ConnectionTable<UringConnection> connections;  // 按fd索引的连接表
+    std::vector<UringConnection*> starved;      // 等待提供缓冲区的连接
+    std::vector<UringConnection*> sq_starved;   // 等待SQ空间提交send链的连接
+    std::vector<int> accepted;                  // 多路accept得到、尚未接管的新连接
+    bool buffers_recycled;                      // 本轮是否有提供缓冲区被归还
+    struct __kernel_timespec tick_interval;     // 周期定时器间隔（提交后需保持有效）
+    std::chrono::steady_clock::time_point last_stats;  // 上次输出统计日志的时间
+
+    // 事件循环：提交操作并处理完成事件
+    void run() override;
+
+    // 处理一个完成事件
+    void handle_cqe(const struct io_uring_cqe& cqe);
+
+    // 获取一个SQE，队列满时先提交已填写的SQE
+    // 参数：may_submit - 是否允许提交（正在填写链式SQE时不能提交，否则链被拆到两次提交中、失去顺序保证）
+    // 返回：SQE指针，nullptr表示SQ已满（提交失败，或不允许提交）
+    struct io_uring_sqe* get_sqe(bool may_submit = true);
+
+    // 提交已填写的SQE（只提交不等待），失败时记录日志
+    // 返回：io_uring_enter的返回值（负数为-errno）
+    int submit_pending();
+
+    // 提交多路accept（仅多reactor模式）
+    void arm_accept();
+
+    // 提交eventfd的多路poll（接收新连接投递和停止通知）
+    void arm_wakeup();
+
+    // 提交周期定时器（超时检查和统计日志）
+    void arm_tick();
+
+    // 提交连接的多路recv
+    void arm_recv(UringConnection& conn);
+
+    // 为新连接创建连接状态并提交多路recv
+    // 参数：client_fd - 客户端文件描述符
+    void register_connection(int client_fd);
+
+    // 开始排空：取消多路accept，按排空规则重新设置所有连接的超时
+    void start_drain();
+
+    // 接管已接受的新连接（每轮最多accept_budget个）
+    void adopt_accepted();
+
+    // 处理recv完成事件
+    void on_recv(UringConnection& conn, const struct io_uring_cqe& cqe);
+
+    // 处理send完成事件
+    void on_send(UringConnection& conn, const struct io_uring_cqe& cqe);
+
+    // 推进连接：整理接收缓冲区、拷入暂存数据、切分完整报文并提交链式send
+    void pump(UringConnection& conn);
+
+    // 开始关闭连接：停止收发，等待在途操作结束后再释放资源
+    void close_client(UringConnection& conn);
+
+    // 在途操作全部结束后释放连接资源
+    void finish_close(UringConnection& conn);
+
+    // 取消连接的多路recv（关闭连接或暂停读取时调用）
+    // 参数：conn - 客户端连接
+    void cancel_recv(UringConnection& conn);
+
+    // 推进超时时间轮，关闭读取、空闲或写阻塞超时的连接
+    // 参数：now - 当前时间
+    void check_timeouts(std::chrono::steady_clock::time_point now);
+
+    // 输出本线程的统计日志（缓冲池命中率等）
+    void log_stats();
+
+public:
+    // 构造函数：初始化工作线程编号和配置
+    // 参数：
+    //   id - 工作线程编号
+    //   cfg - 服务端配置
+    UringWorker(int id, const ServerConfig& cfg);
+
+    // 析构函数：停止工作线程并释放资源
+    ~UringWorker() override;
+
+    // 初始化io_uring实例、提供缓冲区环和eventfd
+    // 参数：listen_fd - 本线程独占的非阻塞监听套接字（多reactor模式），-1表示不监听
+    // 返回：true成功，false失败（内核不支持时调用方可回退到epoll）
+    bool init(int listen_fd) override;
+
+    // 后端名称
+    const char* backend_name() const override { return "io_uring"; }
+};
+
+#endif // URING_WORKER_H
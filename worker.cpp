@@ -0,0 +1,693 @@
+#include "worker.h"
+#include "socket_utils.h"     // 用于accept4和套接字选项
+#include <sys/epoll.h>        // 用于epoll事件驱动机制
+#include <sys/ioctl.h>        // 用于设置epoll忙轮询参数（EPIOCSPARAMS）
+#include <sys/socket.h>       // 用于套接字系统调用
+#include <sys/un.h>           // 用于识别Unix域连接（sockaddr_un）
+#include <netinet/in.h>       // 用于网络地址结构（sockaddr_in）
+#include <arpa/inet.h>        // 用于字节序转换（ntohl等）和IP地址转换
+#include <unistd.h>           // 用于read/write/close等系统调用
+#include <fcntl.h>            // 用于pipe2/splice
+#include <errno.h>            // 用于错误码（errno）
+#include <chrono>             // 用于时间相关操作（超时控制）
+#include <cstring>            // 用于内存操作（memcpy/memmove）
+
+namespace {
+
+// epoll实例的忙轮询参数（与内核struct epoll_params布局一致，6.9起支持；旧版头文件没有该定义）
+struct EpollBusyPollParams
+{
+    uint32_t busy_poll_usecs;     // epoll_wait在睡眠前忙轮询网卡队列的微秒数
+    uint16_t busy_poll_budget;    // 每次忙轮询最多处理的数据包数（0表示内核默认值）
+    uint8_t prefer_busy_poll;     // 忙轮询期间抑制网卡软中断
+    uint8_t pad;                  // 必须为0
+};
+
+#ifndef EPIOCSPARAMS
+#define EPIOCSPARAMS _IOW(0x8A, 0x01, EpollBusyPollParams)
+#endif
+
+} // namespace
+
+// 构造函数：初始化工作线程状态
+// 参数：
+//   id - 工作线程编号
+//   cfg - 服务端配置
+Worker::Worker(int id, const ServerConfig& cfg)
+    : WorkerBase(id, cfg), epoll_fd(-1), accept_pending(false), output_bytes(0),
+      output_limit(static_cast<size_t>(cfg.max_inflight_bytes > 0 ? cfg.max_inflight_bytes : 0)) {}
+
+// 析构函数：停止工作线程并释放资源
+Worker::~Worker() {
+    stop();  // 先让事件循环退出，再清理连接
+    // 关闭本线程名下仍存活的连接，并把缓冲区归还缓冲池
+    connections.for_each([this](Connection& conn) {
+        close_client_fd(conn.fd);
+        release_pipe(conn);
+        buffer_pool.release(conn.rx_buf);
+        connections.release(&conn);
+    });
+    if (epoll_fd != -1) close(epoll_fd);
+}
+
+// 初始化epoll实例和唤醒用的eventfd
+// 参数：listen_fd - 本线程独占的监听套接字（多reactor模式），-1表示不监听
+// 返回：true成功，false失败
+bool Worker::init(int listen_fd) {
+    this->listen_fd = listen_fd;  // 先接管所有权，失败时由析构函数关闭
+
+    // 创建epoll实例
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        LOG_ERROR("Worker %d epoll create failed (errno: %d)", id, errno);
+        return false;
+    }
+
+    // 创建非阻塞eventfd，用于接收线程投递新连接后唤醒本线程
+    if (!create_wakeup_fd()) {
+        return false;
+    }
+
+    // 内核忙轮询：epoll_wait睡眠前先轮询本实例上连接所属的网卡队列；
+    // 内核不支持（ENOTTY）或权限不足时只记录日志，退化为普通的阻塞等待
+    if (config.busy_poll_us > 0) {
+        EpollBusyPollParams params;
+        memset(&params, 0, sizeof(params));
+        params.busy_poll_usecs = static_cast<uint32_t>(config.busy_poll_us);
+        params.prefer_busy_poll = config.prefer_busy_poll ? 1 : 0;
+        if (ioctl(epoll_fd, EPIOCSPARAMS, &params) == -1) {
+            LOG_WARN("Worker %d epoll busy poll not enabled (errno: %d)", id, errno);
+        }
+    }
+
+    // 注册eventfd到epoll（可读事件）
+    // 注：客户端事件的data.ptr指向连接槽位，eventfd和监听套接字则用成员变量地址作为标记
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &wakeup_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event) == -1) {
+        LOG_ERROR("Worker %d epoll add wakeup_fd failed", id);
+        return false;
+    }
+
+    // 多reactor模式：注册本线程的监听套接字（可读事件，边缘触发）
+    if (listen_fd != -1) {
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = &this->listen_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == -1) {
+            LOG_ERROR("Worker %d epoll add listen_fd failed", id);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 接管新连接：分配缓冲区并注册到本线程的epoll
+void Worker::adopt_pending() {
+    for (int client_fd : take_pending()) {
+        register_connection(client_fd);
+    }
+}
+
+// 开始排空：关闭本线程的监听套接字，并按排空规则重新设置所有连接的超时
+void Worker::start_drain() {
+    if (listen_fd != -1) {
+        close(listen_fd);  // 内核会自动将其从epoll中移除
+        listen_fd = -1;
+        accept_pending = false;
+    }
+    connections.for_each([this](Connection& conn) {
+        schedule_timeout(conn, conn.want_write);
+    });
+}
+
+// 接受本线程监听套接字上的新连接（多reactor模式），每轮最多接受accept_budget个
+// 说明：监听套接字为边缘触发，用完预算时置accept_pending，下一轮不等待直接继续接受，
+//       连接风暴期间已有连接的事件处理不会被长时间阻塞
+void Worker::handle_accept() {
+    accept_pending = false;
+    int accepted = 0;
+    while (true) {  // 接受到EAGAIN或用完预算为止
+        if (config.accept_budget > 0 && accepted >= config.accept_budget) {
+            accept_pending = true;
+            break;
+        }
+        struct sockaddr_in client_addr;  // 客户端地址结构
+        int client_fd = accept_client(listen_fd, client_addr);
+        if (client_fd == -1) {  // 接受失败
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR_RL("Worker %d accept failed (errno: %d)", id, errno);
+            }
+            break;  // 没有更多连接或出错，退出循环
+        }
+        ++accepted;
+        if (!admit_connection(client_fd, &client_addr)) continue;  // 超出准入上限：已拒绝
+
+        // 输出客户端连接信息
+        LOG_INFO("Worker %d new connection from %s:%d (fd: %d)",
+                 id, inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), client_fd);
+        register_connection(client_fd);
+    }
+}
+
+// 为新连接创建连接状态并注册到本线程的epoll
+// 参数：client_fd - 客户端文件描述符
+void Worker::register_connection(int client_fd) {
+    // 设置套接字选项（TCP_NODELAY等），失败时放弃该连接
+    if (!prepare_client_socket(client_fd)) {
+        close_client_fd(client_fd);
+        return;
+    }
+
+    // 从缓冲池取出接收缓冲区（优先复用已关闭连接归还的缓冲区）
+    char* rx_buf = buffer_pool.acquire();
+    if (rx_buf == nullptr) {
+        LOG_ERROR_RL("Buffer pool exhausted (fd: %d)", client_fd);
+        close_client_fd(client_fd);
+        return;
+    }
+    // 占用fd对应的连接表槽位
+    Connection* conn = connections.open(client_fd, rx_buf);
+    if (conn == nullptr) {
+        LOG_ERROR_RL("Connection table full (fd: %d)", client_fd);
+        buffer_pool.release(rx_buf);
+        close_client_fd(client_fd);
+        return;
+    }
+    metrics.counters.add(SRV_ACCEPTS);  // 之后的失败路径经close_client计入关闭数
+
+    // 注册客户端套接字到本线程epoll（可读事件，边缘触发），data.ptr直接指向连接槽位
+    // 注：连接只归属本线程，不会被其他线程并发处理，因此无需EPOLLONESHOT
+    struct epoll_event client_event;
+    client_event.events = EPOLLIN | EPOLLET;
+    client_event.data.ptr = conn;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &client_event) == -1) {
+        LOG_ERROR_RL("Epoll add client_fd failed (fd: %d)", client_fd);
+        close_client(*conn);  // 清理失败的客户端
+        return;
+    }
+    conn->weight = connection_weight(client_fd);
+    note_locality(client_fd);
+    schedule_timeout(*conn, false);  // 空闲超时从连接建立起计时
+}
+
+// 按连接所属的监听套接字取调度权重
+// 说明：两种监听套接字权重相同时不查询本端地址
+// 参数：client_fd - 客户端文件描述符
+// 返回：调度权重（至少为1）
+uint32_t Worker::connection_weight(int client_fd) const {
+    int weight = config.tcp_weight;
+    if (config.unix_weight != config.tcp_weight) {
+        struct sockaddr_un addr;
+        socklen_t len = sizeof(addr);
+        if (getsockname(client_fd, reinterpret_cast<struct sockaddr*>(&addr), &len) == 0 &&
+            addr.sun_family == AF_UNIX) {
+            weight = config.unix_weight;
+        }
+    }
+    return weight > 0 ? static_cast<uint32_t>(weight) : 1;
+}
+
+// 关闭客户端连接并清理资源
+// 参数：conn - 客户端连接
+void Worker::close_client(Connection& conn) {
+    LOG_INFO("Closed connection for fd: %d", conn.fd);
+    metrics.counters.add(SRV_CLOSES);
+    timers.cancel(conn.timer);
+    output_bytes -= conn.output.bytes();  // 未写出的回射随连接丢弃
+    conn.output.clear();
+    close_client_fd(conn.fd);  // 关闭客户端套接字（内核会自动将其从epoll中移除）
+    release_pipe(conn);
+    buffer_pool.release(conn.rx_buf);  // 归还缓冲区供后续连接复用
+    connections.release(&conn);
+}
+
+// 事件循环：处理本线程名下连接的IO事件
+void Worker::run() {
+    place_thread();  // 可选的CPU亲和性和NUMA放置
+
+    const int MAX_EVENTS = 1024;  // 一次最多处理的事件数
+    struct epoll_event events[MAX_EVENTS];  // 存储就绪事件的数组
+
+    const int MAX_WAIT_MS = 1000;  // 没有定时器时的最长等待时间（毫秒，用于周期统计日志）
+    auto now = std::chrono::steady_clock::now();
+    auto last_stats = now;
+
+    while (running) {
+        // 等待事件就绪（最多等到时间轮的下一个刻度，停止时由eventfd唤醒）
+        // 上一轮用完接受预算、就绪队列中还有可处理的连接，或轮询策略要求继续轮询时不等待
+        bool ready = !ready_queue.empty() && !output_full();
+        bool may_block = poll_may_block(now);
+        int wait_ms = accept_pending || ready || !may_block ? 0
+                    : timers.empty() ? MAX_WAIT_MS : timers.ms_until_next_tick(now);
+        int num_events = epoll_wait(epoll_fd, events, MAX_EVENTS, wait_ms);
+        if (num_events == -1) {  // 等待失败
+            if (errno == EINTR) continue;  // 被信号中断，继续循环
+            LOG_ERROR("Worker %d epoll wait failed", id);
+            break;
+        }
+        record_poll(wait_ms != 0, may_block, num_events > 0, now);
+
+        for (int i = 0; i < num_events; ++i) {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &wakeup_fd) {  // 有新连接投递到本线程（或排空请求）
+                adopt_pending();
+                if (enter_drain()) start_drain();
+            } else if (ptr == &listen_fd) {  // 本线程监听套接字上有新连接（处理完已有连接的事件后再接受）
+                accept_pending = true;
+            } else {  // 客户端套接字就绪：data.ptr即连接槽位，直接在本线程处理
+                Connection* conn = static_cast<Connection*>(ptr);
+                // 同一批事件中该连接可能已被关闭（槽位已释放），跳过；
+                // 已在就绪队列中的连接按队列顺序处理，新事件不让它插队
+                if (conn->in_use && !conn->queued) serve(*conn);
+            }
+        }
+
+        run_ready_queue();
+        if (accept_pending) {
+            handle_accept();
+        }
+
+        // 推进超时时间轮
+        now = std::chrono::steady_clock::now();
+        check_timeouts(now);
+        if (draining && connections.size() == 0) {  // 排空完成
+            LOG_INFO("Worker %d drained", id);
+            break;
+        }
+
+        // 周期性输出统计日志
+        if (config.stats_interval > 0 && now - last_stats >= std::chrono::seconds(config.stats_interval)) {
+            log_stats();
+            last_stats = now;
+        }
+    }
+}
+
+// 读取数据到接收缓冲区：一次read尽量读满剩余空间，可能包含多条流水线报文
+// 参数：conn - 客户端连接
+// 返回：DONE读到新数据，AGAIN暂无数据，CLOSED连接已关闭
+IoStatus Worker::read_input(Connection& conn) {
+    if (conn.rx_end >= static_cast<size_t>(RX_BUFFER_SIZE)) {
+        // 缓冲区已满仍要读取：read(…, 0)会返回0而被误判为断开，按内部错误关闭
+        LOG_ERROR_RL("Receive buffer full (fd: %d, state: %d)", conn.fd, static_cast<int>(conn.state));
+        close_client(conn);
+        return IoStatus::CLOSED;
+    }
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_read = read(conn.fd, conn.rx_buf + conn.rx_end, RX_BUFFER_SIZE - conn.rx_end);
+    metrics.stages[STAGE_READ].record_since(start);
+    if (bytes_read == -1) {  // 读取失败
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 暂时无数据：保留已读部分，等待下一次EPOLLIN
+            metrics.counters.add(SRV_READ_EAGAIN);
+            return IoStatus::AGAIN;
+        }
+        LOG_ERROR_RL("Read failed (fd: %d, errno: %d)", conn.fd, errno);
+        close_client(conn);
+        return IoStatus::CLOSED;
+    } else if (bytes_read == 0) {  // 客户端主动断开连接
+        LOG_INFO("Client disconnected (fd: %d) while %s", conn.fd,
+                 conn.state == ConnState::READ_HEADER ? "reading header" : "reading data");
+        close_client(conn);
+        return IoStatus::CLOSED;
+    }
+
+    // 缓冲区从空变为非空：未完成报文开始计时
+    if (conn.rx_start == conn.rx_end) {
+        conn.stage_start = std::chrono::steady_clock::now();
+    }
+    conn.rx_end += bytes_read;
+    conn.bytes_in += bytes_read;
+    metrics.counters.add(SRV_BYTES_IN, bytes_read);
+    ECHO_PROBE2(recv, conn.fd, bytes_read);
+    if (tracer.enabled()) rx_ns = trace_now_ns();
+    LOG_DEBUG("FD %d read %zd bytes (buffered: %zu)", conn.fd, bytes_read, conn.rx_end - conn.rx_start);
+    return IoStatus::DONE;
+}
+
+// 解析接收缓冲区中的所有完整报文，按顺序把报文头和数据加入回射列表
+// 作用：回射列表直接引用接收缓冲区中的报文，末尾不完整的报文留在原处，
+//       待回射全部写出后再由compact_input整理
+// 参数：conn - 客户端连接
+// 返回：DONE解析完成，CLOSED报文非法、连接已关闭
+IoStatus Worker::process_frames(Connection& conn) {
+    // 完整报文：报文头和数据各作为一段iovec加入回射列表（多条报文合并为一次writev）
+    auto start = std::chrono::steady_clock::now();
+    FrameInfo partial;
+    partial.frame_len = 0;
+    FrameStatus status = consume_frames(conn, config.max_message_size, [this, &conn](const char* frame, const FrameInfo& info) {
+        conn.output.push(frame, info.header_len);
+        conn.output.push(frame + info.header_len, info.data_len);
+        output_bytes += info.frame_len;
+        metrics.counters.add(SRV_FRAMES);
+        ECHO_PROBE3(frame, conn.fd, info.msg_id, info.frame_len);
+        begin_trace(conn, info.msg_id, conn.bytes_out + conn.output.bytes());
+    }, SIZE_MAX, &partial);
+    metrics.stages[STAGE_PARSE].record_since(start);
+    ECHO_PROBE2(queue, conn.fd, conn.output.bytes());
+    mark_trace(conn, TRACE_QUEUE);
+    if (is_frame_error(status)) {  // 报文非法（魔数、长度或报文头校验错误）
+        count_frame_error(status);
+        close_client(conn);
+        return IoStatus::CLOSED;
+    }
+
+    // 末尾是尚未收全的大报文：剩余数据不再读入用户态，改走splice零拷贝；
+    // 未开启零拷贝或管道创建失败时，放不进缓冲区整条缓存的报文改为流式回射
+    // （零拷贝失败时无论大小都改为流式回射，避免之后每一轮都重试创建管道）
+    if (config.zerocopy_threshold > 0 && partial.frame_len > 0 &&
+        partial.data_len >= static_cast<uint32_t>(config.zerocopy_threshold)) {
+        if (!start_splice(conn, partial)) start_stream(conn, partial);
+    } else if (partial.frame_len > 0 && partial.data_len > static_cast<uint32_t>(BUFFER_SIZE)) {
+        start_stream(conn, partial);
+    }
+    return IoStatus::DONE;
+}
+
+// 大报文切换到零拷贝回射
+// 作用：接收缓冲区中已有的报文头和部分数据加入回射列表（随前面的报文一起按序写出），
+//       剩余数据之后由splice_payload经管道直接从套接字转回套接字，不经过用户态
+// 说明：末尾未收全的报文之后不会再有已读入的数据，因此转发只涉及这一条报文
+// 参数：
+//   conn - 客户端连接
+//   info - 末尾未收全报文的元信息
+// 返回：true已切换，false管道创建失败（如fd耗尽），连接状态不变
+bool Worker::start_splice(Connection& conn, const FrameInfo& info) {
+    if (conn.pipe_fds[0] == -1 && pipe2(conn.pipe_fds, O_NONBLOCK | O_CLOEXEC) == -1) {
+        LOG_ERROR_RL("Create splice pipe failed (fd: %d, errno: %d)", conn.fd, errno);
+        conn.pipe_fds[0] = conn.pipe_fds[1] = -1;
+        return false;
+    }
+
+    size_t buffered = conn.rx_end - conn.rx_start;
+    conn.output.push(conn.rx_buf + conn.rx_start, buffered);
+    output_bytes += buffered;
+    conn.rx_start = conn.rx_end;
+    conn.payload_remaining = info.frame_len - buffered;
+    conn.pipe_bytes = 0;
+    conn.payload_msg_id = info.msg_id;
+    conn.state = ConnState::SPLICE_PAYLOAD;
+    conn.stage_start = std::chrono::steady_clock::now();
+    return true;
+}
+
+// 大报文切换到流式回射
+// 作用：接收缓冲区中已有的报文头和部分数据加入回射列表（随前面的报文一起按序写出），
+//       之后每次读到的数据都立即加入回射列表，不等待整条报文收全
+// 说明：回射列表引用接收缓冲区，写被阻塞且待写数据达到高水位时暂停读取（见handle_client_data），
+//       背压经TCP窗口传回客户端；
+//       每个连接只占用一个接收缓冲区，与报文大小无关
+// 参数：
+//   conn - 客户端连接
+//   info - 末尾未收全报文的元信息
+void Worker::start_stream(Connection& conn, const FrameInfo& info) {
+    size_t buffered = conn.rx_end - conn.rx_start;
+    conn.output.push(conn.rx_buf + conn.rx_start, buffered);
+    output_bytes += buffered;
+    conn.rx_start = conn.rx_end;
+    conn.payload_remaining = info.frame_len - buffered;
+    conn.payload_msg_id = info.msg_id;
+    conn.state = ConnState::STREAM_PAYLOAD;
+    conn.stage_start = std::chrono::steady_clock::now();
+}
+
+// 把接收缓冲区中属于流式报文的数据加入回射列表
+// 说明：一次read可能越过报文边界读到后续报文，越界部分留在缓冲区由process_frames处理
+// 参数：conn - 客户端连接
+// 返回：true报文仍未转发完，false已转发完
+bool Worker::stream_payload(Connection& conn) {
+    size_t chunk = conn.rx_end - conn.rx_start;
+    if (chunk > conn.payload_remaining) chunk = conn.payload_remaining;
+    conn.output.push(conn.rx_buf + conn.rx_start, chunk);
+    output_bytes += chunk;
+    conn.rx_start += chunk;
+    conn.payload_remaining -= chunk;
+    conn.stage_start = std::chrono::steady_clock::now();  // 有进展：重新开始数据超时计时
+    if (conn.payload_remaining > 0) {
+        return true;
+    }
+
+    // 整条报文转发完成：回到报文头阶段
+    ++conn.frames;
+    metrics.counters.add(SRV_FRAMES);
+    LOG_DEBUG("Processed msg_id: %u, fd: %d (streamed)", conn.payload_msg_id, conn.fd);
+    conn.state = ConnState::READ_HEADER;
+    return false;
+}
+
+// 推进零拷贝转发：套接字→管道→套接字交替进行，直到整条报文转发完或两端都被阻塞
+// 说明：读入管道的字节数限制为报文剩余长度，不会越过报文边界读到下一条报文；
+//       管道满或对端写缓冲区满时注册EPOLLOUT，由下一次可写事件继续
+// 参数：conn - 客户端连接
+// 返回：DONE报文转发完成，AGAIN读写被阻塞，CLOSED连接已关闭
+IoStatus Worker::splice_payload(Connection& conn) {
+    bool progress = true;
+    while (progress && (conn.payload_remaining > 0 || conn.pipe_bytes > 0)) {
+        progress = false;
+
+        // 套接字→管道
+        if (conn.payload_remaining > 0) {
+            ssize_t n = splice(conn.fd, nullptr, conn.pipe_fds[1], nullptr, conn.payload_remaining,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                conn.payload_remaining -= n;
+                conn.pipe_bytes += n;
+                conn.bytes_in += n;
+                metrics.counters.add(SRV_BYTES_IN, n);
+                conn.stage_start = std::chrono::steady_clock::now();
+                progress = true;
+            } else if (n == 0) {  // 客户端主动断开连接
+                LOG_INFO("Client disconnected (fd: %d) while reading data", conn.fd);
+                close_client(conn);
+                return IoStatus::CLOSED;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR_RL("Splice read failed (fd: %d, errno: %d)", conn.fd, errno);
+                close_client(conn);
+                return IoStatus::CLOSED;
+            }
+        }
+
+        // 管道→套接字
+        if (conn.pipe_bytes > 0) {
+            ssize_t n = splice(conn.pipe_fds[0], nullptr, conn.fd, nullptr, conn.pipe_bytes,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0) {
+                conn.pipe_bytes -= n;
+                conn.bytes_out += n;
+                metrics.counters.add(SRV_BYTES_OUT, n);
+                progress = true;
+            } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {  // 写缓冲区满：等待EPOLLOUT
+                metrics.counters.add(SRV_WRITE_EAGAIN);
+                update_write_interest(conn, true);
+            } else {
+                LOG_ERROR_RL("Splice write failed (fd: %d, errno: %d)", conn.fd, errno);
+                close_client(conn);
+                return IoStatus::CLOSED;
+            }
+        }
+    }
+    if (conn.payload_remaining > 0 || conn.pipe_bytes > 0) {
+        return IoStatus::AGAIN;
+    }
+
+    // 整条报文转发完成：回到报文头阶段
+    update_write_interest(conn, false);
+    ++conn.frames;
+    metrics.counters.add(SRV_FRAMES);
+    LOG_DEBUG("Processed msg_id: %u, fd: %d (spliced)", conn.payload_msg_id, conn.fd);
+    conn.state = ConnState::READ_HEADER;
+    conn.stage_start = std::chrono::steady_clock::now();
+    return IoStatus::DONE;
+}
+
+// 关闭连接的splice中转管道（管道中残留的数据随之丢弃）
+// 参数：conn - 客户端连接
+void Worker::release_pipe(Connection& conn) {
+    if (conn.pipe_fds[0] == -1) return;
+    close(conn.pipe_fds[0]);
+    close(conn.pipe_fds[1]);
+    conn.pipe_fds[0] = conn.pipe_fds[1] = -1;
+}
+
+// 整理接收缓冲区：把末尾不完整的报文移到开头，为下一次read腾出空间
+// 注：只能在回射列表全部写出后调用（回射列表引用着接收缓冲区）
+// 参数：conn - 客户端连接
+void Worker::compact_input(Connection& conn) {
+    size_t remaining = conn.rx_end - conn.rx_start;
+    if (remaining > 0 && conn.rx_start > 0) {
+        memmove(conn.rx_buf, conn.rx_buf + conn.rx_start, remaining);
+    }
+    conn.rx_start = 0;
+    conn.rx_end = remaining;
+}
+
+// 写出回射列表：报文头和数据（可能跨多条报文）通过一次writev写出
+// 作用：部分写出时列表从中断位置继续；写缓冲区满时注册EPOLLOUT并返回，
+//       待套接字可写时由下一次事件继续
+// 参数：conn - 客户端连接
+// 返回：DONE全部写出，AGAIN写被阻塞，CLOSED连接已关闭
+IoStatus Worker::flush_output(Connection& conn) {
+    while (!conn.output.empty()) {
+        ECHO_PROBE2(write_start, conn.fd, conn.output.bytes());
+        mark_trace(conn, TRACE_WRITE_START);
+        auto start = std::chrono::steady_clock::now();
+        ssize_t bytes_written = conn.output.write_to(conn.fd);
+        metrics.stages[STAGE_WRITE].record_since(start);
+        if (bytes_written == -1) {  // 写入失败
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {  // 缓冲区满：等待EPOLLOUT
+                metrics.counters.add(SRV_WRITE_EAGAIN);
+                update_write_interest(conn, true);
+                return IoStatus::AGAIN;
+            }
+            LOG_ERROR_RL("Write response failed (fd: %d, errno: %d)", conn.fd, errno);
+            close_client(conn);
+            return IoStatus::CLOSED;
+        }
+        conn.bytes_out += bytes_written;
+        output_bytes -= bytes_written;
+        metrics.counters.add(SRV_BYTES_OUT, bytes_written);
+        ECHO_PROBE2(write_done, conn.fd, conn.bytes_out);
+        finish_trace(conn);
+    }
+
+    // 全部写出，写不再被阻塞；回射列表不再引用接收缓冲区，可以整理
+    // 零拷贝转发中EPOLLOUT由splice_payload管理（转发完成时撤销），这里不改动，
+    // 避免每次可写事件都先撤销再重新注册，并把一次写阻塞计时拆成多段
+    if (conn.state != ConnState::SPLICE_PAYLOAD) update_write_interest(conn, false);
+    compact_input(conn);
+    return IoStatus::DONE;
+}
+
+// 更新连接在epoll中的关注事件：仅在写被阻塞时关注EPOLLOUT
+// 说明：同时统计写被阻塞的时长（从开始关注EPOLLOUT到待写数据全部写出）
+// 参数：
+//   conn - 客户端连接
+//   want_write - 是否关注可写事件
+void Worker::update_write_interest(Connection& conn, bool want_write) {
+    if (conn.want_write == want_write) return;  // 状态未变化，避免多余的epoll_ctl
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET | (want_write ? EPOLLOUT : 0);
+    event.data.ptr = &conn;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &event) == -1) {
+        LOG_ERROR_RL("Epoll mod client_fd failed (fd: %d)", conn.fd);
+        return;
+    }
+    conn.want_write = want_write;
+    if (want_write) {
+        conn.write_start = std::chrono::steady_clock::now();
+    } else {
+        metrics.stages[STAGE_WRITE_BLOCKED].record_since(conn.write_start);
+    }
+}
+
+// 处理连接的一轮：用完预算或被暂停读取时放入就绪队列（超时状态不变，下一轮处理后再设置）
+// 参数：conn - 客户端连接
+void Worker::serve(Connection& conn) {
+    if (handle_client_data(conn)) {
+        conn.queued = true;
+        ready_queue.push_back(&conn);
+    } else if (conn.in_use) {
+        schedule_timeout(conn, conn.want_write);
+    }
+}
+
+// 按轮转顺序处理就绪队列
+// 说明：只处理进入本函数时已在队列中的连接，本轮再次入队的排在其后，留到下一次事件循环，
+//       其间先处理新的就绪事件、接受新连接和超时；待回射字节数达到上限时整个队列等待
+void Worker::run_ready_queue() {
+    for (size_t n = ready_queue.size(); n > 0 && !output_full(); --n) {
+        Connection* conn = ready_queue.front();
+        ready_queue.pop_front();
+        conn->queued = false;
+        if (conn->in_use) serve(*conn);
+    }
+}
+
+// 处理客户端数据：读取、解析所有完整报文并批量回射，直到数据不足、写被阻塞或用完本轮预算
+// 说明：不在线程内等待数据，末尾不完整的报文和未写完的回射都保存在连接状态中，
+//       由下一次EPOLLIN/EPOLLOUT事件继续处理。回射列表直接引用接收缓冲区，
+//       全部写出后才整理接收缓冲区；写被阻塞时继续读入缓冲区剩余空间，
+//       直到待写数据达到高水位或缓冲区写满才暂停读取（每个连接的待写数据因此有界），
+//       之后由EPOLLOUT事件继续。
+//       预算在每次读取（或零拷贝转发）之后检查，超出部分不超过一次读取的数据量；
+//       用完预算时先写出已切分的回射再返回，写被阻塞时同样由EPOLLOUT继续。
+//       本线程待回射字节数达到上限时同样在读取前返回：此时该连接的回射已全部写出
+//       （否则写被阻塞，由EPOLLOUT继续），进入就绪队列不会让其他连接的回射无法写出
+// 参数：conn - 客户端连接（由epoll事件的data.ptr直接给出，无需查表）
+// 返回：true用完预算或暂停读取（调用方应放入就绪队列），false等待下一次事件或连接已关闭
+bool Worker::handle_client_data(Connection& conn) {
+    const uint64_t byte_limit = config.event_budget > 0
+        ? conn.bytes_in + static_cast<uint64_t>(config.event_budget) * conn.weight : UINT64_MAX;
+    const uint64_t frame_limit = config.event_frame_budget > 0
+        ? conn.frames + static_cast<uint64_t>(config.event_frame_budget) * conn.weight : UINT64_MAX;
+    bool write_blocked = false;  // 本次事件中写已返回EAGAIN：等待EPOLLOUT，不再重复尝试
+    while (true) {
+        // 先写出上一批未写完的回射
+        if (!write_blocked) {
+            IoStatus status = flush_output(conn);
+            if (status == IoStatus::CLOSED) return false;
+            write_blocked = (status == IoStatus::AGAIN);
+        }
+        if (write_blocked && !can_read_while_blocked(conn)) return false;
+        if (conn.bytes_in >= byte_limit || conn.frames >= frame_limit) {
+            if (write_blocked) return false;
+            metrics.counters.add(SRV_BUDGET_YIELDS);
+            return true;
+        }
+        if (output_full() && conn.state != ConnState::SPLICE_PAYLOAD) {
+            if (write_blocked) return false;
+            metrics.counters.add(SRV_READ_THROTTLED);
+            return true;
+        }
+
+        // 大报文零拷贝转发中：转发完之前不读入新数据
+        if (conn.state == ConnState::SPLICE_PAYLOAD) {
+            if (splice_payload(conn) != IoStatus::DONE) return false;
+            continue;
+        }
+
+        // 读取新数据，然后解析其中所有完整报文并一次性回射；
+        // 流式回射中的大报文先转发属于它的数据，转发完后缓冲区剩余部分按普通报文解析
+        if (read_input(conn) != IoStatus::DONE) return false;
+        if (conn.state == ConnState::STREAM_PAYLOAD && stream_payload(conn)) continue;
+        if (process_frames(conn) != IoStatus::DONE) return false;
+    }
+}
+
+// 写被阻塞时是否继续读取
+// 说明：零拷贝转发要求回射列表为空；其余情况下待写数据低于高水位且缓冲区还有空间时继续读取
+// 参数：conn - 客户端连接
+// 返回：true继续读取，false暂停读取直到写出
+bool Worker::can_read_while_blocked(const Connection& conn) const {
+    return conn.state != ConnState::SPLICE_PAYLOAD &&
+           conn.output.bytes() < static_cast<size_t>(config.output_high_water) &&
+           conn.rx_end < static_cast<size_t>(RX_BUFFER_SIZE);
+}
+
+// 处理到期的超时定时器：关闭报文头读取超过3秒、数据读取超过5秒仍未完成、
+// 空闲超过空闲超时或回射被阻塞超过写超时的连接
+// 说明：由事件循环每次唤醒后调用，未跨过时间轮刻度时只有一次比较；
+//       只访问到期的定时器，与连接总数无关
+// 参数：now - 当前时间
+void Worker::check_timeouts(std::chrono::steady_clock::time_point now) {
+    timers.advance(now, [&](TimerNode& node) {
+        Connection& conn = *static_cast<Connection*>(node.owner);
+        if (timeout_expired(conn, conn.want_write, now)) {
+            close_client(conn);
+        }
+    });
+}
+
+// 输出本线程的统计日志
+// 作用：缓冲池命中/未命中次数和容量用于评估预分配数量是否合适
+void Worker::log_stats() {
+    BufferPoolStats s = buffer_pool.stats();
+    LOG_INFO("Worker %d buffer pool: hits=%llu, misses=%llu, in_use=%llu, capacity=%llu, slabs=%llu, connections=%zu",
+             id, static_cast<unsigned long long>(s.hits), static_cast<unsigned long long>(s.misses),
+             static_cast<unsigned long long>(s.in_use), static_cast<unsigned long long>(s.capacity),
+             static_cast<unsigned long long>(s.slabs), connections.size());
+    LOG_INFO("Worker %d polls: blocking=%llu, spin=%llu, empty_spin=%llu", id,
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_BLOCKING)),
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_SPINS)),
+             static_cast<unsigned long long>(metrics.counters.get(SRV_POLL_EMPTY_SPINS)));
+}
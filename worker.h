@@ -0,0 +1,151 @@
+#ifndef WORKER_H
+#define WORKER_H
+
+#include "worker_base.h"          // 包含工作线程基类
+#include "connection.h"           // 包含连接状态结构
+#include "connection_table.h"     // 包含按fd索引的连接表
+#include "protocol.h"             // 包含报文元信息
+#include <deque>                  // 用于就绪队列
+
+// 单步IO结果
+enum class IoStatus
+{
+    DONE,    // 当前阶段完成，可以进入下一阶段
+    AGAIN,   // 数据不足或写被阻塞，等待下一次事件
+    CLOSED   // 连接已关闭（连接状态已释放，不可再访问）
+};
+
+// epoll工作线程：拥有独立的epoll实例（即一个reactor），负责其名下所有连接的读写
+// 说明：线程管理、连接投递和缓冲池见WorkerBase。
+//       每个连接每轮最多处理event_budget字节/event_frame_budget条报文（乘以连接权重），
+//       用完预算的连接进入就绪队列，与新的就绪事件交替、按轮转顺序继续处理，
+//       突发大量流水线报文的连接不会让同一线程上的其他连接长时间等待。
+//       本线程待回射的字节数达到上限（max_inflight_bytes）时不再读取任何连接，
+//       需要读取的连接在就绪队列中等待，回射写出、回落到上限以下后再继续
+class Worker : public WorkerBase
+{
+private:
+    int epoll_fd;                   // 本线程的epoll句柄
+    bool accept_pending;            // 监听套接字上可能还有未接受的连接（有新连接事件或上一轮用完预算）
+
+    // 连接表：按fd直接索引的连接槽位（含缓冲区指针、解析状态、读写游标和统计）
+    // 注：仅由本工作线程访问，无需加锁；epoll事件的data.ptr直接指向槽位，热路径不查表
+    ConnectionTable<> connections;
+
+    // 就绪队列：用完一轮预算、仍可能有数据可读的连接（边缘触发不会再次通知），按入队顺序轮转
+    // 注：槽位关闭后可能仍留在队列中，出队时按in_use跳过
+    std::deque<Connection*> ready_queue;
+
+    // 本线程所有连接待回射列表中尚未写出的字节数（回射背压的队列深度），及其上限（0表示不限制）
+    size_t output_bytes;
+    size_t output_limit;
+
+    // 待回射字节数是否达到上限（此时暂停读取）
+    bool output_full() const { return output_limit > 0 && output_bytes >= output_limit; }
+
+    // 事件循环：等待并处理本线程名下连接的IO事件
+    void run() override;
+
+    // 接管接收线程投递的新连接
+    void adopt_pending();
+
+    // 开始排空：停止接受新连接，按排空规则重新设置所有连接的超时
+    void start_drain();
+
+    // 接受本线程监听套接字上的新连接（仅多reactor模式，每轮最多accept_budget个）
+    void handle_accept();
+
+    // 为新连接创建连接状态并注册到本线程的epoll
+    // 参数：client_fd - 已设置为非阻塞的客户端文件描述符
+    void register_connection(int client_fd);
+
+    // 处理客户端数据：读取并批量回射所有完整报文，数据不足或用完本轮预算时返回
+    // 参数：conn - 客户端连接
+    // 返回：true用完预算（连接仍可能有数据，调用方应放入就绪队列），false等待下一次事件或连接已关闭
+    bool handle_client_data(Connection& conn);
+
+    // 处理连接的一轮：handle_client_data，用完预算时放入就绪队列，否则按状态设置超时
+    // 参数：conn - 客户端连接
+    void serve(Connection& conn);
+
+    // 按轮转顺序处理就绪队列中的连接（每个连接一轮，本轮再次用完预算的连接排到队尾）
+    void run_ready_queue();
+
+    // 按连接所属的监听套接字（TCP或Unix域）取调度权重
+    // 参数：client_fd - 客户端文件描述符
+    uint32_t connection_weight(int client_fd) const;
+
+    // 写被阻塞时是否继续读取（待写数据低于高水位且接收缓冲区仍有空间）
+    // 参数：conn - 客户端连接
+    bool can_read_while_blocked(const Connection& conn) const;
+
+    // 读取数据到接收缓冲区（一次read可能包含多条报文）
+    IoStatus read_input(Connection& conn);
+
+    // 解析接收缓冲区中的所有完整报文，按顺序加入回射列表
+    IoStatus process_frames(Connection& conn);
+
+    // 整理接收缓冲区：把末尾不完整的报文移到开头
+    void compact_input(Connection& conn);
+
+    // 用writev写出回射列表（可续写），写被阻塞时注册EPOLLOUT
+    IoStatus flush_output(Connection& conn);
+
+    // 大报文切换到零拷贝回射：已读入的部分照常回射，剩余数据经管道splice转发
+    // 参数：
+    //   conn - 客户端连接
+    //   info - 末尾未收全报文的元信息
+    // 返回：true已切换，false管道创建失败（调用方改走流式回射）
+    bool start_splice(Connection& conn, const FrameInfo& info);
+
+    // 推进零拷贝转发：套接字→管道→套接字，直到整条报文转发完或读写被阻塞
+    IoStatus splice_payload(Connection& conn);
+
+    // 大报文切换到流式回射：已读入的部分立即回射，剩余数据之后每读到一段就回射一段
+    // 参数：
+    //   conn - 客户端连接
+    //   info - 末尾未收全报文的元信息
+    void start_stream(Connection& conn, const FrameInfo& info);
+
+    // 把接收缓冲区中属于流式报文的数据加入回射列表
+    // 返回：true报文仍未转发完，false已转发完（缓冲区中其余数据属于后续报文）
+    bool stream_payload(Connection& conn);
+
+    // 关闭连接的splice中转管道（若已创建）
+    void release_pipe(Connection& conn);
+
+    // 更新连接关注的epoll事件（是否关注EPOLLOUT）
+    void update_write_interest(Connection& conn, bool want_write);
+
+    // 推进超时时间轮，关闭读取、空闲或写阻塞超时的连接
+    // 参数：now - 当前时间
+    void check_timeouts(std::chrono::steady_clock::time_point now);
+
+    // 输出本线程的统计日志（缓冲池命中率等）
+    void log_stats();
+
+    // 关闭客户端连接并清理相关资源（归还缓冲区、释放连接槽位）
+    // 参数：conn - 客户端连接
+    void close_client(Connection& conn);
+
+public:
+    // 构造函数：初始化工作线程编号和配置
+    // 参数：
+    //   id - 工作线程编号
+    //   cfg - 服务端配置
+    Worker(int id, const ServerConfig& cfg);
+
+    // 析构函数：停止工作线程并释放资源
+    ~Worker() override;
+
+    // 初始化epoll实例和唤醒用的eventfd
+    // 参数：listen_fd - 本线程独占的非阻塞监听套接字（多reactor模式），-1表示由
+    //                  接收线程通过add_connections投递连接；传入后所有权归本对象
+    // 返回：true成功，false失败
+    bool init(int listen_fd) override;
+
+    // 后端名称
+    const char* backend_name() const override { return "epoll"; }
+};
+
+#endif // WORKER_H
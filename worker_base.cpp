@@ -0,0 +1,368 @@
+#include "worker_base.h"
+#include "socket_utils.h"     // 用于套接字选项
+#include <sys/eventfd.h>      // 用于eventfd（跨线程唤醒）
+#include <pthread.h>          // 用于设置线程CPU亲和性
+#include <unistd.h>           // 用于read/write/close等系统调用
+#include <errno.h>            // 用于错误码（errno）
+#include <algorithm>          // 用于std::max
+
+namespace {
+
+const size_t TIMER_SLOTS = 1024;      // 时间槽数（一圈约102秒，覆盖默认的各项超时）
+const std::chrono::seconds HEADER_TIMEOUT(3);  // 报文头读取超时时间（3秒）
+const std::chrono::seconds DATA_TIMEOUT(5);    // 数据读取超时时间（5秒）
+
+} // namespace
+
+const int WorkerBase::TIMER_RESOLUTION_MS;
+
+// 构造函数：初始化工作线程状态
+// 参数：
+//   id - 工作线程编号
+//   cfg - 服务端配置
+WorkerBase::WorkerBase(int id, const ServerConfig& cfg)
+    : id(id), config(cfg), wakeup_fd(-1), listen_fd(-1), cpu(-1), numa_node(-1), topology(nullptr), running(false),
+      drain_requested(false), buffer_pool(RX_BUFFER_SIZE, cfg.pool_slab_buffers), admission(nullptr),
+      tracer(cfg.trace_sample, cfg.trace_capacity > 0 ? static_cast<size_t>(cfg.trace_capacity) : 0), rx_ns(0),
+      timers(std::chrono::milliseconds(TIMER_RESOLUTION_MS), TIMER_SLOTS), draining(false) {}
+
+// 析构函数：停止工作线程并释放公共资源
+WorkerBase::~WorkerBase() {
+    stop();
+    // 关闭尚未接管的连接
+    for (int fd : pending_fds) {
+        close_client_fd(fd);
+    }
+    pending_fds.clear();
+    if (listen_fd != -1) close(listen_fd);
+    if (wakeup_fd != -1) close(wakeup_fd);
+}
+
+// 创建唤醒用的eventfd
+// 返回：true成功，false失败
+bool WorkerBase::create_wakeup_fd() {
+    wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd == -1) {
+        LOG_ERROR("Worker %d eventfd create failed (errno: %d)", id, errno);
+        return false;
+    }
+    return true;
+}
+
+// 启动工作线程
+// 参数：cpu - 绑定的CPU编号，-1表示不绑定
+void WorkerBase::start(int cpu) {
+    this->cpu = cpu;
+    running = true;
+    thread = std::thread(&WorkerBase::run, this);
+}
+
+// 停止工作线程并等待其退出
+void WorkerBase::stop() {
+    if (!running.exchange(false)) return;  // 未启动或已停止
+    // 写eventfd唤醒阻塞在等待中的线程，使其检查running标志
+    uint64_t one = 1;
+    ssize_t ret = write(wakeup_fd, &one, sizeof(one));
+    (void)ret;
+    join();
+}
+
+// 等待工作线程退出
+void WorkerBase::join() {
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+// 请求排空：设置标志后写eventfd唤醒工作线程，由其在下一次唤醒时进入排空
+void WorkerBase::drain() {
+    drain_requested = true;
+    uint64_t one = 1;
+    ssize_t ret = write(wakeup_fd, &one, sizeof(one));
+    (void)ret;
+}
+
+// 响应排空请求
+// 返回：true本次进入排空，false未请求或已在排空中
+bool WorkerBase::enter_drain() {
+    if (draining || !drain_requested) return false;
+    draining = true;
+    drain_start = std::chrono::steady_clock::now();
+    drain_deadline = drain_start + std::chrono::seconds(config.drain_timeout);
+    LOG_INFO("Worker %d draining (timeout: %ds)", id, config.drain_timeout);
+    return true;
+}
+
+// 绑定CPU（便于与网卡RSS队列对齐）；失败只记录日志，不影响运行
+void WorkerBase::place_thread() {
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (ret != 0) {
+            LOG_ERROR("Worker %d set affinity to CPU %d failed (errno: %d)", id, cpu, ret);
+        } else {
+            LOG_INFO("Worker %d pinned to CPU %d", id, cpu);
+        }
+    } else if (numa_node >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int c : topology->cpus_of(numa_node)) {
+            if (c < CPU_SETSIZE) CPU_SET(c, &cpuset);
+        }
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (ret != 0) {
+            LOG_ERROR("Worker %d set affinity to NUMA node %d failed (errno: %d)", id, numa_node, ret);
+        } else {
+            LOG_INFO("Worker %d pinned to NUMA node %d (%zu CPUs)", id, numa_node, topology->cpus_of(numa_node).size());
+        }
+    }
+    if (numa_node >= 0 && !numa_prefer_node(numa_node)) {
+        LOG_WARN("Worker %d set memory policy to NUMA node %d failed (errno: %d)", id, numa_node, errno);
+    }
+    buffer_pool.reserve(config.pool_prealloc);
+}
+
+// 设置本线程所属的NUMA节点
+// 参数：
+//   node - 节点编号
+//   topology - NUMA拓扑
+void WorkerBase::set_numa_node(int node, const NumaTopology* topology) {
+    numa_node = node;
+    this->topology = topology;
+    metrics.numa_node = node;
+}
+
+// 统计新连接的NUMA就近性
+// 参数：client_fd - 客户端文件描述符
+void WorkerBase::note_locality(int client_fd) {
+    if (numa_node < 0) return;
+    int node = topology->node_of_cpu(incoming_cpu(client_fd));
+    if (node < 0) return;  // Unix域连接或内核尚未记录接收CPU
+    metrics.counters.add(node == numa_node ? SRV_NUMA_LOCAL : SRV_NUMA_REMOTE);
+}
+
+// 批量投递新连接给本工作线程（由接收线程调用）
+// 作用：只在投递队列上加锁，真正的缓冲区分配和事件注册由工作线程自己完成
+// 参数：client_fds - 已设置为非阻塞的客户端文件描述符
+void WorkerBase::add_connections(const std::vector<int>& client_fds) {
+    if (client_fds.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending_fds.insert(pending_fds.end(), client_fds.begin(), client_fds.end());
+    }
+    // 唤醒工作线程
+    uint64_t one = 1;
+    if (write(wakeup_fd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        LOG_ERROR("Worker %d wakeup failed (errno: %d)", id, errno);
+    }
+}
+
+// 清空eventfd计数并取出全部待接管的连接
+// 返回：待接管的客户端fd列表
+std::vector<int> WorkerBase::take_pending() {
+    uint64_t count;
+    ssize_t ret = read(wakeup_fd, &count, sizeof(count));
+    (void)ret;
+
+    // 一次性取出全部待接管连接，缩短持锁时间
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        fds.swap(pending_fds);
+    }
+    return fds;
+}
+
+// 按轮询策略判断本轮等待能否阻塞
+// 参数：now - 当前时间
+// 返回：true可以阻塞，false只轮询
+bool WorkerBase::poll_may_block(std::chrono::steady_clock::time_point now) const {
+    switch (config.poll_mode) {
+    case PollMode::SPIN:
+        return now - last_event >= std::chrono::microseconds(config.poll_spin_us);
+    case PollMode::BUSY:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// 记录一次等待的结果
+// 说明：只有轮询策略选择不阻塞时才计为轮询；因积压工作（待接管连接、就绪队列等）
+//       或定时器到期而超时为0的等待两者都不计，避免阻塞策略下也显示为空转
+// 参数：
+//   blocked - 本次等待是否允许阻塞（超时不为0）
+//   policy_may_block - 本轮poll_may_block的结果
+//   had_events - 是否等到了事件
+//   now - 等待前的时间
+void WorkerBase::record_poll(bool blocked, bool policy_may_block, bool had_events,
+                             std::chrono::steady_clock::time_point now) {
+    if (had_events) last_event = now;
+    if (blocked) {
+        metrics.counters.add(SRV_POLL_BLOCKING);
+    } else if (!policy_may_block) {
+        metrics.counters.add(SRV_POLL_SPINS);
+        if (!had_events) metrics.counters.add(SRV_POLL_EMPTY_SPINS);
+    }
+}
+
+// 准入检查：超出上限时立即拒绝（RST）
+// 参数：
+//   client_fd - 客户端文件描述符
+//   peer - 客户端地址（nullptr表示未知）
+// 返回：true接纳，false已拒绝
+bool WorkerBase::admit_connection(int client_fd, const struct sockaddr_in* peer) {
+    if (admission == nullptr || admission->admit(client_fd, peer)) return true;
+    LOG_WARN_RL("Worker %d shed connection (fd: %d, admitted: %d)", id, client_fd, admission->active_connections());
+    AdmissionControl::reject(client_fd);
+    return false;
+}
+
+// 释放连接的准入登记并关闭fd
+// 参数：client_fd - 客户端文件描述符
+void WorkerBase::close_client_fd(int client_fd) {
+    if (admission != nullptr) admission->release(client_fd);
+    close(client_fd);
+}
+
+// 设置已接受连接的套接字选项
+// 参数：client_fd - 客户端文件描述符
+// 返回：true成功，false失败
+bool WorkerBase::prepare_client_socket(int client_fd) {
+    return apply_client_socket_options(client_fd, config) == 0;
+}
+
+// 按报文非法的原因计数
+// 参数：status - 报文解析的错误结果
+void WorkerBase::count_frame_error(FrameStatus status) {
+    switch (status) {
+    case FrameStatus::BAD_MAGIC:
+        metrics.counters.add(SRV_BAD_MAGIC);
+        break;
+    case FrameStatus::BAD_CHECKSUM:
+        metrics.counters.add(SRV_BAD_CHECKSUM);
+        break;
+    case FrameStatus::BAD_HEADER:
+        metrics.counters.add(SRV_BAD_HEADER);
+        break;
+    default:
+        metrics.counters.add(SRV_BAD_LENGTH);
+        break;
+    }
+}
+
+// 计算连接当前最近的超时截止时间
+// 说明：排空期间没有未完成报文、也没有待写回射的连接以开始排空的时间为截止时间（下一个刻度关闭）
+// 参数：
+//   conn - 客户端连接
+//   write_blocked - 回射是否被阻塞
+//   deadline - 输出参数，截止时间
+// 返回：超时类型
+WorkerBase::TimeoutKind WorkerBase::next_deadline(const Connection& conn, bool write_blocked,
+                                                  std::chrono::steady_clock::time_point& deadline) const {
+    TimeoutKind kind = stage_deadline(conn, write_blocked, deadline);
+    if (!draining) return kind;
+    if (!write_blocked && conn.state == ConnState::READ_HEADER && conn.rx_end == conn.rx_start) {
+        deadline = drain_start;
+        return TimeoutKind::DRAIN;
+    }
+    if (kind == TimeoutKind::NONE || drain_deadline < deadline) {
+        deadline = drain_deadline;
+        return TimeoutKind::DRAIN;
+    }
+    return kind;
+}
+
+// 按连接所处阶段计算超时截止时间
+// 说明：写被阻塞期间读取可能被暂停，只计写超时；零拷贝/流式转发从上次读到数据起计时；
+//       没有未完成报文的连接按空闲超时计时（从上一条报文完成或写阻塞解除起）
+// 参数：
+//   conn - 客户端连接
+//   write_blocked - 回射是否被阻塞
+//   deadline - 输出参数，截止时间
+// 返回：超时类型
+WorkerBase::TimeoutKind WorkerBase::stage_deadline(const Connection& conn, bool write_blocked,
+                                                   std::chrono::steady_clock::time_point& deadline) const {
+    if (write_blocked) {
+        if (config.write_timeout <= 0) return TimeoutKind::NONE;
+        deadline = conn.write_start + std::chrono::seconds(config.write_timeout);
+        return TimeoutKind::WRITE;
+    }
+    if (conn.state == ConnState::SPLICE_PAYLOAD || conn.state == ConnState::STREAM_PAYLOAD) {
+        if (conn.payload_remaining == 0) return TimeoutKind::NONE;
+        deadline = conn.stage_start + DATA_TIMEOUT;
+        return TimeoutKind::DATA;
+    }
+    if (conn.rx_end == conn.rx_start) {  // 没有未完成的报文
+        if (config.idle_timeout <= 0) return TimeoutKind::NONE;
+        deadline = std::max(conn.stage_start, conn.write_start) + std::chrono::seconds(config.idle_timeout);
+        return TimeoutKind::IDLE;
+    }
+    if (conn.state == ConnState::READ_HEADER) {
+        deadline = conn.stage_start + HEADER_TIMEOUT;
+        return TimeoutKind::HEADER;
+    }
+    deadline = conn.stage_start + DATA_TIMEOUT;
+    return TimeoutKind::DATA;
+}
+
+// 按连接当前状态设置其超时定时器
+// 说明：截止时间推后时时间轮不移动节点（惰性推迟），到期时再由timeout_expired重新计算
+// 参数：
+//   conn - 客户端连接
+//   write_blocked - 回射是否被阻塞
+void WorkerBase::schedule_timeout(Connection& conn, bool write_blocked) {
+    std::chrono::steady_clock::time_point deadline;
+    if (next_deadline(conn, write_blocked, deadline) == TimeoutKind::NONE) {
+        timers.cancel(conn.timer);
+    } else {
+        timers.arm(conn.timer, deadline);
+    }
+}
+
+// 处理到期的连接定时器
+// 参数：
+//   conn - 客户端连接
+//   write_blocked - 回射是否被阻塞
+//   now - 当前时间
+// 返回：true已超时，false未超时（需要时已重新设置定时器）
+bool WorkerBase::timeout_expired(Connection& conn, bool write_blocked, std::chrono::steady_clock::time_point now) {
+    std::chrono::steady_clock::time_point deadline;
+    TimeoutKind kind = next_deadline(conn, write_blocked, deadline);
+    if (kind == TimeoutKind::NONE) return false;
+    if (deadline > now) {  // 期间有新的进展：按新的截止时间重新计时
+        timers.arm(conn.timer, deadline);
+        return false;
+    }
+
+    switch (kind) {
+    case TimeoutKind::IDLE:
+        LOG_INFO("Idle timeout (fd: %d)", conn.fd);
+        metrics.counters.add(SRV_IDLE_TIMEOUTS);
+        break;
+    case TimeoutKind::HEADER:
+        LOG_ERROR_RL("Header read timeout (fd: %d)", conn.fd);
+        metrics.counters.add(SRV_HEADER_TIMEOUTS);
+        break;
+    case TimeoutKind::DATA:
+        LOG_ERROR_RL("Data read timeout (fd: %d)", conn.fd);
+        metrics.counters.add(SRV_DATA_TIMEOUTS);
+        break;
+    case TimeoutKind::DRAIN:
+        if (deadline == drain_start) {
+            LOG_INFO("Drained connection (fd: %d)", conn.fd);
+            metrics.counters.add(SRV_DRAINED);
+        } else {
+            LOG_ERROR_RL("Drain timeout, closing connection with unfinished frames (fd: %d)", conn.fd);
+            metrics.counters.add(SRV_DRAIN_TIMEOUTS);
+        }
+        break;
+    default:
+        LOG_ERROR_RL("Write stalled for over %ds, dropping slow consumer (fd: %d)", config.write_timeout, conn.fd);
+        metrics.counters.add(SRV_WRITE_TIMEOUTS);
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,267 @@
+#ifndef WORKER_BASE_H
+#define WORKER_BASE_H
+
+#include "common.h"               // 包含公共常量、结构体和日志函数
+#include "buffer_pool.h"          // 包含固定大小缓冲池
+#include "connection.h"           // 包含连接状态结构
+#include "server_metrics.h"       // 包含服务端计数器和阶段耗时直方图
+#include "timer_wheel.h"          // 包含连接超时使用的时间轮
+#include "protocol.h"             // 包含报文解析结果
+#include "admission.h"            // 包含连接准入控制
+#include "numa.h"                 // 包含NUMA拓扑
+#include "trace.h"                // 包含抽样报文追踪
+#include <chrono>                 // 用于超时判断
+#include <vector>                 // 用于暂存待接管的客户端fd
+#include <mutex>                  // 用于保护待接管队列
+#include <thread>                 // 用于工作线程
+#include <atomic>                 // 用于运行状态标志
+
+// 工作线程基类：各IO后端（epoll、io_uring）共用的线程管理、连接投递和缓冲池
+// 说明：连接在整个生命周期内固定归属一个工作线程，因此连接状态只被该线程访问，
+//       热路径上无需任何锁。多reactor模式下每个工作线程还持有自己的
+//       SO_REUSEPORT监听套接字，直接在本线程accept新连接。
+//       派生类实现init()和run()，并在析构函数开头调用stop()，
+//       保证事件循环退出后才销毁派生类成员
+class WorkerBase
+{
+protected:
+    int id;                         // 工作线程编号（用于日志区分）
+    ServerConfig config;            // 服务端配置（套接字选项等）
+    int wakeup_fd;                  // eventfd：接收线程投递新连接或停止时唤醒本线程
+    int listen_fd;                  // 本线程独占的监听套接字（仅多reactor模式，否则为-1）
+    int cpu;                        // 绑定的CPU编号（-1表示不绑定）
+    int numa_node;                  // 所属NUMA节点（-1表示不按节点放置）
+    const NumaTopology* topology;   // NUMA拓扑（由服务器持有，numa_node为-1时不使用）
+    std::atomic<bool> running;      // 运行状态标志（控制事件循环）
+    std::atomic<bool> drain_requested;  // 主线程请求排空（由drain设置）
+    std::thread thread;             // 工作线程对象
+
+    // 待接管的客户端fd队列：由接收线程写入，工作线程取出（仅此处需要加锁）
+    std::vector<int> pending_fds;
+    std::mutex pending_mutex;       // 保护pending_fds的互斥锁
+
+    // 接收缓冲区池：连接建立时取出，关闭时归还，跨连接复用（仅本线程访问）
+    BufferPool buffer_pool;
+
+    // 连接准入控制（由服务器持有，各线程共享；nullptr表示不限制）
+    AdmissionControl* admission;
+
+    // 本线程的计数器和阶段耗时（只由本线程写入，管理线程读取）
+    ServerMetrics metrics;
+
+    // 抽样报文追踪（只由本线程写入，管理线程和接收线程导出）
+    FrameTracer tracer;
+    uint64_t rx_ns;                 // 最近一次读到数据的时间（仅开启追踪时更新，作为该批报文的TRACE_RECV）
+
+    // 连接超时时间轮：每个连接一个定时器，由事件循环按刻度推进（仅本线程访问）
+    static const int TIMER_RESOLUTION_MS = 100;  // 时间轮刻度（超时最多推迟一个刻度）
+    TimerWheel timers;
+
+    // 排空状态（仅本线程访问）：排空期间不再接受新连接，连接在报文边界处关闭，
+    // 到排空截止时间仍未完成的连接强制关闭
+    bool draining;
+    std::chrono::steady_clock::time_point drain_start;     // 开始排空的时间
+    std::chrono::steady_clock::time_point drain_deadline;  // 排空截止时间
+
+    // 轮询策略状态（仅本线程访问）：最近一次等到事件的时间（SPIN策略从该时刻起继续轮询poll_spin_us）
+    std::chrono::steady_clock::time_point last_event;
+
+    // 事件循环：由派生类实现
+    virtual void run() = 0;
+
+    // 创建唤醒用的非阻塞eventfd
+    // 返回：true成功，false失败
+    bool create_wakeup_fd();
+
+    // 放置当前线程（在run()开头调用）：按start()传入的CPU编号绑定，未指定CPU但属于某个NUMA节点时
+    // 绑定到该节点的全部CPU；属于NUMA节点时内存优先从该节点分配，
+    // 之后再预分配缓冲池，缓冲区首次访问发生在本线程、落在本节点
+    void place_thread();
+
+    // 抽样追踪刚切分出的报文（未开启追踪或该连接已有正在追踪的报文时无操作）
+    // 参数：
+    //   conn - 客户端连接
+    //   msg_id - 报文ID
+    //   end - 该报文回射的结束位置（按conn.bytes_out计）
+    void begin_trace(Connection& conn, uint32_t msg_id, uint64_t end) {
+        if (!tracer.enabled() || conn.tracing || !tracer.sample()) return;
+        conn.tracing = true;
+        conn.trace_end = end;
+        conn.trace = FrameTrace();
+        conn.trace.msg_id = msg_id;
+        conn.trace.fd = conn.fd;
+        conn.trace.ns[TRACE_RECV] = rx_ns;
+        conn.trace.ns[TRACE_PARSE] = trace_now_ns();
+    }
+
+    // 标记正在追踪的报文到达某个时间点（只记录第一次到达）
+    // 参数：
+    //   conn - 客户端连接
+    //   point - 时间点（TRACE_QUEUE或TRACE_WRITE_START）
+    void mark_trace(Connection& conn, TracePoint point) {
+        if (conn.tracing && conn.trace.ns[point] == 0) conn.trace.ns[point] = trace_now_ns();
+    }
+
+    // 回射写出后检查正在追踪的报文是否已全部写出，是则记录到环形缓冲区
+    // 参数：conn - 客户端连接
+    void finish_trace(Connection& conn) {
+        if (!conn.tracing || conn.bytes_out < conn.trace_end) return;
+        conn.trace.ns[TRACE_WRITE_DONE] = trace_now_ns();
+        if (conn.trace.ns[TRACE_WRITE_START] == 0) conn.trace.ns[TRACE_WRITE_START] = conn.trace.ns[TRACE_WRITE_DONE];
+        tracer.record(conn.trace);
+        conn.tracing = false;
+    }
+
+    // 统计新连接的NUMA就近性：接收该连接数据的CPU是否位于本线程的节点（未按节点放置时无操作）
+    // 参数：client_fd - 客户端文件描述符
+    void note_locality(int client_fd);
+
+    // 清空eventfd计数并取出全部待接管的连接
+    // 返回：待接管的客户端fd列表
+    std::vector<int> take_pending();
+
+    // 响应主线程的排空请求（在处理eventfd唤醒时调用）
+    // 返回：true本次进入排空（调用方应关闭listen_fd停止接受新连接，并对所有连接调用schedule_timeout），
+    //       false未请求或已在排空中
+    bool enter_drain();
+
+    // 连接超时的类型
+    enum class TimeoutKind
+    {
+        NONE,     // 当前无需计时
+        IDLE,     // 空闲（没有未完成的报文）
+        HEADER,   // 报文头读取（3秒）
+        DATA,     // 数据读取（5秒）
+        WRITE,    // 回射被阻塞（慢消费者）
+        DRAIN     // 排空：已到报文边界，或到达排空截止时间
+    };
+
+    // 按连接所处阶段计算超时截止时间（不考虑排空）
+    // 参数：同next_deadline
+    // 返回：超时类型，NONE表示当前无需计时
+    TimeoutKind stage_deadline(const Connection& conn, bool write_blocked,
+                               std::chrono::steady_clock::time_point& deadline) const;
+
+    // 计算连接当前最近的超时截止时间
+    // 说明：排空期间已到报文边界的连接立即到期，其余连接的截止时间不晚于排空截止时间
+    // 参数：
+    //   conn - 客户端连接
+    //   write_blocked - 回射是否被阻塞（epoll：已注册EPOLLOUT；io_uring：有在途send）
+    //   deadline - 输出参数，截止时间
+    // 返回：超时类型，NONE表示当前无需计时
+    TimeoutKind next_deadline(const Connection& conn, bool write_blocked,
+                              std::chrono::steady_clock::time_point& deadline) const;
+
+    // 按连接当前状态设置其超时定时器（每次处理完连接事件后调用，通常只是一次比较）
+    // 参数：
+    //   conn - 客户端连接
+    //   write_blocked - 回射是否被阻塞
+    void schedule_timeout(Connection& conn, bool write_blocked);
+
+    // 处理到期的连接定时器：重新计算截止时间，未到期则重新设置，已到期则记录日志和计数
+    // 参数：
+    //   conn - 客户端连接
+    //   write_blocked - 回射是否被阻塞
+    //   now - 当前时间
+    // 返回：true已超时（调用方应关闭连接），false未超时
+    bool timeout_expired(Connection& conn, bool write_blocked, std::chrono::steady_clock::time_point now);
+
+    // 按报文非法的原因计数
+    // 参数：status - parse_frame/consume_frames返回的错误结果
+    void count_frame_error(FrameStatus status);
+
+    // 按轮询策略判断本轮等待能否阻塞
+    // 参数：now - 当前时间
+    // 返回：true可以阻塞（调用方按定时器计算等待时间），false只检查就绪事件、不等待
+    bool poll_may_block(std::chrono::steady_clock::time_point now) const;
+
+    // 记录一次等待的结果：更新SPIN策略的计时，并计入阻塞等待/轮询次数
+    // 参数：
+    //   blocked - 本次等待是否允许阻塞（超时不为0）
+    //   policy_may_block - 本轮poll_may_block的结果（为false时不阻塞的等待才计为轮询）
+    //   had_events - 是否等到了事件
+    //   now - 等待前的时间
+    void record_poll(bool blocked, bool policy_may_block, bool had_events,
+                     std::chrono::steady_clock::time_point now);
+
+    // 准入检查：本线程直接接受的连接（多reactor模式）在接管之前调用
+    // 参数：
+    //   client_fd - 客户端文件描述符
+    //   peer - 客户端地址（nullptr表示未知）
+    // 返回：true接纳，false已拒绝并关闭该fd
+    bool admit_connection(int client_fd, const struct sockaddr_in* peer);
+
+    // 释放连接的准入登记并关闭fd（关闭已接纳连接的唯一途径）
+    // 参数：client_fd - 客户端文件描述符
+    void close_client_fd(int client_fd);
+
+    // 设置已接受连接的套接字选项（TCP_NODELAY等）
+    // 参数：client_fd - 客户端文件描述符
+    // 返回：true成功，false失败（调用方应关闭该fd）
+    bool prepare_client_socket(int client_fd);
+
+public:
+    // 构造函数：初始化工作线程编号和配置
+    // 参数：
+    //   id - 工作线程编号
+    //   cfg - 服务端配置
+    WorkerBase(int id, const ServerConfig& cfg);
+
+    // 析构函数：关闭尚未接管的连接、监听套接字和eventfd
+    virtual ~WorkerBase();
+
+    WorkerBase(const WorkerBase&) = delete;
+    WorkerBase& operator=(const WorkerBase&) = delete;
+
+    // 初始化IO后端
+    // 参数：listen_fd - 本线程独占的非阻塞监听套接字（多reactor模式），-1表示由
+    //                  接收线程通过add_connections投递连接；传入后所有权归本对象
+    // 返回：true成功，false失败
+    virtual bool init(int listen_fd) = 0;
+
+    // 后端名称（用于日志）
+    virtual const char* backend_name() const = 0;
+
+    // 设置本线程所属的NUMA节点（在init和start之前调用；未设置时不按节点放置）
+    // 参数：
+    //   node - 节点编号
+    //   topology - NUMA拓扑（由调用方持有，生命周期长于本线程）
+    void set_numa_node(int node, const NumaTopology* topology);
+
+    // 所属NUMA节点（-1表示不按节点放置）
+    int node() const { return numa_node; }
+
+    // 设置连接准入控制（在start之前调用；未设置时不限制）
+    // 参数：admission - 准入控制对象（由调用方持有，生命周期长于本线程）
+    void set_admission(AdmissionControl* admission) { this->admission = admission; }
+
+    // 启动工作线程（进入事件循环）
+    // 参数：cpu - 绑定的CPU编号，-1表示不绑定
+    void start(int cpu = -1);
+
+    // 停止工作线程并等待其退出
+    void stop();
+
+    // 等待工作线程退出（不主动停止）
+    void join();
+
+    // 请求排空（由主线程调用，线程安全）：停止接受新连接，回射完已收到的报文后关闭连接，
+    // 所有连接关闭或到达排空超时后事件循环退出（之后调用join等待）
+    void drain();
+
+    // 获取缓冲池统计信息（线程安全）
+    BufferPoolStats pool_stats() const { return buffer_pool.stats(); }
+
+    // 获取本线程的指标（只读，任意线程可读取）
+    const ServerMetrics& server_metrics() const { return metrics; }
+
+    // 本线程的抽样追踪记录（任意线程读取）
+    const FrameTracer& frame_tracer() const { return tracer; }
+
+    // 批量投递新连接给本工作线程（由接收线程调用，线程安全）
+    // 说明：一批连接只加一次锁、唤醒一次，连接风暴时接收线程不会逐个争用投递队列
+    // 参数：client_fds - 已设置为非阻塞的客户端文件描述符（所有权转移给本对象）
+    void add_connections(const std::vector<int>& client_fds);
+};
+
+#endif // WORKER_BASE_H